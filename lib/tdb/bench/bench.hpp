@@ -0,0 +1,149 @@
+#ifndef LIB_TDB_BENCH_BENCH_HPP_
+#define LIB_TDB_BENCH_BENCH_HPP_
+
+//--- tdb overhead versus the raw sqlite3 / libpq API ---
+//Each case runs the same work twice : a hand written loop on the native API (raw),
+//and the tdb equivalent. The best time of options.repeat runs is kept for both, and
+//reported per operation, with the ratio tdb/raw.
+//
+//tdb::bench::Runner r(options);
+//r.print_header(std::cout);
+//r.compare("bind int", 100000,
+//  [&](size_t n){for(size_t i = 0; i < n; ++i){sqlite3_bind_int(...);} return n;},
+//  [&](size_t n){for(size_t i = 0; i < n; ++i){tdb::bind_a(q,...);}   return n;}
+//);                                  //prints its line
+//return r.exit_code(); //1 if a case is slower than options.max_overhead
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tdb::bench{
+
+	typedef std::chrono::steady_clock clock;
+
+	//the compiler must assume t is read
+	template<typename T>
+	inline void do_not_optimize(const T &t){
+		asm volatile("" : : "r"(&t) : "memory");
+	}
+
+
+	struct Options{
+		size_t repeat       = 5;   //runs per case, the best is kept
+		double scale        = 1;   //multiply the number of operations of each case
+		double max_overhead = 0;   //exit_code()==1 if tdb/raw > max_overhead for a case, 0 : no check
+		std::string filter;        //run only the cases whose name contains filter
+	};
+
+
+	struct Case_result{
+		std::string group;
+		std::string name;
+		size_t      nb_op  = 0;
+		double      raw_ns = 0; //per operation
+		double      tdb_ns = 0; //per operation
+		double ratio()const{return raw_ns > 0 ? tdb_ns/raw_ns : 0;}
+	};
+
+
+	struct Runner{
+		explicit Runner(const Options &o):options(o){}
+
+		//cases added after this call belong to group (ex : "sqlite")
+		void set_group(const std::string &g){group=g;}
+
+		bool is_selected(const std::string &name)const{
+			return options.filter.empty() or (group+" "+name).find(options.filter)!=std::string::npos;
+		}
+
+		//raw(n) and tdb(n) do about n operations each, and return how many they did
+		//(ex : whole table scans). setup() runs before each run (untimed), ex : to empty a table.
+		template<typename Raw_t, typename Tdb_t, typename Setup_t>
+		void compare(const std::string &name, size_t nb_op, Raw_t &&raw, Tdb_t &&tdb, Setup_t &&setup){
+			if(!is_selected(name)){return;}
+			nb_op = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(nb_op)*options.scale));
+
+			//warm up caches (and the query caches of tdb)
+			setup(); raw(nb_op);
+			setup(); tdb(nb_op);
+
+			Case_result r;
+			r.group  = group;
+			r.name   = name;
+			r.nb_op  = nb_op;
+			r.raw_ns = std::numeric_limits<double>::max();
+			r.tdb_ns = std::numeric_limits<double>::max();
+			for(size_t i = 0; i < std::max<size_t>(options.repeat,1); ++i){ //interleaved : both see the same machine state
+				r.raw_ns = std::min(r.raw_ns, time(nb_op,raw,setup));
+				r.tdb_ns = std::min(r.tdb_ns, time(nb_op,tdb,setup));
+			}
+
+			results.push_back(r);
+			print_line(std::cout,r);
+		}
+
+		template<typename Raw_t, typename Tdb_t>
+		void compare(const std::string &name, size_t nb_op, Raw_t &&raw, Tdb_t &&tdb){
+			compare(name, nb_op, std::forward<Raw_t>(raw), std::forward<Tdb_t>(tdb), [](){});
+		}
+
+		void print_header(std::ostream &out)const{
+			out << pad("case",56) << pad("ops",10) << pad("raw ns/op",14) << pad("tdb ns/op",14) << "tdb/raw\n";
+		}
+
+		void print_line(std::ostream &out, const Case_result &r)const{
+			char buffer[128];
+			std::snprintf(buffer, sizeof(buffer), "%-10zu%-14.1f%-14.1f%.3f", r.nb_op, r.raw_ns, r.tdb_ns, r.ratio());
+			out << pad(r.group+" "+r.name,56) << buffer;
+			if(options.max_overhead>0 and r.ratio()>options.max_overhead){out << "  <-- over " << options.max_overhead;}
+			out << std::endl;
+		}
+
+		//0 : all the cases are under max_overhead (or no check)
+		int exit_code()const{
+			if(options.max_overhead<=0){return 0;}
+			for(const Case_result &r : results){
+				if(r.ratio()>options.max_overhead){return 1;}
+			}
+			return 0;
+		}
+
+		Options                  options;
+		std::vector<Case_result> results;
+
+		private:
+		//ns per operation
+		template<typename Fn_t, typename Setup_t>
+		static double time(size_t nb_op, Fn_t &fn, Setup_t &setup){
+			setup();
+			const clock::time_point t0 = clock::now();
+			const size_t done = fn(nb_op);
+			const clock::duration d = clock::now()-t0;
+			return std::chrono::duration<double,std::nano>(d).count()/static_cast<double>(std::max<size_t>(done,1));
+		}
+
+		static std::string pad(std::string s, size_t n){
+			if(s.size()<n){s.resize(n,' ');}
+			else          {s+=' ';}
+			return s;
+		}
+
+		std::string group;
+	};
+
+
+	//--- cases, one function per backend ---
+	void run_sqlite(Runner &r);                                  //in memory database
+	void run_psql  (Runner &r, const std::string &connect_str); //empty : spawn a local server, if initdb is found
+
+}//end namespace tdb::bench
+
+
+
+#endif /* LIB_TDB_BENCH_BENCH_HPP_ */
@@ -0,0 +1,60 @@
+//--- tdb benchmark : tdb versus the raw sqlite3 / libpq API ---
+//The main is compiled only with -DTDB_BENCH (the sources of lib/ also build with main.cpp).
+//
+//usage : tdb_bench [--repeat=N] [--scale=X] [--max-overhead=X] [--filter=STRING] [--psql=CONNECT_STR] [--no-sqlite] [--no-psql]
+//  --psql : use an existing server, default $TDB_BENCH_PSQL (otherwise a temporary server is spawned, see bench_psql.cpp)
+//  --max-overhead=1.10 : exit with 1 if a case is more than 10% slower with tdb
+
+#ifdef TDB_BENCH
+
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace{
+	bool starts_with(const std::string &s, const std::string &prefix, std::string &value){
+		if(s.compare(0,prefix.size(),prefix)!=0){return false;}
+		value = s.substr(prefix.size());
+		return true;
+	}
+}
+
+
+int main(int argc, char **argv){
+	tdb::bench::Options o;
+	std::string psql = std::getenv("TDB_BENCH_PSQL") ? std::getenv("TDB_BENCH_PSQL") : "";
+	bool with_sqlite = true;
+	bool with_psql   = true;
+
+	for(int i = 1; i < argc; ++i){
+		const std::string a = argv[i];
+		std::string v;
+		if     (starts_with(a,"--repeat=",v))      {o.repeat       = std::stoul(v);}
+		else if(starts_with(a,"--scale=",v))       {o.scale        = std::stod(v);}
+		else if(starts_with(a,"--max-overhead=",v)){o.max_overhead = std::stod(v);}
+		else if(starts_with(a,"--filter=",v))      {o.filter       = v;}
+		else if(starts_with(a,"--psql=",v))        {psql           = v;}
+		else if(a=="--no-sqlite")                  {with_sqlite    = false;}
+		else if(a=="--no-psql")                    {with_psql      = false;}
+		else{
+			std::cerr << "unknown argument : " << a << "\n";
+			return 2;
+		}
+	}
+
+	tdb::bench::Runner r(o);
+	r.print_header(std::cout);
+	try{
+		if(with_sqlite){tdb::bench::run_sqlite(r);}
+		if(with_psql)  {tdb::bench::run_psql(r,psql);}
+	}catch(const std::exception &e){
+		std::cerr << "benchmark failed : " << e.what() << "\n";
+		return 2;
+	}
+	return r.exit_code();
+}
+
+#endif
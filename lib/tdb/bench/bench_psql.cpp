@@ -0,0 +1,510 @@
+#include "bench.hpp"
+
+#include <tdb/tdb_psql.hpp>
+#include <tdb/functors/Fn_get_table.hpp>
+#include <tdb/functors/Fn_insert.hpp>
+
+#include <container/vector.hpp>
+#include <container/set.hpp>
+#include <container/unordered_set.hpp>
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+
+#include <unistd.h>
+
+
+//======================
+//=== local postgres ===
+//======================
+//Without a connection string, a temporary cluster is created with initdb and started
+//with pg_ctl, on a unix socket only. initdb and pg_ctl are searched in $TDB_BENCH_PG_BIN,
+//then in the PATH. The cluster is stopped and removed at the end.
+namespace{
+
+	std::string shell_quote(const std::string &s){
+		std::string r = "'";
+		for(char c : s){
+			if(c=='\''){r+="'\\''";}
+			else       {r+=c;}
+		}
+		return r+"'";
+	}
+
+	//empty if not found
+	std::string find_pg_bin(){
+		std::vector<std::string> dirs;
+		if(const char *e = std::getenv("TDB_BENCH_PG_BIN")){dirs.push_back(e);}
+		if(const char *p = std::getenv("PATH")){
+			std::string path = p;
+			size_t start = 0;
+			while(start<=path.size()){
+				const size_t end = std::min(path.find(':',start),path.size());
+				dirs.push_back(path.substr(start,end-start));
+				start = end+1;
+			}
+		}
+		for(const std::string &d : dirs){
+			if(d.empty()){continue;}
+			if(::access((d+"/initdb").c_str(),X_OK)==0 and ::access((d+"/pg_ctl").c_str(),X_OK)==0){return d;}
+		}
+		return "";
+	}
+
+	struct Local_postgres{
+		Local_postgres(){
+			bin = find_pg_bin();
+			if(bin.empty()){return;}
+
+			char tmpl[] = "/tmp/tdb_bench_XXXXXX";
+			if(!::mkdtemp(tmpl)){return;}
+			dir = tmpl;
+
+			const std::string data = dir+"/data";
+			const std::string port = "5499";
+			const std::string log  = dir+"/log";
+
+			if(std::system((shell_quote(bin+"/initdb")+" -A trust -U tdb_bench -D "+shell_quote(data)+" >"+shell_quote(log)+" 2>&1").c_str())!=0){return;}
+
+			const std::string options = "-k "+dir+" -c listen_addresses='' -p "+port+" -c fsync=off";
+			if(std::system((shell_quote(bin+"/pg_ctl")+" -w -D "+shell_quote(data)+" -l "+shell_quote(log)+" -o "+shell_quote(options)+" start >/dev/null 2>&1").c_str())!=0){return;}
+
+			started      = true;
+			connect_str  = "host="+dir+" port="+port+" user=tdb_bench dbname=postgres";
+		}
+
+		~Local_postgres(){
+			if(started){std::system((shell_quote(bin+"/pg_ctl")+" -w -D "+shell_quote(dir+"/data")+" -m immediate stop >/dev/null 2>&1").c_str());}
+			if(!dir.empty()){
+				std::error_code ec;
+				std::filesystem::remove_all(dir,ec);
+			}
+		}
+
+		Local_postgres(const Local_postgres&)=delete;
+		Local_postgres& operator=(const Local_postgres&)=delete;
+
+		std::string bin;
+		std::string dir;
+		std::string connect_str;
+		bool started = false;
+	};
+
+}
+
+
+
+//=============
+//=== setup ===
+//=============
+namespace{
+	typedef tdb::Tag_psql Tag;
+	typedef tdb::Connection_t<Tag> Connection;
+	using tdb::bench::do_not_optimize;
+
+	constexpr size_t nb_rows = 10000; //rows of the tables that are read
+
+	//--- raw prepared statement ---
+	struct Raw_stmt{
+		Raw_stmt(PGconn *db_, const std::string &name_, const char *sql, int nb_param):db(db_),name(name_){
+			PGresult *r = PQprepare(db, name.c_str(), sql, nb_param, nullptr);
+			const bool ok = PQresultStatus(r)==PGRES_COMMAND_OK;
+			PQclear(r);
+			if(!ok){throw std::runtime_error(std::string("bench : cannot prepare ")+sql+" : "+PQerrorMessage(db));}
+		}
+		~Raw_stmt(){PQclear(PQexec(db,("DEALLOCATE "+name).c_str()));}
+		Raw_stmt(const Raw_stmt&)=delete;
+		Raw_stmt& operator=(const Raw_stmt&)=delete;
+
+		//text parameters, text results
+		PGresult *run(int nb_param, const char * const *values)const{
+			return PQexecPrepared(db, name.c_str(), nb_param, values, nullptr, nullptr, 0);
+		}
+
+		PGconn      *db;
+		std::string  name;
+	};
+
+	void check(PGresult *r, ExecStatusType expected){
+		const bool ok = PQresultStatus(r)==expected;
+		std::string error = ok ? "" : PQresultErrorMessage(r);
+		PQclear(r);
+		if(!ok){throw std::runtime_error("bench : "+error);}
+	}
+
+	void exec(PGconn *db, const char *sql){check(PQexec(db,sql),PGRES_COMMAND_OK);}
+
+	std::string text(size_t i, size_t size){
+		std::string s = std::to_string(i);
+		s.resize(size,'x');
+		return s;
+	}
+
+	void create_tables(Connection &c){
+		tdb::execute(c,"drop table if exists narrow, wide, pairs, ins");
+		tdb::execute(c,"create table narrow(i integer)");
+		tdb::execute(c,"create table wide(i1 integer, i2 integer, i3 bigint, d1 double precision, d2 double precision, s1 text, s2 text, s3 text)");
+		tdb::execute(c,"create table pairs(i integer, s text)");
+		tdb::execute(c,"create table ins(id serial primary key, i integer, d double precision, s text)");
+
+		auto tr = tdb::transaction(c);
+		auto narrow = tdb::prepare_new<std::tuple<>,std::tuple<int> >(c,"insert into narrow values($1)");
+		auto wide   = tdb::prepare_new<std::tuple<>,std::tuple<int,int,long long,double,double,std::string,std::string,std::string> >(c,"insert into wide values($1,$2,$3,$4,$5,$6,$7,nullif($8,''))"); //psql parameters cannot be NULL
+		auto pairs  = tdb::prepare_new<std::tuple<>,std::tuple<int,std::string> >(c,"insert into pairs values($1,$2)");
+		for(size_t i = 0; i < nb_rows; ++i){
+			const int k = static_cast<int>(i);
+			tdb::execute_a(narrow, k);
+			tdb::execute(wide, std::make_tuple(k, -k, static_cast<long long>(k)<<20, 0.5*k, 1.0/(k+1), text(i,8), text(i,64), i%2 ? std::string() : text(i,16)) );
+			tdb::execute(pairs, std::make_tuple(k, text(i,12)));
+		}
+		tr.commit();
+		tdb::execute(c,"analyze");
+	}
+}
+
+
+
+//===============
+//=== prepare ===
+//===============
+namespace{
+	//prepare + DEALLOCATE : two round trips on both sides
+	void bench_prepare(tdb::bench::Runner &r, Connection &c){
+		const char *sql = "select i1, s1 from wide where i1=$1 and s1<>$2";
+		r.compare("prepare", 2000,
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					Raw_stmt s(c.native_connection,"tdb_bench_prepare",sql,2);
+					do_not_optimize(s);
+				}
+				return n;
+			},
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					auto q = tdb::prepare_new<std::tuple<int,std::string>,std::tuple<int,std::string> >(c,sql);
+					do_not_optimize(q);
+				}
+				return n;
+			}
+		);
+	}
+}
+
+
+
+//============
+//=== bind ===
+//============
+//psql parameters are serialized on the client, and sent at execution :
+//bind measures the serialization only (text format), raw_bind(v,param) writes v in param.
+namespace{
+	template<typename T>
+	void raw_number(const T &v, std::string &param){
+		char buffer[32];
+		const auto r = std::to_chars(buffer, buffer+sizeof(buffer), v);
+		param.assign(buffer,r.ptr);
+	}
+
+	template<typename T, typename Raw_bind_t>
+	void bench_bind(tdb::bench::Runner &r, Connection &c, const std::string &name, const T &v, Raw_bind_t raw_bind){
+		if(!r.is_selected("bind "+name)){return;}
+
+		auto q = tdb::prepare_new<std::tuple<>,std::tuple<T> >(c,"select $1");
+		std::string param;
+
+		r.compare("bind "+name, 500000,
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					raw_bind(v,param);
+					do_not_optimize(param);
+				}
+				return n;
+			},
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					tdb::bind_a(q,v);
+					do_not_optimize(q.paramValues);
+				}
+				return n;
+			}
+		);
+	}
+
+	void bench_bind(tdb::bench::Runner &r, Connection &c){
+		static const std::string s = text(42,32);
+		static const tdb::psql::Bytea b(32,std::byte{0x2a});
+
+		bench_bind(r,c,"int"        , 42            , [](int v, std::string &p)      {raw_number(v,p);});
+		bench_bind(r,c,"long long"  , 42LL          , [](long long v, std::string &p){raw_number(v,p);});
+		bench_bind(r,c,"double"     , 0.5           , [](double v, std::string &p)   {raw_number(v,p);});
+		bench_bind(r,c,"bool"       , true          , [](bool v, std::string &p)     {p = v ? "t" : "f";});
+		bench_bind(r,c,"std::string", s             , [](const std::string &v, std::string &p){p = v;});
+		bench_bind(r,c,"psql::Bytea", b             , [](const tdb::psql::Bytea &v, std::string &p){
+			static constexpr char hex[] = "0123456789abcdef";
+			p.assign("\\x");
+			for(std::byte x : v){
+				const unsigned char u = static_cast<unsigned char>(x);
+				p.push_back(hex[u>>4]);
+				p.push_back(hex[u&15]);
+			}
+		});
+	}
+}
+
+
+
+//=============
+//=== fetch ===
+//=============
+namespace{
+	typedef std::tuple<int> Narrow_row;
+	typedef std::tuple<int,int,long long,double,double,std::string,std::string,std::optional<std::string> > Wide_row;
+
+	const char *narrow_sql = "select i from narrow";
+	const char *wide_sql   = "select i1, i2, i3, d1, d2, s1, s2, s3 from wide";
+
+	template<typename T>
+	T raw_number(PGresult *res, int row, int col){
+		T t{};
+		const char *d = PQgetvalue(res,row,col);
+		std::from_chars(d, d+PQgetlength(res,row,col), t);
+		return t;
+	}
+
+	void raw_row(PGresult *res, int i, Narrow_row &row){
+		std::get<0>(row) = raw_number<int>(res,i,0);
+	}
+
+	void raw_row(PGresult *res, int i, Wide_row &row){
+		std::get<0>(row) = raw_number<int>      (res,i,0);
+		std::get<1>(row) = raw_number<int>      (res,i,1);
+		std::get<2>(row) = raw_number<long long>(res,i,2);
+		std::get<3>(row) = raw_number<double>   (res,i,3);
+		std::get<4>(row) = raw_number<double>   (res,i,4);
+		std::get<5>(row).assign(PQgetvalue(res,i,5), static_cast<size_t>(PQgetlength(res,i,5)));
+		std::get<6>(row).assign(PQgetvalue(res,i,6), static_cast<size_t>(PQgetlength(res,i,6)));
+		if(PQgetisnull(res,i,7)){std::get<7>(row).reset();}
+		else                    {std::get<7>(row).emplace(PQgetvalue(res,i,7), static_cast<size_t>(PQgetlength(res,i,7)));}
+	}
+
+	//n rows : run the query as many times as needed
+	//reuse : the row is written in place (fetch_into), otherwise a new row is returned (try_fetch)
+	template<typename Row_t>
+	size_t raw_scan(const Raw_stmt &raw, size_t n, bool reuse){
+		size_t done = 0;
+		Row_t row;
+		while(done<n){
+			PGresult *res = raw.run(0,nullptr);
+			if(PQresultStatus(res)!=PGRES_TUPLES_OK){check(res,PGRES_TUPLES_OK);}
+			const int nb = PQntuples(res);
+			for(int i = 0; i < nb and done<n; ++i){
+				if(reuse){raw_row(res,i,row); do_not_optimize(row);}
+				else     {Row_t r; raw_row(res,i,r); do_not_optimize(r);}
+				++done;
+			}
+			PQclear(res);
+		}
+		return done;
+	}
+
+	template<typename Row_t>
+	void bench_fetch(tdb::bench::Runner &r, Connection &c, const std::string &name, const char *sql){
+		if(!r.is_selected("try_fetch "+name) and !r.is_selected("fetch_into "+name)){return;}
+
+		Raw_stmt raw(c.native_connection,"tdb_bench_fetch",sql,0);
+		auto q = tdb::prepare_new<Row_t,std::tuple<> >(c,sql);
+
+		r.compare("try_fetch "+name, 5*nb_rows,
+			[&](size_t n){return raw_scan<Row_t>(raw,n,false);},
+			[&](size_t n){
+				size_t done = 0;
+				while(done<n){
+					auto result = tdb::get_result(q);
+					while(done<n){
+						auto row = tdb::try_fetch(result);
+						if(!row){break;}
+						do_not_optimize(row);
+						++done;
+					}
+				}
+				return done;
+			}
+		);
+
+		r.compare("fetch_into "+name, 5*nb_rows,
+			[&](size_t n){return raw_scan<Row_t>(raw,n,true);},
+			[&](size_t n){
+				size_t done = 0;
+				Row_t row;
+				while(done<n){
+					auto result = tdb::get_result(q);
+					while(done<n and tdb::fetch_into(result,row)){
+						do_not_optimize(row);
+						++done;
+					}
+				}
+				return done;
+			}
+		);
+	}
+}
+
+
+
+//====================
+//=== Fn_get_table ===
+//====================
+namespace{
+	typedef std::tuple<int,std::string> Pair_row;
+
+	struct Pair_row_hash{
+		size_t operator()(const Pair_row &p)const{return std::hash<int>()(std::get<0>(p)) ^ (std::hash<std::string>()(std::get<1>(p))<<1);}
+	};
+
+	template<typename Container_t>
+	void bench_get_table(tdb::bench::Runner &r, Connection &c, const std::string &name){
+		if(!r.is_selected("Fn_get_table "+name)){return;}
+
+		const char *sql = "select i, s from pairs";
+		Raw_stmt raw(c.native_connection,"tdb_bench_get_table",sql,0);
+		tdb::Fn_get_table<Tag,Pair_row,std::tuple<>,false> fn(c,sql);
+		Container_t container;
+
+		r.compare("Fn_get_table "+name, nb_rows,
+			[&](size_t){
+				container.clear();
+				PGresult *res = raw.run(0,nullptr);
+				const int nb = PQntuples(res);
+				for(int i = 0; i < nb; ++i){
+					container::add_anywhere(container, Pair_row(raw_number<int>(res,i,0), std::string(PQgetvalue(res,i,1), static_cast<size_t>(PQgetlength(res,i,1)))));
+				}
+				PQclear(res);
+				do_not_optimize(container);
+				return container.size();
+			},
+			[&](size_t){
+				container.clear();
+				fn(container);
+				do_not_optimize(container);
+				return container.size();
+			}
+		);
+	}
+}
+
+
+
+//=================================
+//=== Fn_insert, transactions ===
+//=================================
+namespace{
+	const char *insert_sql = "insert into ins(i,d,s) values($1,$2,$3) returning id";
+
+	void raw_insert(const Raw_stmt &ins, int i, double d, const std::string &s){
+		char bi[16];
+		char bd[32];
+		*std::to_chars(bi, bi+sizeof(bi)-1, i).ptr = 0;
+		*std::to_chars(bd, bd+sizeof(bd)-1, d).ptr = 0;
+		const char *values[3] = {bi, bd, s.c_str()};
+
+		PGresult *res = ins.run(3,values);
+		if(PQresultStatus(res)!=PGRES_TUPLES_OK){check(res,PGRES_TUPLES_OK);}
+		do_not_optimize(raw_number<long long>(res,0,0));
+		PQclear(res);
+	}
+
+	template<bool Multi_thread>
+	void bench_insert(tdb::bench::Runner &r, Connection &c, const std::string &name){
+		if(!r.is_selected(name)){return;}
+
+		Raw_stmt ins(c.native_connection,"tdb_bench_insert",insert_sql,3);
+		tdb::Fn_insert<Tag,std::tuple<>,std::tuple<int,double,std::string>,Multi_thread> fn(c,insert_sql);
+		const std::string s = text(7,16);
+
+		//n rows in one transaction
+		r.compare(name, 20000,
+			[&](size_t n){
+				exec(c.native_connection,"BEGIN");
+				for(size_t i = 0; i < n; ++i){raw_insert(ins, static_cast<int>(i), 0.5, s);}
+				exec(c.native_connection,"COMMIT");
+				return n;
+			},
+			[&](size_t n){
+				auto tr = tdb::transaction(c);
+				for(size_t i = 0; i < n; ++i){do_not_optimize(fn(static_cast<int>(i), 0.5, s));}
+				tr.commit();
+				return n;
+			},
+			[&](){tdb::execute(c,"truncate ins");}
+		);
+	}
+
+	//n transactions of one row
+	void bench_transaction(tdb::bench::Runner &r, Connection &c){
+		if(!r.is_selected("transaction (1 row)")){return;}
+
+		Raw_stmt ins(c.native_connection,"tdb_bench_transaction",insert_sql,3);
+		tdb::Fn_insert<Tag,std::tuple<>,std::tuple<int,double,std::string>,false> fn(c,insert_sql);
+		const std::string s = text(7,16);
+
+		r.compare("transaction (1 row)", 5000,
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					exec(c.native_connection,"BEGIN");
+					raw_insert(ins, static_cast<int>(i), 0.5, s);
+					exec(c.native_connection,"COMMIT");
+				}
+				return n;
+			},
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					auto tr = tdb::transaction(c);
+					fn(static_cast<int>(i), 0.5, s);
+					tr.commit();
+				}
+				return n;
+			},
+			[&](){tdb::execute(c,"truncate ins");}
+		);
+	}
+}
+
+
+
+//===========
+//=== run ===
+//===========
+void tdb::bench::run_psql(Runner &r, const std::string &connect_str){
+	r.set_group("psql");
+
+	std::optional<Local_postgres> local;
+	std::string str = connect_str;
+	if(str.empty()){
+		local.emplace();
+		if(!local->started){
+			std::cout << "psql : skipped, no connection string and no local server (initdb / pg_ctl not found or failed)" << std::endl;
+			return;
+		}
+		str = local->connect_str;
+	}
+
+	Connection c(str);
+	create_tables(c);
+
+	bench_prepare(r,c);
+	bench_bind(r,c);
+	bench_fetch<Narrow_row>(r,c,"narrow (1 int)",   narrow_sql);
+	bench_fetch<Wide_row>  (r,c,"wide (8 columns)", wide_sql);
+	bench_get_table<std::vector<Pair_row> >(r,c,"std::vector");
+	bench_get_table<std::set<Pair_row> >   (r,c,"std::set");
+	bench_get_table<std::unordered_set<Pair_row,Pair_row_hash> >(r,c,"std::unordered_set");
+	bench_insert<false>(r,c,"Fn_insert");
+	bench_insert<true> (r,c,"Fn_insert (Multi_thread)");
+	bench_transaction(r,c);
+
+	tdb::execute(c,"drop table narrow, wide, pairs, ins");
+}
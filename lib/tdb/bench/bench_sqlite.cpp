@@ -0,0 +1,392 @@
+#include "bench.hpp"
+
+#include <tdb/tdb_sqlite.hpp>
+#include <tdb/functors/Fn_get_table.hpp>
+#include <tdb/functors/Fn_insert.hpp>
+
+#include <container/vector.hpp>
+#include <container/set.hpp>
+#include <container/unordered_set.hpp>
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+
+
+//=============
+//=== setup ===
+//=============
+namespace{
+	typedef tdb::Tag_sqlite Tag;
+	typedef tdb::Connection_t<Tag> Connection;
+	using tdb::bench::do_not_optimize;
+
+	constexpr size_t nb_rows = 10000; //rows of the tables that are read
+
+	//--- raw statement ---
+	struct Raw_stmt{
+		Raw_stmt(sqlite3 *db, const char *sql){
+			if(sqlite3_prepare_v2(db, sql, -1, &s, nullptr)!=SQLITE_OK){
+				throw std::runtime_error(std::string("bench : cannot prepare ")+sql+" : "+sqlite3_errmsg(db));
+			}
+		}
+		~Raw_stmt(){sqlite3_finalize(s);}
+		Raw_stmt(const Raw_stmt&)=delete;
+		Raw_stmt& operator=(const Raw_stmt&)=delete;
+
+		void run(){ //step to the end, reset
+			int status;
+			do{status = sqlite3_step(s);}while(status==SQLITE_ROW);
+			sqlite3_reset(s);
+			if(status!=SQLITE_DONE){throw std::runtime_error(std::string("bench : step failed : ")+sqlite3_errstr(status));}
+		}
+
+		sqlite3_stmt *s = nullptr;
+	};
+
+	std::string text(size_t i, size_t size){
+		std::string s = std::to_string(i);
+		s.resize(size,'x');
+		return s;
+	}
+
+	void create_tables(Connection &c){
+		tdb::execute(c,"create table narrow(i integer)");
+		tdb::execute(c,"create table wide(i1 integer not null, i2 integer not null, i3 integer not null, d1 real not null, d2 real not null, s1 text not null, s2 text not null, s3 text)");
+		tdb::execute(c,"create table pairs(i integer, s text)");
+		tdb::execute(c,"create table ins(i integer, d real, s text)");
+
+		auto tr = tdb::transaction(c);
+		auto narrow = tdb::prepare_new<std::tuple<>,std::tuple<int> >(c,"insert into narrow values(?)");
+		auto wide   = tdb::prepare_new<std::tuple<>,std::tuple<int,int,sqlite3_int64,double,double,std::string,std::string,std::optional<std::string> > >(c,"insert into wide values(?,?,?,?,?,?,?,?)");
+		auto pairs  = tdb::prepare_new<std::tuple<>,std::tuple<int,std::string> >(c,"insert into pairs values(?,?)");
+		for(size_t i = 0; i < nb_rows; ++i){
+			const int k = static_cast<int>(i);
+			tdb::execute_a(narrow, k);
+			tdb::execute(wide, std::make_tuple(k, -k, sqlite3_int64(k)<<20, 0.5*k, 1.0/(k+1), text(i,8), text(i,64), i%2 ? std::optional<std::string>() : std::optional<std::string>(text(i,16))) );
+			tdb::execute(pairs, std::make_tuple(k, text(i,12)));
+		}
+		tr.commit();
+	}
+}
+
+
+
+//===============
+//=== prepare ===
+//===============
+namespace{
+	void bench_prepare(tdb::bench::Runner &r, Connection &c){
+		const char *sql = "select i1, s1 from wide where i1=? and s1<>?";
+		r.compare("prepare", 20000,
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					sqlite3_stmt *s = nullptr;
+					sqlite3_prepare_v2(c.native_connection, sql, -1, &s, nullptr);
+					do_not_optimize(s);
+					sqlite3_finalize(s);
+				}
+				return n;
+			},
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					auto q = tdb::prepare_new<std::tuple<int,std::string>,std::tuple<int,std::string> >(c,sql);
+					do_not_optimize(q);
+				}
+				return n;
+			}
+		);
+	}
+}
+
+
+
+//============
+//=== bind ===
+//============
+namespace{
+	//raw_bind(stmt,v) binds v as the first parameter
+	template<typename T, typename Raw_bind_t>
+	void bench_bind(tdb::bench::Runner &r, Connection &c, const std::string &name, const T &v, Raw_bind_t raw_bind){
+		if(!r.is_selected("bind "+name)){return;}
+
+		Raw_stmt raw(c.native_connection,"select ?");
+		auto q = tdb::prepare_new<std::tuple<>,std::tuple<T> >(c,"select ?");
+
+		r.compare("bind "+name, 500000,
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					raw_bind(raw.s,v);
+					sqlite3_reset(raw.s);
+					sqlite3_clear_bindings(raw.s);
+				}
+				return n;
+			},
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					tdb::bind_a(q,v);
+					tdb::sqlite::reset_binding(q.native_query, &q.native_nb_bind); //as Result_t and execute do
+				}
+				return n;
+			}
+		);
+	}
+
+	void bench_bind(tdb::bench::Runner &r, Connection &c){
+		static const std::string s  = text(42,32);
+		static const std::byte   b[32] = {};
+
+		bench_bind(r,c,"int"          , 42                  , [](sqlite3_stmt *q, int v)          {sqlite3_bind_int   (q,1,v);});
+		bench_bind(r,c,"sqlite3_int64", sqlite3_int64(42)   , [](sqlite3_stmt *q, sqlite3_int64 v){sqlite3_bind_int64 (q,1,v);});
+		bench_bind(r,c,"size_t"       , size_t(42)          , [](sqlite3_stmt *q, size_t v)       {sqlite3_bind_int64 (q,1,static_cast<sqlite3_int64>(v));});
+		bench_bind(r,c,"double"       , 0.5                 , [](sqlite3_stmt *q, double v)       {sqlite3_bind_double(q,1,v);});
+		bench_bind(r,c,"bool"         , true                , [](sqlite3_stmt *q, bool v)         {sqlite3_bind_int   (q,1,v ? 1 : 0);});
+		bench_bind(r,c,"char"         , 'x'                 , [](sqlite3_stmt *q, const char &v)  {sqlite3_bind_text  (q,1,&v,1,SQLITE_STATIC);});
+		bench_bind(r,c,"std::string"  , s                   , [](sqlite3_stmt *q, const std::string &v){sqlite3_bind_text(q,1,v.c_str(),static_cast<int>(v.size()),SQLITE_STATIC);});
+		bench_bind(r,c,"const char*"  , s.c_str()           , [](sqlite3_stmt *q, const char *v)  {sqlite3_bind_text  (q,1,v,static_cast<int>(std::strlen(v)),SQLITE_STATIC);});
+		bench_bind(r,c,"std::string_view", std::string_view(s), [](sqlite3_stmt *q, std::string_view v){sqlite3_bind_text(q,1,v.data(),static_cast<int>(v.size()),SQLITE_STATIC);});
+		bench_bind(r,c,"std::span<const std::byte>", std::span<const std::byte>(b), [](sqlite3_stmt *q, std::span<const std::byte> v){sqlite3_bind_blob(q,1,v.data(),static_cast<int>(v.size()),SQLITE_STATIC);});
+		bench_bind(r,c,"tdb::Null"    , tdb::Null()         , [](sqlite3_stmt *q, tdb::Null)      {sqlite3_bind_null  (q,1);});
+		bench_bind(r,c,"std::optional<int> (value)", std::optional<int>(42), [](sqlite3_stmt *q, std::optional<int> v){if(v){sqlite3_bind_int(q,1,*v);}else{sqlite3_bind_null(q,1);}});
+		bench_bind(r,c,"std::optional<int> (null)" , std::optional<int>()  , [](sqlite3_stmt *q, std::optional<int> v){if(v){sqlite3_bind_int(q,1,*v);}else{sqlite3_bind_null(q,1);}});
+	}
+}
+
+
+
+//=============
+//=== fetch ===
+//=============
+namespace{
+	typedef std::tuple<int> Narrow_row;
+	typedef std::tuple<int,int,sqlite3_int64,double,double,std::string,std::string,std::optional<std::string> > Wide_row;
+
+	const char *narrow_sql = "select i from narrow";
+	const char *wide_sql   = "select i1, i2, i3, d1, d2, s1, s2, s3 from wide";
+
+	std::string column_string(sqlite3_stmt *s, int i){
+		return std::string(reinterpret_cast<const char*>(sqlite3_column_text(s,i)), static_cast<size_t>(sqlite3_column_bytes(s,i)));
+	}
+
+	void raw_row(sqlite3_stmt *s, Narrow_row &row){
+		std::get<0>(row) = sqlite3_column_int(s,0);
+	}
+
+	void raw_row(sqlite3_stmt *s, Wide_row &row){
+		std::get<0>(row) = sqlite3_column_int   (s,0);
+		std::get<1>(row) = sqlite3_column_int   (s,1);
+		std::get<2>(row) = sqlite3_column_int64 (s,2);
+		std::get<3>(row) = sqlite3_column_double(s,3);
+		std::get<4>(row) = sqlite3_column_double(s,4);
+		std::get<5>(row).assign(reinterpret_cast<const char*>(sqlite3_column_text(s,5)), static_cast<size_t>(sqlite3_column_bytes(s,5)));
+		std::get<6>(row).assign(reinterpret_cast<const char*>(sqlite3_column_text(s,6)), static_cast<size_t>(sqlite3_column_bytes(s,6)));
+		if(sqlite3_column_type(s,7)==SQLITE_NULL){std::get<7>(row).reset();}
+		else                                     {std::get<7>(row) = column_string(s,7);}
+	}
+
+	//n rows : scan the table as many times as needed
+	//reuse : the row is written in place (fetch_into), otherwise a new row is returned (try_fetch)
+	template<typename Row_t>
+	size_t raw_scan(Raw_stmt &raw, size_t n, bool reuse){
+		size_t done = 0;
+		Row_t row;
+		while(done<n){
+			while(done<n and sqlite3_step(raw.s)==SQLITE_ROW){
+				if(reuse){raw_row(raw.s,row); do_not_optimize(row);}
+				else     {Row_t r; raw_row(raw.s,r); do_not_optimize(r);}
+				++done;
+			}
+			sqlite3_reset(raw.s);
+		}
+		return done;
+	}
+
+	//validate : sqlite::validate_schema (no per value type check)
+	template<typename Row_t>
+	void bench_fetch(tdb::bench::Runner &r, Connection &c, const std::string &name, const char *sql, bool validate = false){
+		if(!r.is_selected("try_fetch "+name) and !r.is_selected("fetch_into "+name)){return;}
+
+		Raw_stmt raw(c.native_connection,sql);
+		auto q = tdb::prepare_new<Row_t,std::tuple<> >(c,sql);
+		if(validate){tdb::sqlite::validate_schema(q);}
+
+		r.compare("try_fetch "+name, 5*nb_rows,
+			[&](size_t n){return raw_scan<Row_t>(raw,n,false);},
+			[&](size_t n){
+				size_t done = 0;
+				while(done<n){
+					auto result = tdb::get_result(q);
+					while(done<n){
+						auto row = tdb::try_fetch(result);
+						if(!row){break;}
+						do_not_optimize(row);
+						++done;
+					}
+				}
+				return done;
+			}
+		);
+
+		r.compare("fetch_into "+name, 5*nb_rows,
+			[&](size_t n){return raw_scan<Row_t>(raw,n,true);},
+			[&](size_t n){
+				size_t done = 0;
+				Row_t row;
+				while(done<n){
+					auto result = tdb::get_result(q);
+					while(done<n and tdb::fetch_into(result,row)){
+						do_not_optimize(row);
+						++done;
+					}
+				}
+				return done;
+			}
+		);
+	}
+}
+
+
+
+//====================
+//=== Fn_get_table ===
+//====================
+namespace{
+	typedef std::tuple<int,std::string> Pair_row;
+
+	struct Pair_row_hash{
+		size_t operator()(const Pair_row &p)const{return std::hash<int>()(std::get<0>(p)) ^ (std::hash<std::string>()(std::get<1>(p))<<1);}
+	};
+
+	//one whole table per run, into an emptied container
+	template<typename Container_t>
+	void bench_get_table(tdb::bench::Runner &r, Connection &c, const std::string &name){
+		if(!r.is_selected("Fn_get_table "+name)){return;}
+
+		const char *sql = "select i, s from pairs";
+		Raw_stmt raw(c.native_connection,sql);
+		tdb::Fn_get_table<Tag,Pair_row,std::tuple<>,false> fn(c,sql);
+		Container_t container;
+
+		r.compare("Fn_get_table "+name, nb_rows,
+			[&](size_t){
+				container.clear();
+				while(sqlite3_step(raw.s)==SQLITE_ROW){
+					container::add_anywhere(container, Pair_row(sqlite3_column_int(raw.s,0), column_string(raw.s,1)));
+				}
+				sqlite3_reset(raw.s);
+				do_not_optimize(container);
+				return container.size();
+			},
+			[&](size_t){
+				container.clear();
+				fn(container);
+				do_not_optimize(container);
+				return container.size();
+			}
+		);
+	}
+}
+
+
+
+//=================================
+//=== Fn_insert, transactions ===
+//=================================
+namespace{
+	const char *insert_sql = "insert into ins(i,d,s) values(?,?,?)";
+
+	void raw_insert(Raw_stmt &ins, int i, double d, const std::string &s){
+		sqlite3_bind_int   (ins.s,1,i);
+		sqlite3_bind_double(ins.s,2,d);
+		sqlite3_bind_text  (ins.s,3,s.c_str(),static_cast<int>(s.size()),SQLITE_STATIC);
+		if(sqlite3_step(ins.s)!=SQLITE_DONE){throw std::runtime_error("bench : insert failed");}
+		do_not_optimize(sqlite3_last_insert_rowid(sqlite3_db_handle(ins.s)));
+		sqlite3_reset(ins.s);
+		sqlite3_clear_bindings(ins.s);
+	}
+
+	template<bool Multi_thread>
+	void bench_insert(tdb::bench::Runner &r, Connection &c, const std::string &name){
+		if(!r.is_selected(name)){return;}
+
+		Raw_stmt ins   (c.native_connection,insert_sql);
+		Raw_stmt begin (c.native_connection,"BEGIN transaction");
+		Raw_stmt commit(c.native_connection,"COMMIT");
+		tdb::Fn_insert<Tag,std::tuple<>,std::tuple<int,double,std::string>,Multi_thread> fn(c,insert_sql);
+		const std::string s = text(7,16);
+
+		//n rows in one transaction
+		r.compare(name, 100000,
+			[&](size_t n){
+				begin.run();
+				for(size_t i = 0; i < n; ++i){raw_insert(ins, static_cast<int>(i), 0.5, s);}
+				commit.run();
+				return n;
+			},
+			[&](size_t n){
+				auto tr = tdb::transaction(c);
+				for(size_t i = 0; i < n; ++i){do_not_optimize(fn(static_cast<int>(i), 0.5, s));}
+				tr.commit();
+				return n;
+			},
+			[&](){tdb::execute(c,"delete from ins");}
+		);
+	}
+
+	//n transactions of one row
+	void bench_transaction(tdb::bench::Runner &r, Connection &c){
+		if(!r.is_selected("transaction (1 row)")){return;}
+
+		Raw_stmt ins   (c.native_connection,insert_sql);
+		Raw_stmt begin (c.native_connection,"BEGIN transaction");
+		Raw_stmt commit(c.native_connection,"COMMIT");
+		tdb::Fn_insert<Tag,std::tuple<>,std::tuple<int,double,std::string>,false> fn(c,insert_sql);
+		const std::string s = text(7,16);
+
+		r.compare("transaction (1 row)", 50000,
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					begin.run();
+					raw_insert(ins, static_cast<int>(i), 0.5, s);
+					commit.run();
+				}
+				return n;
+			},
+			[&](size_t n){
+				for(size_t i = 0; i < n; ++i){
+					auto tr = tdb::transaction(c);
+					fn(static_cast<int>(i), 0.5, s);
+					tr.commit();
+				}
+				return n;
+			},
+			[&](){tdb::execute(c,"delete from ins");}
+		);
+	}
+}
+
+
+
+//===========
+//=== run ===
+//===========
+void tdb::bench::run_sqlite(Runner &r){
+	r.set_group("sqlite");
+
+	Connection c(":memory:");
+	create_tables(c);
+
+	bench_prepare(r,c);
+	bench_bind(r,c);
+	bench_fetch<Narrow_row>(r,c,"narrow (1 int)",   narrow_sql);
+	bench_fetch<Wide_row>  (r,c,"wide (8 columns)", wide_sql);
+	bench_fetch<Wide_row>  (r,c,"wide (8 columns, validate_schema)", wide_sql, true);
+	bench_get_table<std::vector<Pair_row> >(r,c,"std::vector");
+	bench_get_table<std::set<Pair_row> >   (r,c,"std::set");
+	bench_get_table<std::unordered_set<Pair_row,Pair_row_hash> >(r,c,"std::unordered_set");
+	bench_insert<false>(r,c,"Fn_insert");
+	bench_insert<true> (r,c,"Fn_insert (Multi_thread)");
+	bench_transaction(r,c);
+}
@@ -0,0 +1,67 @@
+#include "../tdb_pool.hpp"
+#include "../tdb_sqlite.hpp"
+#include "../functors/Fn_execute.hpp"
+#include "../functors/Fn_get_value_unique.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <optional>
+
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	typedef tdb::Tag_sqlite Tag_xxx;
+	typedef tdb::Fn_get_value_unique<Tag_xxx, std::tuple<int>, std::tuple<int>, false> Fn_count;
+
+	//--- Pool ---
+	tdb::Pool_options o;
+	o.size                   = 2;
+	o.checkout_timeout       = std::chrono::milliseconds(500);
+	o.functor_cache_capacity = 1; //each new functor evicts the previous one
+	tdb::Pool<Tag_xxx> pool(tdb::pool_connector<Tag_xxx>("/tmp/test.sqlite"), o);
+
+	{
+		tdb::Pool_lease<Tag_xxx> c = pool.checkout();
+		tdb::execute(*c, "create table if not exists test_pool(i integer)");
+		tdb::execute_a(*c, "insert into test_pool values(?)", 42);
+
+		Fn_count &f1 = c.prepared<Fn_count>("select count(*) from test_pool where i>$1");
+		Fn_count &f2 = c.prepared<Fn_count>("select count(*) from test_pool where i<$1"); //evicts f1
+		[[maybe_unused]] int n1 = f1(0);   //f1 is still alive : destroyed when the lease ends
+		[[maybe_unused]] int n2 = f2(100);
+		assert(n1==n2);
+	}//the connection goes back to the pool, with f2
+
+	std::optional<tdb::Pool_lease<Tag_xxx> > c1 = pool.try_checkout(std::chrono::milliseconds(10));
+	std::optional<tdb::Pool_lease<Tag_xxx> > c2 = pool.try_checkout(std::chrono::milliseconds(10));
+	std::optional<tdb::Pool_lease<Tag_xxx> > c3 = pool.try_checkout(std::chrono::milliseconds(10));
+	assert(c1 and c2 and not c3); //2 connections
+	c1->set_broken();             //reconnected before its next checkout
+	c1.reset();
+	c2.reset();
+	std::cout << "checkouts " << pool.stats().checkout << " timeouts " << pool.stats().timeout << std::endl;
+
+
+	//--- Pooled ---
+	//prepared on whatever connection it gets, on first use
+	tdb::Pooled<Fn_count> count(pool, "select count(*) from test_pool where i>$1");
+	[[maybe_unused]] int n3 = count(10);
+
+
+	//--- Rw_pool ---
+	tdb::sqlite::Options ro = tdb::sqlite::Options::oltp();
+	ro.read_only = true;
+	tdb::Rw_pool<Tag_xxx> rw(
+		tdb::pool_connector<Tag_xxx>("/tmp/test.sqlite", tdb::sqlite::Options::oltp()), //writer, switches to WAL
+		tdb::pool_connector<Tag_xxx>("/tmp/test.sqlite", ro),                            //readers
+		4
+	);
+	{ auto w = rw.write(); tdb::execute_a(*w, "insert into test_pool values(?)", 1); }
+	{ auto r = rw.read();  [[maybe_unused]] int n4 = r.prepared<Fn_count>("select count(*) from test_pool where i>$1")(0); }
+
+}
+}
@@ -0,0 +1,42 @@
+#include "../tdb_psql_async.hpp"
+
+#include <cassert>
+#include <iostream>
+
+
+//test code
+namespace{
+
+typedef tdb::Tag_psql Tag_xxx;
+typedef tdb::Query<Tag_xxx, std::tuple<long long>, std::tuple<int> > Count_query;
+
+tdb::psql::Task<long long> count(tdb::psql::Event_loop &loop, Count_query &q, int i){
+	auto result = co_await tdb::psql::async_get_result_a(loop, q, i);
+	co_return std::get<0>(tdb::try_fetch(result).value());
+}
+
+//two tasks created on the same query, then awaited : each one runs with its own parameters
+tdb::psql::Task<void> two_tasks(tdb::psql::Event_loop &loop, Count_query &q){
+	auto t1 = tdb::psql::async_get_result_a(loop, q, 1);
+	auto t2 = tdb::psql::async_get_result_a(loop, q, 2); //q is bound again, t1 keeps 1
+	auto r1 = co_await t1;
+	auto r2 = co_await t2;
+	[[maybe_unused]] const long long n1 = std::get<0>(tdb::try_fetch(r1).value());
+	[[maybe_unused]] const long long n2 = std::get<0>(tdb::try_fetch(r2).value());
+	assert(n1==1 and n2==2);
+}
+
+[[maybe_unused]] void example(){
+
+	tdb::Connection_t<Tag_xxx> connection("pierre","127.0.0.1","pierre","xxxxx");
+	tdb::execute(connection,"drop table if exists test_async;");
+	tdb::execute(connection,"create table test_async(i integer);");
+	tdb::execute(connection,"insert into test_async values (1),(2),(2);");
+
+	auto q = tdb::prepare_new< std::tuple<long long> , std::tuple<int> >(connection,"select count(*) from test_async where i=$1");
+
+	tdb::psql::Event_loop loop;
+	loop.run(two_tasks(loop, q));
+	std::cout << "count(2) " << loop.run(count(loop, q, 2)) << std::endl;
+}
+}
@@ -0,0 +1,64 @@
+#include "../tdb_write_queue.hpp"
+#include "../tdb_sqlite.hpp"
+#include "../functors/Fn_get_value_unique.hpp"
+
+#include <cassert>
+#include <future>
+#include <iostream>
+#include <string>
+
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	typedef tdb::Tag_sqlite Tag_xxx;
+
+	tdb::Write_queue_options o;
+	o.begin = "BEGIN IMMEDIATE";
+	tdb::Write_queue<Tag_xxx> wq(tdb::pool_connector<Tag_xxx>("/tmp/test.sqlite", tdb::sqlite::Options::oltp()), o);
+
+	//--- requests ---
+	wq.execute("drop table if exists test_wq");
+	wq.execute("create table test_wq(i integer primary key, s text)");
+	std::future<tdb::Rowid<Tag_xxx> > id = wq.insert("insert into test_wq(i,s) values(?,?)", 1, "one");
+	std::future<void>                 ok = wq.execute("update test_wq set s=? where i=?", std::string("uno"), 1);
+	wq.flush(); //everything above is commited
+	[[maybe_unused]] tdb::Rowid<Tag_xxx> r = id.get();
+	ok.get();
+
+	//--- a failed request is undone alone (savepoint), its batch is commited ---
+	//block the writer, so that the 3 next requests are queued and run in the same batch
+	std::promise<void> go;
+	std::shared_future<void> go_f = go.get_future().share();
+	std::future<void> blocker = wq.submit([go_f](tdb::Connection_t<Tag_xxx>&){go_f.wait();});
+
+	const size_t replays = wq.stats().replays;
+	std::future<tdb::Rowid<Tag_xxx> > a   = wq.insert("insert into test_wq(i,s) values(?,?)", 2, "two");
+	std::future<tdb::Rowid<Tag_xxx> > dup = wq.insert("insert into test_wq(i,s) values(?,?)", 1, "dup"); //fails : primary key
+	std::future<tdb::Rowid<Tag_xxx> > b   = wq.insert("insert into test_wq(i,s) values(?,?)", 3, "three");
+	go.set_value();
+	wq.flush();
+
+	blocker.get();
+	a.get(); //commited, without replay
+	b.get();
+	bool failed = false;
+	try{dup.get();}catch(const tdb::Exception_t<Tag_xxx>&){failed=true;}
+	assert(failed);
+	assert(wq.stats().replays == replays);
+
+	//any work on the writer connection
+	std::future<int> n = wq.submit([](tdb::Connection_t<Tag_xxx> &c){
+		tdb::Fn_get_value_unique<Tag_xxx, std::tuple<int>, std::tuple<>, false> count(c, "select count(*) from test_wq");
+		return count();
+	});
+	assert(n.get()==3);
+
+	tdb::Write_queue_stats s = wq.stats();
+	std::cout << "requests " << s.requests << " errors " << s.errors << " transactions " << s.transactions << " replays " << s.replays << std::endl;
+	wq.close();
+
+}
+}
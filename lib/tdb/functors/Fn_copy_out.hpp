@@ -0,0 +1,193 @@
+#ifndef LIB_TDB_FUNCTORS_FN_COPY_OUT_HPP_
+#define LIB_TDB_FUNCTORS_FN_COPY_OUT_HPP_
+
+//psql only : export the rows of a query with COPY (query) TO STDOUT.
+//Rows are decoded one by one, the whole result is never held in memory.
+//COPY cannot have bound parameters, so the functors have no Bind_tt.
+//
+//tdb::psql::Fn_copy_table<std::tuple<int,double>, true> fn(connection, "select i1,d1 from test");
+//std::vector<std::tuple<int,double>> v;
+//fn(v);                     //container
+//fn(std::back_inserter(v)); //output iterator
+//
+//tdb::psql::Fn_copy_foreach<std::tuple<int,double>, true> fe(connection, "select i1,d1 from test");
+//fe([](int i, double d)->void{...});
+//bool b = fe([](int i, double d)->bool{...}); //stop when false is returned
+//
+//format : tdb::psql::FORMAT_TEXT (default) or tdb::psql::FORMAT_BINARY (see Copy_out_t)
+//the multi thread versions are blocking. The mutex is NOT unlocked while fn is running
+
+
+
+#include "../tdb_psql.hpp"
+#include "impl/is_iterator.hpp"
+#include <container/container.hpp>
+#include <type_traits>
+
+namespace tdb::psql{
+
+	namespace impl{
+
+		template<typename Return_tt, typename Write_here_tt>
+		void copy_table(Connection_t<Tag_psql> &db, const std::string &sql, int format, Write_here_tt &write_here){
+			Copy_out_t<Return_tt> copy(db,sql,format);
+			while( auto r = copy.try_fetch() ){
+				if constexpr(tdb::impl::is_iterator<Write_here_tt>){
+					static_assert(tdb::impl::is_iterator_of_type<Write_here_tt,std::output_iterator_tag>,"Wrong iterator type in Fn_copy_table, an output iterator is required.");
+					(*write_here)=r.value();
+				}else{
+					static_assert(container::Add_anywhere_t<Write_here_tt>::is_implemented,"Missing implementation of container::Add_anywhere_t (did you forget to include container/xxx.hpp?)");
+					container::add_anywhere(write_here,r.value());
+				}
+			}
+		}
+
+		template<typename Return_tt, typename Fn_t>
+		auto copy_foreach(Connection_t<Tag_psql> &db, const std::string &sql, int format, Fn_t &fn){
+			typedef decltype(std::apply(fn,std::declval<Return_tt&>())) return_t;
+			static constexpr bool is_bool = std::is_convertible<return_t,bool>::value;
+
+			Copy_out_t<Return_tt> copy(db,sql,format);
+			while( auto r = copy.try_fetch() ){
+				if constexpr(is_bool){
+					bool b = std::apply(fn,r.value());
+					if(!b){return false;} //the copy is cancelled
+				}else{
+					std::apply(fn,r.value());
+				}
+			}
+			if constexpr(is_bool){return true;}
+		}
+	}
+
+
+
+	//--- Fn_copy_table ---
+	template<typename Return_tt, bool Multi_thread>
+	struct Fn_copy_table;
+
+	template<typename... Return_a>
+	struct Fn_copy_table<std::tuple<Return_a...>, false>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_copy_table(Fn_copy_table&&)=default;
+		Fn_copy_table(const Fn_copy_table&)=delete;
+		Fn_copy_table& operator=(const Fn_copy_table&)=delete;
+		Fn_copy_table()=delete;
+
+		Fn_copy_table(Connection_t<Tag_psql>& db_, const std::string &sql_, int format_=FORMAT_TEXT):db(db_),sql(sql_),format(format_){}
+
+		//output_iterator
+		template<typename Write_here_tt>
+		typename std::enable_if<tdb::impl::is_iterator<Write_here_tt>,void>::type
+		operator()(Write_here_tt write_here){
+			impl::copy_table<Return_tt>(db,sql,format,write_here);
+		}
+
+		//containers
+		template<typename Write_here_tt>
+		typename std::enable_if<! tdb::impl::is_iterator<Write_here_tt>,void>::type
+		operator()(Write_here_tt &write_here){
+			impl::copy_table<Return_tt>(db,sql,format,write_here);
+		}
+
+		Connection_t<Tag_psql>& db;
+		std::string sql;
+		int format;
+	};
+
+
+	template<typename... Return_a>
+	struct Fn_copy_table<std::tuple<Return_a...>, true>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_copy_table(Fn_copy_table&&)=default;
+		Fn_copy_table(const Fn_copy_table&)=delete;
+		Fn_copy_table& operator=(const Fn_copy_table&)=delete;
+		Fn_copy_table()=delete;
+
+		Fn_copy_table(Connection_t<Tag_psql>& db_, const std::string &sql_, int format_=FORMAT_TEXT):db(db_),sql(sql_),format(format_){}
+
+		//output_iterator
+		template<typename Write_here_tt>
+		typename std::enable_if<tdb::impl::is_iterator<Write_here_tt>,void>::type
+		operator()(Write_here_tt write_here){
+			auto l = tdb::impl::connection_lock_guard (db);
+			impl::copy_table<Return_tt>(db,sql,format,write_here);
+		}
+
+		//containers
+		template<typename Write_here_tt>
+		typename std::enable_if<! tdb::impl::is_iterator<Write_here_tt>,void>::type
+		operator()(Write_here_tt &write_here){
+			auto l = tdb::impl::connection_lock_guard (db);
+			impl::copy_table<Return_tt>(db,sql,format,write_here);
+		}
+
+		Connection_t<Tag_psql>& db;
+		std::string sql;
+		int format;
+	};
+
+
+
+	//--- Fn_copy_foreach ---
+	//fn type :
+	// type1 : void f(const xxx...&) : apply to all lines, no return
+	// type2 : bool f(const xxx...&) : apply until f returns false (return false), or no more lines (return true)
+	template<typename Return_tt, bool Multi_thread>
+	struct Fn_copy_foreach;
+
+	template<typename... Return_a>
+	struct Fn_copy_foreach<std::tuple<Return_a...>, false>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_copy_foreach(Fn_copy_foreach&&)=default;
+		Fn_copy_foreach(const Fn_copy_foreach&)=delete;
+		Fn_copy_foreach& operator=(const Fn_copy_foreach&)=delete;
+		Fn_copy_foreach()=delete;
+
+		Fn_copy_foreach(Connection_t<Tag_psql>& db_, const std::string &sql_, int format_=FORMAT_TEXT):db(db_),sql(sql_),format(format_){}
+
+		template<typename Fn_t>
+		auto operator()(Fn_t fn){
+			return impl::copy_foreach<Return_tt>(db,sql,format,fn);
+		}
+
+		Connection_t<Tag_psql>& db;
+		std::string sql;
+		int format;
+	};
+
+
+	template<typename... Return_a>
+	struct Fn_copy_foreach<std::tuple<Return_a...>, true>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_copy_foreach(Fn_copy_foreach&&)=default;
+		Fn_copy_foreach(const Fn_copy_foreach&)=delete;
+		Fn_copy_foreach& operator=(const Fn_copy_foreach&)=delete;
+		Fn_copy_foreach()=delete;
+
+		Fn_copy_foreach(Connection_t<Tag_psql>& db_, const std::string &sql_, int format_=FORMAT_TEXT):db(db_),sql(sql_),format(format_){}
+
+		template<typename Fn_t>
+		auto operator()(Fn_t fn){
+			auto l = tdb::impl::connection_lock_guard (db);
+			return impl::copy_foreach<Return_tt>(db,sql,format,fn);
+		}
+
+		Connection_t<Tag_psql>& db;
+		std::string sql;
+		int format;
+	};
+
+}//end namespace tdb::psql
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_COPY_OUT_HPP_ */
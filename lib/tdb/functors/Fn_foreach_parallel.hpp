@@ -0,0 +1,158 @@
+#ifndef LIB_TDB_FUNCTORS_FN_FOREACH_PARALLEL_HPP_
+#define LIB_TDB_FUNCTORS_FN_FOREACH_PARALLEL_HPP_
+
+//Same as Fn_foreach, but the applied function runs concurrently in a pool of worker threads.
+//tdb::Fn_foreach_parallel< Tag_xxx, std::tuple<int,std::string> , std::tuple<double>, true>
+//  fn(connection, tdb::Parallel_policy{8, 1024}, "select i, s from test where d1=$1");
+//fn([](int i, std::string s){...}, 1.0);                //unordered
+//bool b = fn([](int i, std::string s)->bool{...}, 1.0); //stops when f returns false
+//fn.ordered(
+//  [](int i, std::string s){return i*2;},               //map  : concurrently
+//  [&](int x){out << x;},                               //sink : one at a time, in row order
+//  1.0
+//);
+//
+//The calling thread steps the result, and moves the decoded rows into a bounded lock free
+//buffer (Parallel_policy::queue_size rows). Parallel_policy::nb_threads workers pop them, and
+//apply fn. The calling thread returns when all the rows are processed.
+//
+//multi thread version : the connection mutex is held while the rows are fetched only, and is
+//released as soon as the result is drained, while the workers are still running.
+//
+//functor type (the rows are moved into the function) :
+// type1 : void f(xxx...) : apply to all lines, no return
+// type2 : bool f(xxx...) : stop fetching when f returns false (return false), or no more lines (return true)
+//         the rows already being processed by other workers are completed.
+// f is shared by the workers : it must be safe to call it concurrently.
+//
+//ordered(map,sink,bind...) : map(xxx...) runs concurrently, sink(map result) is called
+//one call at a time, in the row order. sink can return bool (false : stop) as above.
+//
+//Exceptions : the first exception thrown by f (or map, sink, or the fetch) stops the loop,
+//and is rethrown in the calling thread, once the workers are joined.
+//
+//Borrowed types (std::string_view...) are refused, as rows outlive the fetch.
+
+
+#include "../tdb.hpp"
+#include <type_traits>
+
+#include "impl/Foreach_parallel.hpp"
+
+
+namespace tdb{
+
+
+	template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_thread>
+	struct Fn_foreach_parallel;
+
+	template<typename Tag_t,  typename... Return_a, typename... Bind_a>
+	struct Fn_foreach_parallel<Tag_t,  std::tuple<Return_a...> , std::tuple<Bind_a...> , false>{
+
+		typedef std::tuple<Return_a...> Return_tt;
+		typedef std::tuple<Bind_a...>   Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_foreach_parallel cannot return borrowed types (std::string_view, std::span...), they are invalidated by the next fetch");
+
+		template<typename... A>
+		Fn_foreach_parallel(Connection_t<Tag_t>& db_, const Parallel_policy &policy_, A&& ... a ):db(db_),policy(policy_){
+			auto s = tdb::sql<Tag_t>(std::forward<A>(a)...);
+			prepare_here<Return_tt,Bind_tt> (db,q,s);
+		}
+
+		//movable, NOT copiable
+		Fn_foreach_parallel(Fn_foreach_parallel&&)=default;
+		Fn_foreach_parallel(const Fn_foreach_parallel&)=delete;
+		Fn_foreach_parallel& operator=(const Fn_foreach_parallel&)=delete;
+		Fn_foreach_parallel()=delete;
+
+		Connection_t<Tag_t>& db;
+		Parallel_policy policy;
+		Query<Tag_t,Return_tt,Bind_tt > q;
+
+		//dispatch on  Fn_t type (returns bool, v.s. no return)
+		template<typename Fn_t>
+		auto operator()(Fn_t fn,  const Bind_a&... bind_me){
+			typedef typename std::invoke_result<Fn_t, Return_a...>::type return_t;
+			static constexpr bool is_bool = std::is_convertible<return_t,bool>::value;
+
+			if constexpr(is_bool){
+				return impl::foreach_parallel_unordered<false>(db,q,policy,fn,bind_me... );
+			}else{
+				impl::foreach_parallel_unordered<false>(db,q,policy,fn,bind_me... );
+			}
+		}
+
+		template<typename Map_t, typename Sink_t>
+		auto ordered(Map_t map, Sink_t sink,  const Bind_a&... bind_me){
+			typedef typename std::invoke_result<Map_t, Return_a...>::type mapped_t;
+			typedef typename std::invoke_result<Sink_t, mapped_t>::type return_t;
+			static constexpr bool is_bool = std::is_convertible<return_t,bool>::value;
+
+			if constexpr(is_bool){
+				return impl::foreach_parallel_ordered<false>(db,q,policy,map,sink,bind_me... );
+			}else{
+				impl::foreach_parallel_ordered<false>(db,q,policy,map,sink,bind_me... );
+			}
+		}
+
+	};
+
+
+	template<typename Tag_t,  typename... Return_a, typename... Bind_a>
+	struct Fn_foreach_parallel<Tag_t,  std::tuple<Return_a...> , std::tuple<Bind_a...> , true>{
+
+		typedef std::tuple<Return_a...> Return_tt;
+		typedef std::tuple<Bind_a...>   Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_foreach_parallel cannot return borrowed types (std::string_view, std::span...), they are invalidated by the next fetch");
+
+		//movable, NOT copiable
+		Fn_foreach_parallel(Fn_foreach_parallel&&)=default;
+		Fn_foreach_parallel(const Fn_foreach_parallel&)=delete;
+		Fn_foreach_parallel& operator=(const Fn_foreach_parallel&)=delete;
+		Fn_foreach_parallel()=delete;
+
+		template<typename... A>
+		Fn_foreach_parallel(Connection_t<Tag_t>& db_, const Parallel_policy &policy_, A&& ... a ):db(db_),policy(policy_){
+			auto l = impl::connection_lock_guard (db);
+			auto s = tdb::sql<Tag_t>(std::forward<A>(a)...);
+			prepare_here<Return_tt,Bind_tt> (db,q,s);
+		}
+
+		Connection_t<Tag_t>& db;
+		Parallel_policy policy;
+		Query<Tag_t,Return_tt,Bind_tt > q;
+
+		//dispatch on  Fn_t type (returns bool, v.s. no return)
+		template<typename Fn_t>
+		auto operator()(Fn_t fn,  const Bind_a&... bind_me){
+			typedef typename std::invoke_result<Fn_t, Return_a...>::type return_t;
+			static constexpr bool is_bool = std::is_convertible<return_t,bool>::value;
+
+			if constexpr(is_bool){
+				return impl::foreach_parallel_unordered<true>(db,q,policy,fn,bind_me... );
+			}else{
+				impl::foreach_parallel_unordered<true>(db,q,policy,fn,bind_me... );
+			}
+		}
+
+		template<typename Map_t, typename Sink_t>
+		auto ordered(Map_t map, Sink_t sink,  const Bind_a&... bind_me){
+			typedef typename std::invoke_result<Map_t, Return_a...>::type mapped_t;
+			typedef typename std::invoke_result<Sink_t, mapped_t>::type return_t;
+			static constexpr bool is_bool = std::is_convertible<return_t,bool>::value;
+
+			if constexpr(is_bool){
+				return impl::foreach_parallel_ordered<true>(db,q,policy,map,sink,bind_me... );
+			}else{
+				impl::foreach_parallel_ordered<true>(db,q,policy,map,sink,bind_me... );
+			}
+		}
+
+	};
+
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_FOREACH_PARALLEL_HPP_ */
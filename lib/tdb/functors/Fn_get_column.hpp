@@ -16,6 +16,7 @@ template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_threa
 
 		typedef Return_tt_ Return_tt;
 		typedef std::tuple<Bind_a...> Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_column cannot return borrowed types (std::string_view, std::span...), use Fn_foreach or Fn_function");
 		typedef typename std::tuple_element<0,Return_tt>::type el0_t;
 		static_assert(std::tuple_size<Return_tt>::value == 1, "Fn_get_column expect a single value in Return_tt");
 
@@ -68,6 +69,7 @@ template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_threa
 
 		typedef Return_tt_ Return_tt;
 		typedef std::tuple<Bind_a...> Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_column cannot return borrowed types (std::string_view, std::span...), use Fn_foreach or Fn_function");
 		typedef typename std::tuple_element<0,Return_tt>::type el0_t;
 		static_assert(std::tuple_size<Return_tt>::value == 1, "Fn_get_column expect a single value in Return_tt");
 
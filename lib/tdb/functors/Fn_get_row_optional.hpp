@@ -22,6 +22,7 @@ template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_threa
 
 		typedef Return_tt_ Return_tt;
 		typedef std::tuple<Bind_a...> Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_row_optional cannot return borrowed types (std::string_view, std::span...), use Fn_foreach or Fn_function");
 
 		//movable, NOT copiable
 		Fn_get_row_optional(Fn_get_row_optional&&)=default;
@@ -54,6 +55,7 @@ template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_threa
 
 		typedef Return_tt_ Return_tt;
 		typedef std::tuple<Bind_a...> Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_row_optional cannot return borrowed types (std::string_view, std::span...), use Fn_foreach or Fn_function");
 
 		//movable, NOT copiable
 		Fn_get_row_optional(Fn_get_row_optional&&)=default;
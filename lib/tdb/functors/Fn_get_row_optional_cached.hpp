@@ -0,0 +1,59 @@
+#ifndef LIB_TDB_FUNCTORS_FN_ROW_OPTIONAL_CACHED_HPP_
+#define LIB_TDB_FUNCTORS_FN_ROW_OPTIONAL_CACHED_HPP_
+
+//Fn_get_row_optional, with the rows cached by bound values (LRU, optional time to live)
+//tdb::Fn_get_row_optional_cached< Tag_xxx, std::tuple<std::string,double> , std::tuple<int>, true>
+//  fn(connection, tdb::Memo_policy{1024, std::chrono::seconds(60)}, "select name, rate from currency where id=$1");
+//std::optional<std::tuple<std::string,double> > r = fn(978);
+//fn.invalidate(978);
+//
+//0 row is cached too (empty optional), 2+ rows throw and are not cached.
+//See Fn_get_value_unique_cached for the invalidation, the stats and the multi thread version.
+
+
+#include "Fn_get_row_optional.hpp"
+#include "impl/Fn_cached.hpp"
+
+namespace tdb{
+
+	template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_thread>
+	struct Fn_get_row_optional_cached;
+
+	template<typename Tag_t,  typename Return_tt_, typename... Bind_a, bool Multi_thread>
+	struct Fn_get_row_optional_cached<Tag_t, Return_tt_, std::tuple<Bind_a...> , Multi_thread >{
+
+		typedef Return_tt_ Return_tt;
+		typedef std::tuple<Bind_a...> Bind_tt;
+		typedef std::optional<Return_tt> return_type;
+		typedef Fn_get_row_optional<Tag_t,Return_tt,Bind_tt,Multi_thread> Fn_type;
+
+		//movable, NOT copiable
+		Fn_get_row_optional_cached(Fn_get_row_optional_cached&&)=default;
+		Fn_get_row_optional_cached(const Fn_get_row_optional_cached&)=delete;
+		Fn_get_row_optional_cached& operator=(const Fn_get_row_optional_cached&)=delete;
+		Fn_get_row_optional_cached()=delete;
+
+		template<typename... A>
+		Fn_get_row_optional_cached(Connection_t<Tag_t>& db, const Memo_policy &policy, A&& ... a ):c(db,policy,std::forward<A>(a)...){}
+
+		return_type operator()( const Bind_a&... bind_me){return c.get(bind_me...);}
+
+		//--- invalidation ---
+		bool   invalidate(const Bind_a&... bind_me){return c.cache->erase(Bind_tt(bind_me...));} //true if it was cached
+		void   invalidate_all()                    {c.cache->clear();}
+		template<typename Pred_t>
+		size_t invalidate_if(Pred_t &&pred)        {return c.cache->erase_if(pred);} //pred(const Bind_tt&, const return_type&)
+
+		Memo_stats stats()  {return c.cache->stats();}
+		void reset_stats()  {c.cache->reset_stats();}
+		size_t cached_size(){return c.cache->size();}
+
+		impl::Fn_cached<Fn_type,return_type,Multi_thread> c;
+	};
+
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_ROW_OPTIONAL_CACHED_HPP_ */
@@ -22,6 +22,7 @@ template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_threa
 
 		typedef typename std::tuple_element<0, Return_tt>::type el0_t;
 		typedef std::tuple<Bind_a...> Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_value_optional cannot return borrowed types (std::string_view, std::span...), use Fn_foreach or Fn_function");
 
 		//movable, NOT copiable
 		Fn_get_value_optional(Fn_get_value_optional&&)=default;
@@ -57,6 +58,7 @@ template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_threa
 
 		typedef typename std::tuple_element<0, Return_tt>::type el0_t;
 		typedef std::tuple<Bind_a...> Bind_tt;
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_value_optional cannot return borrowed types (std::string_view, std::span...), use Fn_foreach or Fn_function");
 
 		//movable, NOT copiable
 		Fn_get_value_optional(Fn_get_value_optional&&)=default;
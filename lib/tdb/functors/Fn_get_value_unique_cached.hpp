@@ -0,0 +1,64 @@
+#ifndef LIB_TDB_FUNCTORS_FN_VALUE_UNIQUE_CACHED_HPP_
+#define LIB_TDB_FUNCTORS_FN_VALUE_UNIQUE_CACHED_HPP_
+
+//Fn_get_value_unique, with the values cached by bound values (LRU, optional time to live)
+//tdb::Fn_get_value_unique_cached< Tag_xxx, std::tuple<std::string> , std::tuple<int>, true>
+//  fn(connection, tdb::Memo_policy{1024, std::chrono::seconds(60)}, "select name from country where id=$1");
+//std::string r = fn(33); //the query runs once per id, until evicted, expired or invalidated
+//fn.invalidate(33);      //after an update of the country 33
+//fn.invalidate_all();
+//double h = fn.stats().hit_rate();
+//
+//0 row and 2+ rows throw, and are not cached (use Fn_get_row_optional_cached to cache missing rows)
+//multi thread version : the cache is split in Memo_policy::nb_shards, each with its own mutex.
+//The connection mutex is only locked on a miss.
+//The cache is not aware of the writes : invalidate the keys (or set a ttl) when the data changes.
+
+
+#include "Fn_get_value_unique.hpp"
+#include "impl/Fn_cached.hpp"
+
+namespace tdb{
+
+	template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_thread>
+	struct Fn_get_value_unique_cached;
+
+	template<typename Tag_t,  typename Return_tt, typename... Bind_a, bool Multi_thread>
+	struct Fn_get_value_unique_cached<Tag_t, Return_tt, std::tuple<Bind_a...> , Multi_thread >{
+		static_assert(std::tuple_size<Return_tt>::value == 1, "Fn_get_value_unique_cached expect a single value in Return_tt" );
+		static_assert(!impl::has_borrowed<Return_tt>,"Fn_get_value_unique_cached cannot return borrowed types (std::string_view, std::span...), they are invalidated by the next fetch");
+
+		typedef typename std::tuple_element<0, Return_tt>::type return_type;
+		typedef std::tuple<Bind_a...> Bind_tt;
+		typedef Fn_get_value_unique<Tag_t,Return_tt,Bind_tt,Multi_thread> Fn_type;
+
+		//movable, NOT copiable
+		Fn_get_value_unique_cached(Fn_get_value_unique_cached&&)=default;
+		Fn_get_value_unique_cached(const Fn_get_value_unique_cached&)=delete;
+		Fn_get_value_unique_cached& operator=(const Fn_get_value_unique_cached&)=delete;
+		Fn_get_value_unique_cached()=delete;
+
+		template<typename... A>
+		Fn_get_value_unique_cached(Connection_t<Tag_t>& db, const Memo_policy &policy, A&& ... a ):c(db,policy,std::forward<A>(a)...){}
+
+		return_type operator()( const Bind_a&... bind_me){return c.get(bind_me...);}
+
+		//--- invalidation ---
+		bool   invalidate(const Bind_a&... bind_me){return c.cache->erase(Bind_tt(bind_me...));} //true if it was cached
+		void   invalidate_all()                    {c.cache->clear();}
+		template<typename Pred_t>
+		size_t invalidate_if(Pred_t &&pred)        {return c.cache->erase_if(pred);} //pred(const Bind_tt&, const return_type&)
+
+		Memo_stats stats()  {return c.cache->stats();}
+		void reset_stats()  {c.cache->reset_stats();}
+		size_t cached_size(){return c.cache->size();}
+
+		impl::Fn_cached<Fn_type,return_type,Multi_thread> c;
+	};
+
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_VALUE_UNIQUE_CACHED_HPP_ */
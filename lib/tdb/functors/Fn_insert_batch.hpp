@@ -0,0 +1,155 @@
+#ifndef LIB_TDB_FUNCTORS_FN_INSERT_BATCH_HPP_
+#define LIB_TDB_FUNCTORS_FN_INSERT_BATCH_HPP_
+
+//Insert a range of rows with multi rows statements : head VALUES (...),(...),... tail
+//Each statement holds as many rows as the bind limit allows (sqlite : sqlite_max_variable_number,
+//psql : 65535 parameters), the rest is inserted with cached statements of 2^i rows.
+//
+//tdb::Fn_insert_batch<Tag_sqlite, std::tuple<>, std::tuple<int,double>, true> fn(connection, "insert into test(i1,d1)");
+//std::vector<std::tuple<int,double>> rows = ...;
+//size_t n = fn(rows);   //number of rows sent
+//
+//tail is optional ex : "on conflict do nothing"
+//max_rows (optional) limits the number of rows per statement
+//
+//NOTE : rowids are not available, and the statements are not wrapped in a transaction
+//(use tdb::transaction, or Fn_insert_batched, to make the whole range atomic).
+
+#include "../tdb.hpp"
+
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace tdb{
+
+	namespace impl{
+
+		template<typename Tag_t, typename Bind_tt>
+		struct Insert_batch_statements{
+			static_assert(Multi_insert_t<Tag_t,Bind_tt>::is_implemented,"Fn_insert_batch requires Multi_insert_t<Tag_t,Bind_tt>");
+			static constexpr size_t nb_cols = std::tuple_size<Bind_tt>::value;
+			static_assert(nb_cols!=0,"Fn_insert_batch requires at least one bound column");
+
+			Insert_batch_statements(Connection_t<Tag_t> &db_, const std::string &head_, const std::string &tail_, size_t max_rows):
+				db(db_),head(head_),tail(tail_)
+			{
+				const size_t limit = get_bind_limit(db);
+				if(limit < nb_cols){throw Exception_t<Tag_t>("Fn_insert_batch : a row has more parameters than the bind limit ("+std::to_string(limit)+"), sql="+head);}
+				rows_per_statement = std::min(limit/nb_cols, max_rows==0 ? size_t(1) : max_rows);
+			}
+
+			template<typename Range_t>
+			size_t run(const Range_t &rows){
+				auto it = std::begin(rows);
+				const size_t n = static_cast<size_t>(std::distance(it, std::end(rows)));
+
+				size_t remaining = n;
+				while(remaining >= rows_per_statement){
+					get(full, rows_per_statement).run(it);
+					remaining -= rows_per_statement;
+				}
+
+				//remaining < rows_per_statement : one statement per bit
+				for(size_t bit = 0; remaining != 0; ++bit){
+					const size_t nb = size_t(1) << bit;
+					if(remaining & nb){
+						if(tails.size() <= bit){tails.resize(bit+1);}
+						get(tails[bit], nb).run(it);
+						remaining -= nb;
+					}
+				}
+				return n;
+			}
+
+			Connection_t<Tag_t> &db;
+			std::string head;
+			std::string tail;
+			size_t rows_per_statement = 1;
+
+			Multi_insert_t<Tag_t,Bind_tt> full;                //rows_per_statement rows
+			std::vector<Multi_insert_t<Tag_t,Bind_tt> > tails; //tails[i] : 2^i rows
+
+			private:
+			//prepared on first use
+			Multi_insert_t<Tag_t,Bind_tt>& get(Multi_insert_t<Tag_t,Bind_tt> &m, size_t nb_rows){
+				if(m.nb_rows()==0){m = Multi_insert_t<Tag_t,Bind_tt>(db,head,tail,nb_rows);}
+				return m;
+			}
+		};
+
+	}
+
+
+
+	template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_thread>
+	struct Fn_insert_batch;
+
+	template<typename Tag_t,  typename... Return_a, typename... Bind_a>
+	struct Fn_insert_batch<Tag_t,  std::tuple<Return_a...> , std::tuple<Bind_a...> , false>{
+
+		typedef std::tuple<Return_a...> Return_tt;
+		typedef std::tuple<Bind_a...>   Bind_tt;
+		static_assert(std::tuple_size<Return_tt>::value==0,"Fn_insert_batch Return_tt must be std::tuple<> (as insert returns nothing)");
+
+		//movable, NOT copiable
+		Fn_insert_batch(Fn_insert_batch&&)=default;
+		Fn_insert_batch(const Fn_insert_batch&)=delete;
+		Fn_insert_batch& operator=(const Fn_insert_batch&)=delete;
+		Fn_insert_batch()=delete;
+
+		Fn_insert_batch(Connection_t<Tag_t>& db, const std::string &head, const std::string &tail="", size_t max_rows=std::numeric_limits<size_t>::max()):
+			batch(db,head,tail,max_rows){}
+
+		impl::Insert_batch_statements<Tag_t,Bind_tt> batch;
+
+		//rows : a range of tuples
+		template<typename Range_t>
+		size_t operator()(const Range_t &rows){
+			return batch.run(rows);
+		}
+
+		size_t rows_per_statement()const{return batch.rows_per_statement;}
+
+	};
+
+
+
+	template<typename Tag_t,  typename... Return_a, typename... Bind_a>
+	struct Fn_insert_batch<Tag_t,  std::tuple<Return_a...> , std::tuple<Bind_a...> , true>{
+
+		typedef std::tuple<Return_a...> Return_tt;
+		typedef std::tuple<Bind_a...>   Bind_tt;
+		static_assert(std::tuple_size<Return_tt>::value==0,"Fn_insert_batch Return_tt must be std::tuple<> (as insert returns nothing)");
+
+		//movable, NOT copiable
+		Fn_insert_batch(Fn_insert_batch&&)=default;
+		Fn_insert_batch(const Fn_insert_batch&)=delete;
+		Fn_insert_batch& operator=(const Fn_insert_batch&)=delete;
+		Fn_insert_batch()=delete;
+
+		Fn_insert_batch(Connection_t<Tag_t>& db_, const std::string &head, const std::string &tail="", size_t max_rows=std::numeric_limits<size_t>::max()):
+			db(db_),batch(db_,head,tail,max_rows){}
+
+		Connection_t<Tag_t>& db;
+		impl::Insert_batch_statements<Tag_t,Bind_tt> batch;
+
+		//rows : a range of tuples
+		template<typename Range_t>
+		size_t operator()(const Range_t &rows){
+			auto l = impl::connection_lock_guard (db);
+			return batch.run(rows);
+		}
+
+		size_t rows_per_statement()const{return batch.rows_per_statement;}
+
+	};
+
+
+
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_INSERT_BATCH_HPP_ */
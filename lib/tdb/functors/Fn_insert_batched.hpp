@@ -0,0 +1,258 @@
+#ifndef LIB_TDB_FUNCTORS_FN_INSERT_BATCHED_HPP_
+#define LIB_TDB_FUNCTORS_FN_INSERT_BATCHED_HPP_
+
+//Fn_insert that groups the inserts into transactions : without it each insert is its own
+//implicit transaction (i.e., one journal sync per row with sqlite).
+//
+//tdb::Fn_insert_batched<Tag_sqlite, std::tuple<>, std::tuple<int,double>, true>
+//  fn(connection, tdb::Batch_policy{1000, std::chrono::milliseconds(500)}, "insert into test(i1,d1) values($1,$2)");
+//tdb::Rowid<Tag_sqlite> r = fn(42, 0.5);
+//fn.flush();  //commit now
+//
+//A transaction is started by the first insert, and commited when :
+// - max_rows rows are inserted
+// - max_delay is elapsed since the first insert of the batch
+// - flush() is called
+// - the functor is destroyed (rollback if it is destroyed by an exception)
+//max_delay is only checked by the inserts : there is no timer, an idle batch stays open (and with
+//sqlite, keeps the write lock). Call flush() when the inserts stop.
+//
+//Errors :
+// - an insert that fails throws, the batch goes on : the rows already inserted (and their Rowid)
+//   stay in the batch. With psql (where an error aborts the transaction, see
+//   Error_aborts_transaction_t), each insert runs inside a SAVEPOINT to undo only the failed one.
+// - a commit that fails rolls the batch back and throws. lost() tells how many rows were lost.
+//BEGIN, COMMIT, ROLLBACK and the savepoints are prepared once, by the constructor.
+//
+//WARNING : between two commits, the connection is inside a transaction. Other queries run on the
+//same connection are part of the batch, and must not start or end transactions.
+
+#include "../tdb.hpp"
+
+#include <chrono>
+#include <exception>
+
+namespace tdb{
+
+	struct Batch_policy{
+		size_t                    max_rows  = 1000;
+		std::chrono::milliseconds max_delay = std::chrono::milliseconds(1000); //0 : no time limit
+	};
+
+	namespace impl{
+
+		template<typename Tag_t, typename Return_tt, typename Bind_tt>
+		struct Insert_batcher{
+			typedef std::chrono::steady_clock clock_t;
+			typedef Query<Tag_t,std::tuple<>,std::tuple<> > Statement_t;
+			static constexpr bool use_savepoints = Error_aborts_transaction_t<Tag_t>::value;
+
+			//prepared now : the multi thread version runs them while it holds the connection mutex
+			Insert_batcher(Connection_t<Tag_t>& db_, const Batch_policy &policy_):
+				db(db_),
+				policy(policy_),
+				q_begin   (prepare_new<std::tuple<>,std::tuple<> >(db_,"BEGIN transaction")),
+				q_commit  (prepare_new<std::tuple<>,std::tuple<> >(db_,"COMMIT")),
+				q_rollback(prepare_new<std::tuple<>,std::tuple<> >(db_,"ROLLBACK"))
+			{
+				if constexpr(use_savepoints){
+					prepare_here(db_,q_savepoint,  "SAVEPOINT tdb_batched");
+					prepare_here(db_,q_release,    "RELEASE SAVEPOINT tdb_batched");
+					prepare_here(db_,q_rollback_to,"ROLLBACK TO SAVEPOINT tdb_batched");
+				}
+			}
+
+			Insert_batcher(Insert_batcher &&a):
+				db(a.db),policy(a.policy),q(std::move(a.q)),nb_pending(a.nb_pending),nb_lost(a.nb_lost),started(a.started),
+				q_begin(std::move(a.q_begin)),q_commit(std::move(a.q_commit)),q_rollback(std::move(a.q_rollback)),
+				q_savepoint(std::move(a.q_savepoint)),q_release(std::move(a.q_release)),q_rollback_to(std::move(a.q_rollback_to)),
+				in_transaction(a.in_transaction),nb_exceptions(a.nb_exceptions)
+			{
+				a.in_transaction=false;
+				a.nb_pending=0;
+			}
+			Insert_batcher(const Insert_batcher&)=delete;
+			Insert_batcher& operator=(const Insert_batcher&)=delete;
+
+			~Insert_batcher() noexcept(false){close();}
+
+			//commit, or rollback if an exception is in flight
+			void close(){
+				if(!in_transaction){return;}
+				if(std::uncaught_exceptions()>nb_exceptions){
+					try{rollback();}catch(...){} //already unwinding
+				}else{
+					flush();
+				}
+			}
+
+			template<typename... Bind_a>
+			tdb::Rowid<Tag_t> insert(const Bind_a&... bind_me){
+				if(!in_transaction){begin();}
+				tdb::Rowid<Tag_t> r = insert_one(bind_me...);
+				++nb_pending;
+				if(nb_pending >= policy.max_rows || (policy.max_delay.count()>0 && clock_t::now()-started >= policy.max_delay) ){flush();}
+				return r;
+			}
+
+			void flush(){
+				if(!in_transaction){return;}
+				try{commit();}
+				catch(...){
+					try{rollback();}catch(...){}
+					throw;
+				}
+			}
+
+			Connection_t<Tag_t>& db;
+			Batch_policy policy;
+			Query<Tag_t,Return_tt,Bind_tt > q;
+			size_t nb_pending = 0; //inserted, not commited yet
+			size_t nb_lost    = 0; //rolled back, the last time the batch failed
+			clock_t::time_point started;
+
+			private:
+			Statement_t q_begin, q_commit, q_rollback;
+			Statement_t q_savepoint, q_release, q_rollback_to; //use_savepoints only
+			bool in_transaction = false;
+			int  nb_exceptions  = std::uncaught_exceptions();
+
+			template<typename... Bind_a>
+			tdb::Rowid<Tag_t> insert_one(const Bind_a&... bind_me){
+				if constexpr(use_savepoints){
+					tdb::execute(q_savepoint);
+					try{
+						auto r = tdb::insert_a(q,bind_me...);
+						tdb::execute(q_release);
+						return r;
+					}catch(...){
+						try{
+							tdb::execute(q_rollback_to);
+							tdb::execute(q_release);
+						}catch(...){
+							try{rollback();}catch(...){} //the batch is lost
+						}
+						throw;
+					}
+				}else{
+					return tdb::insert_a(q,bind_me...);
+				}
+			}
+
+			void begin(){
+				tdb::execute(q_begin);
+				in_transaction=true;
+				started=clock_t::now();
+			}
+
+			void commit(){
+				tdb::execute(q_commit);
+				in_transaction=false;
+				nb_pending=0;
+			}
+
+			void rollback(){
+				in_transaction=false;
+				nb_lost=nb_pending;
+				nb_pending=0;
+				tdb::execute(q_rollback);
+			}
+		};
+
+	}
+
+
+
+	template<typename Tag_t,  typename Return_tt, typename Bind_tt, bool Multi_thread>
+	struct Fn_insert_batched;
+
+	template<typename Tag_t,  typename... Return_a, typename... Bind_a>
+	struct Fn_insert_batched<Tag_t,  std::tuple<Return_a...> , std::tuple<Bind_a...> , false>{
+
+		typedef std::tuple<Return_a...> Return_tt;
+		typedef std::tuple<Bind_a...>   Bind_tt;
+		static_assert(std::tuple_size<Return_tt>::value==0,"Fn_insert_batched Return_tt must be std::tuple<> (as insert returns nothing)");
+
+		//movable, NOT copiable
+		Fn_insert_batched(Fn_insert_batched&&)=default;
+		Fn_insert_batched(const Fn_insert_batched&)=delete;
+		Fn_insert_batched& operator=(const Fn_insert_batched&)=delete;
+		Fn_insert_batched()=delete;
+
+		template<typename... A>
+		Fn_insert_batched(Connection_t<Tag_t>& db, const Batch_policy &policy, A&& ... a ):batch(db,policy){
+			auto s = tdb::sql<Tag_t>(std::forward<A>(a)...);
+			prepare_here<Return_tt,Bind_tt> (db,batch.q,s);
+		}
+
+		impl::Insert_batcher<Tag_t,Return_tt,Bind_tt> batch;
+
+		tdb::Rowid<Tag_t> operator()(const Bind_a&... bind_me){
+			return batch.insert(bind_me...);
+		}
+
+		void   flush()        {batch.flush();}
+		size_t pending()const {return batch.nb_pending;} //inserted, not commited yet
+		size_t lost()const    {return batch.nb_lost;}    //rolled back, the last time the batch failed
+
+	};
+
+
+
+	template<typename Tag_t,  typename... Return_a, typename... Bind_a>
+	struct Fn_insert_batched<Tag_t,  std::tuple<Return_a...> , std::tuple<Bind_a...> , true>{
+
+		typedef std::tuple<Return_a...> Return_tt;
+		typedef std::tuple<Bind_a...>   Bind_tt;
+		static_assert(std::tuple_size<Return_tt>::value==0,"Fn_insert_batched Return_tt must be std::tuple<> (as insert returns nothing)");
+
+		//movable, NOT copiable
+		Fn_insert_batched(Fn_insert_batched&&)=default;
+		Fn_insert_batched(const Fn_insert_batched&)=delete;
+		Fn_insert_batched& operator=(const Fn_insert_batched&)=delete;
+		Fn_insert_batched()=delete;
+
+		template<typename... A>
+		Fn_insert_batched(Connection_t<Tag_t>& db_, const Batch_policy &policy, A&& ... a ):db(db_),batch(db_,policy){
+			auto s = tdb::sql<Tag_t>(std::forward<A>(a)...);
+			prepare_here<Return_tt,Bind_tt> (db,batch.q,s);
+		}
+
+		~Fn_insert_batched() noexcept(false){
+			auto l = impl::connection_lock_guard (db);
+			batch.close(); //commit (or rollback) while locked
+		}
+
+		Connection_t<Tag_t>& db;
+		impl::Insert_batcher<Tag_t,Return_tt,Bind_tt> batch;
+
+		tdb::Rowid<Tag_t> operator()(const Bind_a&... bind_me){
+			auto l = impl::connection_lock_guard (db);
+			return batch.insert(bind_me...);
+		}
+
+		void flush(){
+			auto l = impl::connection_lock_guard (db);
+			batch.flush();
+		}
+
+		size_t pending(){
+			auto l = impl::connection_lock_guard (db);
+			return batch.nb_pending;
+		}
+
+		size_t lost(){
+			auto l = impl::connection_lock_guard (db);
+			return batch.nb_lost;
+		}
+
+	};
+
+
+
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_INSERT_BATCHED_HPP_ */
@@ -0,0 +1,156 @@
+#ifndef LIB_TDB_FUNCTORS_FN_PARALLEL_EXPORT_HPP_
+#define LIB_TDB_FUNCTORS_FN_PARALLEL_EXPORT_HPP_
+
+//psql only : export a table with nb_threads connections, all reading the same snapshot.
+//The range [min(key),max(key)] of the table is split in nb_partitions, and the query is run once
+//per partition, with the bounds bound to $1 and $2 (inclusive, int8). The threads take the next
+//partition until none is left, so a slow partition doesn't hold the others.
+//
+//tdb::psql::Fn_parallel_export<std::tuple<int,std::string>, true>
+//  fn(connection, tdb::psql::Export_policy{8}, "test", "id", "select id, s from test where id between $1 and $2 order by id");
+//std::vector<std::tuple<int,std::string>> v;
+//fn(v);                                           //container or output iterator, rows in the partition order
+//fn([](int i, const std::string &s)->void{...});   //called concurrently by the threads
+//bool b = fn([](int i, const std::string &s)->bool{...}); //stop when false is returned
+//
+//key must be an integer column (preferably indexed). table and key are sql identifiers, written
+//as is in "select min(key)::int8, max(key)::int8 from table".
+//The connections are opened with the parameters of connection (psql::conninfo), its default format,
+//and Export_policy::chunk_size (each partition is streamed, see set_default_chunk_size).
+//Each call starts a REPEATABLE READ READ ONLY transaction on all the connections, on the snapshot
+//exported by the first one (see psql::begin_read_same_snapshot) : the rows commited meanwhile are not seen.
+//The first exception (fn, or a fetch) stops the export, and is rethrown once the threads are joined.
+//
+//fn(container) copies the rows, and holds them in memory until the end of the export : use
+//a callback for large tables.
+//multi thread version : the connection mutex is held while the connections are opened, the calls
+//of a same functor are serialized.
+
+
+#include "../tdb_psql.hpp"
+#include "impl/Parallel_scan.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace tdb::psql{
+
+	struct Export_policy{
+		size_t nb_threads    = 0;    //connections and threads, 0 : std::thread::hardware_concurrency()
+		size_t nb_partitions = 0;    //0 : 8*nb_threads
+		int    chunk_size    = 1000; //rows held in memory per connection, 0 : whole partitions
+	};
+
+	namespace impl{
+
+		struct Export_snapshot{
+			typedef std::int64_t key_type;
+			static void begin(const std::vector<Connection_t<Tag_psql>*> &readers, Connection_t<Tag_psql>&){begin_read_same_snapshot(readers);}
+			static void end(Connection_t<Tag_psql> &reader){end_read(reader);}
+		};
+
+		template<typename Return_tt>
+		using Parallel_exporter = tdb::impl::Parallel_scanner<Tag_psql,Return_tt,Export_snapshot>;
+
+		template<typename Return_tt, typename Sql_t>
+		std::unique_ptr<Parallel_exporter<Return_tt> > make_parallel_exporter(Connection_t<Tag_psql> &db, const Export_policy &policy, const std::string &table, const std::string &key, const Sql_t &s){
+			const std::string c = conninfo(db);
+			const int format    = db.default_format();
+
+			return std::make_unique<Parallel_exporter<Return_tt> >(
+				tdb::impl::scan_nb_threads(policy.nb_threads), policy.nb_partitions,
+				[&](){
+					auto r = std::make_unique<Connection_t<Tag_psql> >(c);
+					r->set_default_format(format);
+					r->set_default_chunk_size(policy.chunk_size);
+					return r;
+				},
+				"select min(" + key + ")::int8, max(" + key + ")::int8 from " + table,
+				s
+			);
+		}
+	}
+
+
+
+	//--- Fn_parallel_export ---
+	template<typename Return_tt, bool Multi_thread>
+	struct Fn_parallel_export;
+
+	template<typename... Return_a>
+	struct Fn_parallel_export<std::tuple<Return_a...>, false>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_parallel_export(Fn_parallel_export&&)=default;
+		Fn_parallel_export(const Fn_parallel_export&)=delete;
+		Fn_parallel_export& operator=(const Fn_parallel_export&)=delete;
+		Fn_parallel_export()=delete;
+
+		template<typename... A>
+		Fn_parallel_export(Connection_t<Tag_psql>& db_, const Export_policy &policy, const std::string &table, const std::string &key, A&& ... a ):db(db_){
+			auto s = tdb::sql<Tag_psql>(std::forward<A>(a)...);
+			exporter = impl::make_parallel_exporter<Return_tt>(db,policy,table,key,s);
+		}
+
+		Connection_t<Tag_psql>& db;
+		std::unique_ptr<impl::Parallel_exporter<Return_tt> > exporter;
+
+		//dispatch on Fn_t type : callable (void or bool), or container / output iterator
+		template<typename Fn_t>
+		auto operator()(Fn_t &&fn){
+			if constexpr(std::is_invocable<Fn_t&,Return_a&...>::value){
+				return tdb::impl::parallel_scan_foreach<Return_tt>(db,*exporter,tdb::impl::Scan_no_lock(),fn);
+			}else{
+				tdb::impl::parallel_scan_table<Return_tt>(db,*exporter,tdb::impl::Scan_no_lock(),fn);
+			}
+		}
+
+		size_t nb_threads()const{return exporter->readers.size();}
+	};
+
+
+	template<typename... Return_a>
+	struct Fn_parallel_export<std::tuple<Return_a...>, true>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_parallel_export(Fn_parallel_export&&)=default;
+		Fn_parallel_export(const Fn_parallel_export&)=delete;
+		Fn_parallel_export& operator=(const Fn_parallel_export&)=delete;
+		Fn_parallel_export()=delete;
+
+		template<typename... A>
+		Fn_parallel_export(Connection_t<Tag_psql>& db_, const Export_policy &policy, const std::string &table, const std::string &key, A&& ... a ):db(db_){
+			auto l = tdb::impl::connection_lock_guard (db);
+			auto s = tdb::sql<Tag_psql>(std::forward<A>(a)...);
+			exporter = impl::make_parallel_exporter<Return_tt>(db,policy,table,key,s);
+		}
+
+		Connection_t<Tag_psql>& db;
+		std::unique_ptr<impl::Parallel_exporter<Return_tt> > exporter;
+
+		//dispatch on Fn_t type : callable (void or bool), or container / output iterator
+		//db is not used by the export : no lock
+		template<typename Fn_t>
+		auto operator()(Fn_t &&fn){
+			std::lock_guard<std::mutex> l(exporter->call_mutex);
+			if constexpr(std::is_invocable<Fn_t&,Return_a&...>::value){
+				return tdb::impl::parallel_scan_foreach<Return_tt>(db,*exporter,tdb::impl::Scan_no_lock(),fn);
+			}else{
+				tdb::impl::parallel_scan_table<Return_tt>(db,*exporter,tdb::impl::Scan_no_lock(),fn);
+			}
+		}
+
+		size_t nb_threads()const{return exporter->readers.size();}
+	};
+
+}//end namespace tdb::psql
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_PARALLEL_EXPORT_HPP_ */
@@ -0,0 +1,152 @@
+#ifndef LIB_TDB_FUNCTORS_FN_PARALLEL_SCAN_HPP_
+#define LIB_TDB_FUNCTORS_FN_PARALLEL_SCAN_HPP_
+
+//sqlite only : scan a table with nb_threads read only connections, all reading the same snapshot.
+//The range [min(key),max(key)] of the table is split in nb_partitions, and the query is run once
+//per partition, with the bounds bound to $1 and $2 (inclusive). The threads take the next partition
+//until none is left, so a slow partition doesn't hold the others.
+//
+//tdb::sqlite::Fn_parallel_scan<std::tuple<int,double>, true>
+//  fn(connection, tdb::sqlite::Scan_policy{8}, "test", "rowid", "select i1, d1 from test where rowid between $1 and $2 order by rowid");
+//std::vector<std::tuple<int,double>> v;
+//fn(v);                                   //container or output iterator, rows in the partition order
+//fn([](int i, double d)->void{...});       //called concurrently by the threads
+//bool b = fn([](int i, double d)->bool{...}); //stop when false is returned
+//
+//key must be an integer column (rowid, or an INTEGER key, preferably indexed). table and key are
+//sql identifiers, written as is in "select min(key), max(key) from table".
+//The readers are opened (Scan_policy::options, read only) on the file of connection : an in memory
+//database cannot be scanned. Each call starts a read transaction on all the readers, on the same
+//snapshot (see sqlite::begin_read_same_snapshot, which throws when it cannot be guaranteed) : the rows
+//commited meanwhile are not seen.
+//The first exception (fn, or a fetch) stops the scan, and is rethrown once the threads are joined.
+//
+//fn(container) copies the rows, borrowed types are refused. The callbacks can use borrowed types,
+//valid until fn returns.
+//multi thread version : the connection mutex is held only while the snapshot is taken, the calls
+//of a same functor are serialized.
+
+
+#include "../tdb_sqlite.hpp"
+#include "impl/Parallel_scan.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace tdb::sqlite{
+
+	struct Scan_policy{
+		size_t  nb_threads    = 0; //readers and threads, 0 : std::thread::hardware_concurrency()
+		size_t  nb_partitions = 0; //0 : 8*nb_threads
+		Options options       = Options::read_only_analytics(); //of the readers (read_only is forced)
+	};
+
+	namespace impl{
+
+		struct Scan_snapshot{
+			typedef sqlite3_int64 key_type;
+			static void begin(const std::vector<Connection_t<Tag_sqlite>*> &readers, Connection_t<Tag_sqlite> &source){begin_read_same_snapshot(readers,&source);}
+			static void end(Connection_t<Tag_sqlite> &reader){end_read(reader);}
+		};
+
+		template<typename Return_tt>
+		using Parallel_scanner = tdb::impl::Parallel_scanner<Tag_sqlite,Return_tt,Scan_snapshot>;
+
+		template<typename Return_tt, typename Sql_t>
+		std::unique_ptr<Parallel_scanner<Return_tt> > make_parallel_scanner(Connection_t<Tag_sqlite> &db, const Scan_policy &policy, const std::string &table, const std::string &key, const Sql_t &s){
+			const char *f = sqlite3_db_filename(db.native_connection,"main");
+			if(f==nullptr or f[0]=='\0'){throw Exception_t<Tag_sqlite>("Fn_parallel_scan needs a database file, not an in memory database");}
+			const std::string filename = f;
+			Options o = policy.options;
+			o.read_only = true;
+
+			return std::make_unique<Parallel_scanner<Return_tt> >(
+				tdb::impl::scan_nb_threads(policy.nb_threads), policy.nb_partitions,
+				[&](){return std::make_unique<Connection_t<Tag_sqlite> >(filename,o);},
+				"select min(" + key + "), max(" + key + ") from " + table,
+				s
+			);
+		}
+	}
+
+
+
+	//--- Fn_parallel_scan ---
+	template<typename Return_tt, bool Multi_thread>
+	struct Fn_parallel_scan;
+
+	template<typename... Return_a>
+	struct Fn_parallel_scan<std::tuple<Return_a...>, false>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_parallel_scan(Fn_parallel_scan&&)=default;
+		Fn_parallel_scan(const Fn_parallel_scan&)=delete;
+		Fn_parallel_scan& operator=(const Fn_parallel_scan&)=delete;
+		Fn_parallel_scan()=delete;
+
+		template<typename... A>
+		Fn_parallel_scan(Connection_t<Tag_sqlite>& db_, const Scan_policy &policy, const std::string &table, const std::string &key, A&& ... a ):db(db_){
+			auto s = tdb::sql<Tag_sqlite>(std::forward<A>(a)...);
+			scanner = impl::make_parallel_scanner<Return_tt>(db,policy,table,key,s);
+		}
+
+		Connection_t<Tag_sqlite>& db;
+		std::unique_ptr<impl::Parallel_scanner<Return_tt> > scanner;
+
+		//dispatch on Fn_t type : callable (void or bool), or container / output iterator
+		template<typename Fn_t>
+		auto operator()(Fn_t &&fn){
+			if constexpr(std::is_invocable<Fn_t&,Return_a&...>::value){
+				return tdb::impl::parallel_scan_foreach<Return_tt>(db,*scanner,tdb::impl::Scan_no_lock(),fn);
+			}else{
+				tdb::impl::parallel_scan_table<Return_tt>(db,*scanner,tdb::impl::Scan_no_lock(),fn);
+			}
+		}
+
+		size_t nb_threads()const{return scanner->readers.size();}
+	};
+
+
+	template<typename... Return_a>
+	struct Fn_parallel_scan<std::tuple<Return_a...>, true>{
+		typedef std::tuple<Return_a...> Return_tt;
+
+		//movable, NOT copiable
+		Fn_parallel_scan(Fn_parallel_scan&&)=default;
+		Fn_parallel_scan(const Fn_parallel_scan&)=delete;
+		Fn_parallel_scan& operator=(const Fn_parallel_scan&)=delete;
+		Fn_parallel_scan()=delete;
+
+		template<typename... A>
+		Fn_parallel_scan(Connection_t<Tag_sqlite>& db_, const Scan_policy &policy, const std::string &table, const std::string &key, A&& ... a ):db(db_){
+			auto l = tdb::impl::connection_lock_guard (db);
+			auto s = tdb::sql<Tag_sqlite>(std::forward<A>(a)...);
+			scanner = impl::make_parallel_scanner<Return_tt>(db,policy,table,key,s);
+		}
+
+		Connection_t<Tag_sqlite>& db;
+		std::unique_ptr<impl::Parallel_scanner<Return_tt> > scanner;
+
+		//dispatch on Fn_t type : callable (void or bool), or container / output iterator
+		template<typename Fn_t>
+		auto operator()(Fn_t &&fn){
+			std::lock_guard<std::mutex> l(scanner->call_mutex);
+			if constexpr(std::is_invocable<Fn_t&,Return_a&...>::value){
+				return tdb::impl::parallel_scan_foreach<Return_tt>(db,*scanner,tdb::impl::Scan_connection_lock(),fn);
+			}else{
+				tdb::impl::parallel_scan_table<Return_tt>(db,*scanner,tdb::impl::Scan_connection_lock(),fn);
+			}
+		}
+
+		size_t nb_threads()const{return scanner->readers.size();}
+	};
+
+}//end namespace tdb::sqlite
+
+
+
+#endif /* LIB_TDB_FUNCTORS_FN_PARALLEL_SCAN_HPP_ */
@@ -18,19 +18,24 @@
 
 //--- insert, execute ---
 #include "Fn_insert.hpp"   //Rowid<Tag_xxx> fn(bind_me...)
+#include "Fn_insert_batched.hpp" //Rowid<Tag_xxx> fn(bind_me...), commit by batch
+#include "Fn_insert_batch.hpp"   //size_t         fn(range_of_rows), multi rows VALUES
 #include "Fn_execute.hpp"  //void           fn(bind_me...)
 
 //--- Get a unique value ---
 #include "Fn_get_value_unique.hpp"     //T                 fn(bind_me...)
 #include "Fn_get_value_optional.hpp"   //std::optional<T>  fn(bind_me...)
+#include "Fn_get_value_unique_cached.hpp" //T               fn(bind_me...), cached by bound values
 
 //--- Get a row in a tuple ---
 #include "Fn_get_row_unique.hpp"     //std::tuple<Retunr_t...>                  fn(bind_me...)
 #include "Fn_get_row_optional.hpp"   //std::optional<std::tuple<Retunr_t...> >  fn(bind_me...)
+#include "Fn_get_row_optional_cached.hpp" //std::optional<std::tuple<Retunr_t...> > fn(bind_me...), cached by bound values
 
 //--- apply a functor to all/some lines ---
 #include "Fn_foreach.hpp"    //void_or_bool   fn([](...){}, bind_me... );
 #include "Fn_function.hpp"   //void_or_bool   fn(           bind_me... );
+#include "Fn_foreach_parallel.hpp" //void_or_bool fn([](...){}, bind_me... ), fn runs in a thread pool
 
 //TODO a non blocking version,
 //- that encapsulate functors into jobs.
@@ -0,0 +1,62 @@
+#include "../Fn_get_value_unique_cached.hpp"
+#include "../Fn_get_row_optional_cached.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <tdb/tdb_sqlite.hpp>
+
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	typedef tdb::Tag_sqlite Tag_xxx;
+	tdb::Connection_t<Tag_xxx> connection("/tmp/test.sqlite");
+
+	//--- Fn_get_value_unique_cached ---
+	//multi thread, 4096 values in 16 shards, no expiry
+    tdb::Fn_get_value_unique_cached<
+	  Tag_xxx ,
+	  std::tuple<int>,
+	  std::tuple<double>,
+      true
+	> fn_value1(connection, tdb::Memo_policy{4096}, "select max(i1) from test where d1 = $1");
+    [[maybe_unused]] int i1 = fn_value1(1.0); //query
+    [[maybe_unused]] int i2 = fn_value1(1.0); //cached
+    fn_value1.invalidate(1.0);
+    std::cout << "hit rate " << fn_value1.stats().hit_rate() << std::endl;
+
+	//single thread, values expire after 10s
+    tdb::Fn_get_value_unique_cached<
+	  Tag_xxx ,
+	  std::tuple<int>,
+	  std::tuple<double>,
+      false
+	> fn_value2(connection, tdb::Memo_policy{128, std::chrono::seconds(10)}, "select max(i1) from test where d1 = $1");
+    [[maybe_unused]] int i3 = fn_value2(1.0);
+    fn_value2.invalidate_all();
+
+
+	//--- Fn_get_row_optional_cached ---
+    //multi thread, missing rows are cached too
+    tdb::Fn_get_row_optional_cached<
+	  Tag_xxx ,
+	  std::tuple<int,int>,
+	  std::tuple<double,double>,
+      true
+	> fn_row1(connection, tdb::Memo_policy(), "select i1, i2 from test where d1 = $1 and d2 = $2");
+    [[maybe_unused]] std::optional<std::tuple<int,int> > r1 = fn_row1(1.0,2.0);
+    [[maybe_unused]] size_t n = fn_row1.invalidate_if([](const std::tuple<double,double> &k, const std::optional<std::tuple<int,int> > &){return std::get<0>(k) > 0;});
+
+    //single thread
+    tdb::Fn_get_row_optional_cached<
+	  Tag_xxx ,
+	  std::tuple<int,int>,
+	  std::tuple<double,double>,
+      false
+	> fn_row2(connection, tdb::Memo_policy{16}, "select i1, i2 from test where d1 = $1 and d2 = $2");
+    [[maybe_unused]] std::optional<std::tuple<int,int> > r2 = fn_row2(1.0,2.0);
+
+}
+}
@@ -0,0 +1,62 @@
+#include "../Fn_copy_out.hpp"
+
+#include <iostream>
+#include <tdb/tdb_psql.hpp>
+
+#include <container/vector.hpp>
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	tdb::Connection_t<tdb::Tag_psql> connection("pierre","127.0.0.1","pierre","xxxxx");
+
+
+	//--- Fn_copy_table ---
+	//multi thread
+    tdb::psql::Fn_copy_table<
+	  std::tuple<int,double>,
+      true
+	> fn_copy_table1(connection, "select i1,d1 from test");
+
+    std::vector<std::tuple<int,double>> v1;
+    fn_copy_table1(v1);                      //container
+    fn_copy_table1(std::back_inserter(v1));  //output iterator
+
+    //single thread, binary format (types must match the columns)
+    tdb::psql::Fn_copy_table<
+	  std::tuple<int,double>,
+      false
+	> fn_copy_table2(connection, "select i1,d1 from test", tdb::psql::FORMAT_BINARY);
+
+    std::vector<std::tuple<int,double>> v2;
+    fn_copy_table2(v2);
+
+
+
+	//--- Fn_copy_foreach ---
+	//multi thread, void
+    tdb::psql::Fn_copy_foreach<
+	  std::tuple<int,double>,
+      true
+	> fn_copy_foreach1(connection, "select i1,d1 from test");
+    fn_copy_foreach1( [](int i, double d){std::cout <<i<<" "<<d<<std::endl;} );
+
+	//single thread, bool (stop at the first negative value)
+    tdb::psql::Fn_copy_foreach<
+	  std::tuple<int,double>,
+      false
+	> fn_copy_foreach2(connection, "select i1,d1 from test");
+    [[maybe_unused]] bool b = fn_copy_foreach2( [](int i, double)->bool{return i>=0;} );
+
+
+
+	//--- Copy_out_t ---
+    tdb::psql::Copy_out_t<std::tuple<int,std::optional<double>>> copy(connection,"select i1,d1 from test");
+    while(auto r = copy.try_fetch()){
+    	std::cout << std::get<0>(r.value()) <<std::endl;
+    }
+
+}
+}
@@ -58,5 +58,17 @@ namespace{
 
 
 
+	//--- Fn_foreach (borrowed, sqlite) ---
+	//std::string_view and std::span<const std::byte> point into the result, nothing is copied.
+	//They are only valid inside fn (until the next row is fetched)
+    tdb::Fn_foreach<
+	  Tag_xxx ,
+	  std::tuple<std::string_view, std::optional<std::span<const std::byte>> >,
+	  std::tuple<>,
+      true
+	> fn_foreach5(connection, "select s1, b1 from test");
+    size_t total = 0;
+    fn_foreach5( [&](std::string_view s, std::optional<std::span<const std::byte>> b){total += s.size() + (b ? b->size() : 0);} );
+
     }
 }
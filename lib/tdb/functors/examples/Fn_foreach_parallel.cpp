@@ -0,0 +1,52 @@
+#include "../Fn_foreach_parallel.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <tdb/tdb_sqlite.hpp>
+
+//test code
+namespace{
+    [[maybe_unused]] void example(){
+
+	typedef tdb::Tag_sqlite Tag_xxx;
+	tdb::Connection_t<Tag_xxx> connection("/tmp/test.sqlite");
+
+
+	//--- Fn_foreach_parallel (void) ---
+	//4 workers, at most 256 rows fetched ahead
+    tdb::Fn_foreach_parallel<
+	  Tag_xxx ,
+	  std::tuple<int,std::string>,
+	  std::tuple<double>,
+      true
+	> fn_foreach(connection, tdb::Parallel_policy{4,256}, "select i1, s1 from test where d1 != $1");
+    std::atomic<size_t> total = 0;
+    fn_foreach( [&](int i, std::string s){total += s.size() + static_cast<size_t>(i);}, 1.0);
+
+
+	//--- Fn_foreach_parallel (bool) ---
+    [[maybe_unused]] bool b = fn_foreach( [&](int i, std::string)->bool{return i < 1000;}, 1.0);
+
+
+	//--- Fn_foreach_parallel (ordered) ---
+	//the lengths are computed concurrently, and printed in the row order
+    fn_foreach.ordered(
+      [](int, std::string s){return s.size();},
+      [](size_t n){std::cout << n << std::endl;},
+      1.0
+    );
+
+
+	//single thread : the connection is not locked, nb_threads = std::thread::hardware_concurrency()
+    tdb::Fn_foreach_parallel<
+	  Tag_xxx ,
+	  std::tuple<int>,
+	  std::tuple<>,
+      false
+	> fn_foreach2(connection, tdb::Parallel_policy{}, "select i1 from test");
+    fn_foreach2( [&](int i){total += static_cast<size_t>(i);} );
+
+	std::cout << "Fn_foreach_parallel "<<total<<std::endl;
+
+    }
+}
@@ -0,0 +1,41 @@
+#include "../Fn_insert_batch.hpp"
+
+#include <iostream>
+#include <tdb/tdb_sqlite.hpp>
+#include <vector>
+
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	typedef tdb::Tag_sqlite Tag_xxx;
+	tdb::Connection_t<Tag_xxx> connection("/tmp/test.sqlite");
+
+	//--- Fn_insert_batch ---
+	//insert a range of rows with multi rows "INSERT ... VALUES (...),(...)" statements
+	std::vector<std::tuple<int,int,double,double>> rows;
+	for(int i = 0; i < 10000; ++i){rows.emplace_back(i,43,42.0,43.0);}
+
+	//multi thread
+    tdb::Fn_insert_batch<
+	Tag_xxx ,
+	  std::tuple<>,
+	  std::tuple<int,int,double,double>,
+      true
+	> fn_insert1(connection, "insert into test(i1,i2,d1,d2)");
+    [[maybe_unused]] size_t n1 = fn_insert1(rows);
+
+    //single thread, with a tail, at most 500 rows per statement
+    tdb::Fn_insert_batch<
+	Tag_xxx ,
+	  std::tuple<>,
+	  std::tuple<int,int,double,double>,
+      false
+	> fn_insert2(connection, "insert into test(i1,i2,d1,d2)", "on conflict do nothing", 500);
+    [[maybe_unused]] size_t n2 = fn_insert2(rows);
+    std::cout << fn_insert2.rows_per_statement() << " rows per statement" << std::endl;
+
+}
+}
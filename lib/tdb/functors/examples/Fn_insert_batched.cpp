@@ -0,0 +1,47 @@
+#include "../Fn_insert_batched.hpp"
+
+#include <iostream>
+#include <tdb/tdb_sqlite.hpp>
+
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	typedef tdb::Tag_sqlite Tag_xxx;
+	tdb::Connection_t<Tag_xxx> connection("/tmp/test.sqlite");
+
+	//--- Fn_insert_batched ---
+	//inserts are grouped in transactions, commited every 1000 rows or 500ms,
+	//on flush() and when the functor is destroyed
+
+	//multi thread
+    tdb::Fn_insert_batched<
+	Tag_xxx ,
+	  std::tuple<>,
+	  std::tuple<int,int,double,double>,
+      true
+	> fn_insert1(connection, tdb::Batch_policy{1000,std::chrono::milliseconds(500)}, "insert into test(i1,i2,d1,d2) values ($1,$2,$3,$4)");
+    for(int i = 0; i < 10000; ++i){
+    	[[maybe_unused]] tdb::Rowid<Tag_xxx> rowid1 = fn_insert1(i,43,42.0,43.0);
+    }
+    fn_insert1.flush();
+
+    //single thread, default policy
+    tdb::Fn_insert_batched<
+	Tag_xxx ,
+	  std::tuple<>,
+	  std::tuple<int,int,double,double>,
+      false
+	> fn_insert2(connection, tdb::Batch_policy(), "insert into test(i1,i2,d1,d2) values ($1,$2,$3,$4)");
+    [[maybe_unused]] tdb::Rowid<Tag_xxx> rowid2 = fn_insert2(42,43,42.0,43.0);
+    std::cout << fn_insert2.pending() << " rows not commited yet" << std::endl;
+
+    //a failed insert throws, the rows already inserted stay in the batch
+    try{fn_insert2(42,43,42.0,43.0);}catch(const tdb::Exception_base&){}
+    fn_insert2.flush();
+    std::cout << fn_insert2.lost() << " rows lost by the last failed commit" << std::endl;
+
+}
+}
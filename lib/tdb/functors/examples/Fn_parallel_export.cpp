@@ -0,0 +1,43 @@
+#include "../Fn_parallel_export.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <tdb/tdb_psql.hpp>
+
+#include <container/vector.hpp>
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	tdb::Connection_t<tdb::Tag_psql> connection("pierre","127.0.0.1","pierre","xxxxx");
+
+
+	//--- Fn_parallel_export (container) ---
+	//multi thread, 8 connections on the same snapshot
+    tdb::psql::Fn_parallel_export<
+	  std::tuple<int,double>,
+      true
+	> fn_export1(connection, tdb::psql::Export_policy{8}, "test", "i1", "select i1,d1 from test where i1 between $1 and $2 order by i1");
+
+    std::vector<std::tuple<int,double>> v1;
+    fn_export1(v1);                      //container, in i1 order
+    fn_export1(std::back_inserter(v1));  //output iterator
+
+
+	//--- Fn_parallel_export (callback) ---
+	//single thread, one connection per core, 64 partitions, 10000 rows per chunk
+    tdb::psql::Fn_parallel_export<
+	  std::tuple<int,std::string>,
+      false
+	> fn_export2(connection, tdb::psql::Export_policy{0,64,10000}, "test", "i1", "select i1,s1 from test where i1 between $1 and $2");
+
+    std::atomic<size_t> total = 0;
+    fn_export2([&](int, const std::string &s){total += s.size();});                       //void, called concurrently
+    [[maybe_unused]] bool b = fn_export2([&](int i, const std::string &)->bool{return i < 1000;}); //bool, stop on false
+
+	std::cout << "Fn_parallel_export " << v1.size() << " " << total << std::endl;
+}
+
+}
@@ -0,0 +1,43 @@
+#include "../Fn_parallel_scan.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <tdb/tdb_sqlite.hpp>
+
+#include <container/vector.hpp>
+
+//test code
+namespace{
+
+[[maybe_unused]] void example(){
+
+	tdb::Connection_t<tdb::Tag_sqlite> connection("/tmp/test.sqlite", tdb::sqlite::Options::oltp());
+
+
+	//--- Fn_parallel_scan (container) ---
+	//multi thread, 8 readers, partitions on rowid
+    tdb::sqlite::Fn_parallel_scan<
+	  std::tuple<int,double>,
+      true
+	> fn_scan1(connection, tdb::sqlite::Scan_policy{8}, "test", "rowid", "select i1,d1 from test where rowid between $1 and $2 order by rowid");
+
+    std::vector<std::tuple<int,double>> v1;
+    fn_scan1(v1);                      //container, in rowid order
+    fn_scan1(std::back_inserter(v1));  //output iterator
+
+
+	//--- Fn_parallel_scan (callback) ---
+	//single thread, one reader per core, 64 partitions
+    tdb::sqlite::Fn_parallel_scan<
+	  std::tuple<std::string_view>,
+      false
+	> fn_scan2(connection, tdb::sqlite::Scan_policy{0,64}, "test", "rowid", "select s1 from test where rowid between $1 and $2");
+
+    std::atomic<size_t> total = 0;
+    fn_scan2([&](std::string_view s){total += s.size();});                     //void, called concurrently
+    [[maybe_unused]] bool b = fn_scan2([&](std::string_view s)->bool{return !s.empty();}); //bool, stop on false
+
+	std::cout << "Fn_parallel_scan " << v1.size() << " " << total << std::endl;
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef LIB_TDB_FUNCTORS_IMPL_FN_CACHED_HPP_
+#define LIB_TDB_FUNCTORS_IMPL_FN_CACHED_HPP_
+
+//Engine of the cached functors : a functor Fn_type, and a Memo_cache keyed by its Bind_tt.
+//A hit returns a copy of the cached value, without touching the connection.
+//A miss calls fn (which locks the connection in its Multi_thread version), and caches the
+//value, unless the key was invalidated meanwhile. Two threads that miss the same key both
+//run the query. Exceptions are not cached.
+
+#include "../../helpers/Memo_cache.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace tdb::impl{
+
+	template<typename Fn_type, typename Value_t, bool Multi_thread>
+	struct Fn_cached{
+		typedef typename Fn_type::Bind_tt Bind_tt;
+		typedef Memo_cache<Bind_tt,Value_t,std::conditional_t<Multi_thread,std::mutex,Mutex_do_nothing> > Cache_t;
+		static_assert(!impl::has_borrowed<Bind_tt>,"A cached functor cannot bind borrowed types (std::string_view, std::span...), they are stored as cache keys");
+
+		template<typename Tag_t, typename... A>
+		Fn_cached(Connection_t<Tag_t>& db, const Memo_policy &policy, A&& ... a ):
+			fn(db,std::forward<A>(a)...),
+			cache(std::make_unique<Cache_t>(shards(policy)))
+		{}
+
+		template<typename... Bind_a>
+		Value_t get(const Bind_a&... bind_me){
+			const Bind_tt k(bind_me...);
+			uint64_t generation = 0;
+			if(std::optional<Value_t> r = cache->find(k,&generation)){return std::move(*r);}
+			Value_t v = fn(bind_me...);
+			cache->insert(k,v,&generation);
+			return v;
+		}
+
+		Fn_type fn;
+		std::unique_ptr<Cache_t> cache; //unique_ptr : the functor stays movable
+
+		private:
+		static Memo_policy shards(Memo_policy p){
+			if(!Multi_thread){p.nb_shards=1;}
+			return p;
+		}
+	};
+
+}//end namespace tdb::impl
+
+
+
+#endif /* LIB_TDB_FUNCTORS_IMPL_FN_CACHED_HPP_ */
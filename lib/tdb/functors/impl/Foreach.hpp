@@ -16,8 +16,9 @@ namespace tdb::impl{
 		template<typename Fn_t, typename Query_t, typename... Bind_a>
 		static bool foreach_bool(Query_t &q, Fn_t fn, const Bind_a&... bind_me){
 			auto result = tdb::get_result_a(q, bind_me...);
-			while( auto r = try_fetch(result) ){
-				bool b = std::apply(fn,r.value());
+			impl::result_row<decltype(result)> row; //reused for each row
+			while( fetch_into(result,row) ){
+				bool b = std::apply(fn,row);
 				if(!b){return false;}
 			}
 			return true;
@@ -26,8 +27,9 @@ namespace tdb::impl{
 		template<typename Fn_t, typename Query_t, typename... Bind_a>
 		static void foreach_void(Query_t &q, Fn_t fn, const Bind_a&... bind_me){
 			auto result = tdb::get_result_a(q, bind_me...);
-			while( auto r = try_fetch(result) ){
-				std::apply(fn,r.value());
+			impl::result_row<decltype(result)> row; //reused for each row
+			while( fetch_into(result,row) ){
+				std::apply(fn,row);
 			}
 		}
 	};
@@ -41,8 +43,9 @@ namespace tdb::impl{
 		static bool foreach_bool(Db_t &db, Query_t &q, Fn_t fn, const Bind_a&... bind_me){
 			auto l = impl::connection_lock_guard (db);
 			auto result = tdb::get_result_a(q, bind_me...);
-			while( auto r = try_fetch(result) ){
-				bool b = std::apply(fn,r.value());
+			impl::result_row<decltype(result)> row; //reused for each row
+			while( fetch_into(result,row) ){
+				bool b = std::apply(fn,row);
 				if(!b){return false;}
 			}
 			return true;
@@ -52,8 +55,9 @@ namespace tdb::impl{
 		static void foreach_void(Db_t &db, Query_t &q,  Fn_t fn, const Bind_a&... bind_me){
 			auto l = impl::connection_lock_guard (db);
 			auto result = tdb::get_result_a(q, bind_me...);
-			while( auto r = try_fetch(result) ){
-				std::apply(fn,r.value());
+			impl::result_row<decltype(result)> row; //reused for each row
+			while( fetch_into(result,row) ){
+				std::apply(fn,row);
 			}
 		}
 	};
@@ -0,0 +1,241 @@
+#ifndef LIB_TDB_FUNCTORS_IMPL_FOREACH_PARALLEL_HPP_
+#define LIB_TDB_FUNCTORS_IMPL_FOREACH_PARALLEL_HPP_
+
+//Engine of Fn_foreach_parallel.
+//The calling thread is the producer : it steps the result and moves the decoded rows
+//into a bounded Ring_buffer. nb_threads workers pop the rows and process them.
+//Stop (fn returned false, or an exception) : the producer stops fetching, the workers
+//discard the queued rows. The first exception is rethrown by run(), after the join.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../helpers/Ring_buffer.hpp"
+
+namespace tdb{
+
+	struct Parallel_policy{
+		size_t nb_threads = 0;    //workers, 0 : std::thread::hardware_concurrency()
+		size_t queue_size = 1024; //max rows decoded ahead of the workers
+	};
+
+}//end namespace tdb
+
+
+namespace tdb::impl{
+
+	template<typename Row_t>
+	struct Foreach_parallel{
+
+		struct Item{
+			size_t seq = 0; //row number
+			Row_t  row;
+		};
+
+		explicit Foreach_parallel(const Parallel_policy &policy):
+			rb(std::max<size_t>(policy.queue_size,1)),
+			nb_threads(policy.nb_threads!=0 ? policy.nb_threads : std::max(1u,std::thread::hardware_concurrency()))
+		{}
+
+		Foreach_parallel(const Foreach_parallel&)=delete;
+		Foreach_parallel& operator=(const Foreach_parallel&)=delete;
+
+		//produce(*this) runs in the calling thread, and calls push() for each row
+		//process(Item&) runs in the workers
+		template<typename Produce_t, typename Process_t>
+		void run(Produce_t &&produce, Process_t &&process){
+			std::vector<std::thread> workers;
+			workers.reserve(nb_threads);
+			try{
+				for(size_t i = 0; i < nb_threads; ++i){
+					workers.emplace_back([this,&process](){work(process);});
+				}
+				produce(*this);
+			}catch(...){
+				fail();
+			}
+			finish();
+			for(std::thread &t : workers){t.join();}
+			if(error){std::rethrow_exception(error);}
+		}
+
+		//blocks while the buffer is full. false : stopped, don't fetch more rows
+		bool push(Item &&item){
+			for(;;){
+				const uint32_t seen = rb.pop_count().load(std::memory_order_acquire);
+				if(is_stopped())                {return false;}
+				if(rb.try_push(std::move(item))){return true;}
+				rb.pop_count().wait(seen, std::memory_order_acquire);
+			}
+		}
+
+		bool is_stopped()const{return stopped.load(std::memory_order_relaxed);}
+		void stop()           {stopped.store(true, std::memory_order_relaxed);}
+
+		//store the current exception (the first one wins), and stop
+		void fail(){
+			{
+				std::lock_guard<std::mutex> l(error_mutex);
+				if(!error){error = std::current_exception();}
+			}
+			stop();
+		}
+
+		//ordered delivery : blocks until the items before seq are delivered
+		void wait_turn(size_t seq){
+			for(size_t n = next.load(std::memory_order_acquire); n!=seq; n = next.load(std::memory_order_acquire)){
+				next.wait(n, std::memory_order_acquire);
+			}
+		}
+		void end_turn(size_t seq){
+			next.store(seq+1, std::memory_order_release);
+			next.notify_all();
+		}
+
+		private:
+		Ring_buffer<Item>   rb;
+		const size_t        nb_threads;
+		std::atomic<bool>   done    = false; //no more push
+		std::atomic<bool>   stopped = false;
+		std::atomic<size_t> next    = 0;     //ordered delivery : next seq to deliver
+		std::mutex          error_mutex;
+		std::exception_ptr  error;
+
+		//wake up the workers waiting for a push
+		void finish(){
+			done.store(true, std::memory_order_release);
+			rb.push_count().fetch_add(1, std::memory_order_release);
+			rb.push_count().notify_all();
+		}
+
+		//pop until the producer is done and the buffer is empty
+		//process is called even when stopped (ordered delivery must see every seq)
+		template<typename Process_t>
+		void work(Process_t &process){
+			Item item;
+			for(;;){
+				const uint32_t seen = rb.push_count().load(std::memory_order_acquire);
+				if(rb.try_pop(item)){
+					call(process,item);
+					continue;
+				}
+				if(done.load(std::memory_order_acquire)){
+					if(rb.try_pop(item)){call(process,item); continue;} //pushed before done
+					return;
+				}
+				rb.push_count().wait(seen, std::memory_order_acquire);
+			}
+		}
+
+		template<typename Process_t>
+		void call(Process_t &process, Item &item){
+			try{process(item);}catch(...){fail();}
+		}
+	};
+
+
+
+	//--- producer : fetch all the rows of q, lock the connection if Multi_thread ---
+	//The lock is released (and the result destroyed) as soon as the last row is pushed,
+	//while the workers may still be processing the queued rows.
+	template<bool Multi_thread, typename Engine_t, typename Db_t, typename Query_t, typename... Bind_a>
+	void foreach_parallel_produce(Engine_t &e, Db_t &db, Query_t &q, const Bind_a&... bind_me){
+		auto fetch_all = [&](){
+			auto result = tdb::get_result_a(q, bind_me...);
+			typename Engine_t::Item item;
+			size_t seq = 0;
+			while( fetch_into(result,item.row) ){
+				item.seq = seq++;
+				if(!e.push(std::move(item))){return;}
+			}
+		};
+
+		if constexpr(Multi_thread){
+			auto l = impl::connection_lock_guard (db);
+			fetch_all();
+		}else{
+			fetch_all();
+		}
+	}
+
+
+	//--- unordered : fn(row...) in any order, concurrently ---
+	template<bool Multi_thread, typename Fn_t, typename Query_t, typename Db_t, typename... Bind_a>
+	bool foreach_parallel_unordered(Db_t &db, Query_t &q, const Parallel_policy &policy, Fn_t &fn, const Bind_a&... bind_me){
+		typedef impl::result_row<decltype(tdb::get_result_a(q, bind_me...))> row_t;
+		typedef Foreach_parallel<row_t> engine_t;
+		typedef decltype(std::apply(fn,std::declval<row_t>())) return_t;
+
+		engine_t e(policy);
+		std::atomic<bool> all = true; //false : fn returned false
+		e.run(
+			[&](engine_t &e_){foreach_parallel_produce<Multi_thread>(e_,db,q,bind_me...);},
+			[&](typename engine_t::Item &item){
+				if(e.is_stopped()){return;}
+				if constexpr(std::is_convertible<return_t,bool>::value){
+					if(!std::apply(fn,std::move(item.row))){
+						all.store(false, std::memory_order_relaxed);
+						e.stop();
+					}
+				}else{
+					std::apply(fn,std::move(item.row));
+				}
+			}
+		);
+		return all.load();
+	}
+
+
+	//--- ordered : map(row...) concurrently, then sink(map result) one at a time, in row order ---
+	template<bool Multi_thread, typename Map_t, typename Sink_t, typename Query_t, typename Db_t, typename... Bind_a>
+	bool foreach_parallel_ordered(Db_t &db, Query_t &q, const Parallel_policy &policy, Map_t &map, Sink_t &sink, const Bind_a&... bind_me){
+		typedef impl::result_row<decltype(tdb::get_result_a(q, bind_me...))> row_t;
+		typedef Foreach_parallel<row_t> engine_t;
+		typedef decltype(std::apply(map,std::declval<row_t>())) mapped_t;
+		static_assert(!std::is_void<mapped_t>::value,"Fn_foreach_parallel::ordered : map must return a value, that is passed to sink");
+		typedef decltype(sink(std::declval<mapped_t>())) return_t;
+
+		engine_t e(policy);
+		std::atomic<bool> all = true; //false : sink returned false
+		e.run(
+			[&](engine_t &e_){foreach_parallel_produce<Multi_thread>(e_,db,q,bind_me...);},
+			[&](typename engine_t::Item &item){
+				//every seq must end its turn, even when stopped, or the next ones wait forever
+				std::optional<mapped_t> mapped;
+				if(!e.is_stopped()){
+					try{mapped.emplace(std::apply(map,std::move(item.row)));}catch(...){e.fail();}
+				}
+				e.wait_turn(item.seq);
+				if(mapped and !e.is_stopped()){
+					try{
+						if constexpr(std::is_convertible<return_t,bool>::value){
+							if(!sink(std::move(*mapped))){
+								all.store(false, std::memory_order_relaxed);
+								e.stop();
+							}
+						}else{
+							sink(std::move(*mapped));
+						}
+					}catch(...){e.fail();}
+				}
+				e.end_turn(item.seq);
+			}
+		);
+		return all.load();
+	}
+
+}//end namespace tdb::impl
+
+
+
+
+#endif /* LIB_TDB_FUNCTORS_IMPL_FOREACH_PARALLEL_HPP_ */
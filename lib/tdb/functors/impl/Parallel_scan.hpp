@@ -0,0 +1,219 @@
+#ifndef LIB_TDB_FUNCTORS_IMPL_PARALLEL_SCAN_HPP_
+#define LIB_TDB_FUNCTORS_IMPL_PARALLEL_SCAN_HPP_
+
+//Engine of sqlite::Fn_parallel_scan and psql::Fn_parallel_export.
+//nb_threads reader connections, one query per reader, with the key bounds bound to $1 and $2.
+//Each call starts a read transaction on all the readers (Snapshot_t::begin, same view of the
+//database), splits [min(key),max(key)] in partitions, and the threads take the next partition
+//until none is left. The first exception stops the scan, and is rethrown once the threads are joined.
+//
+//Snapshot_t (one per driver) :
+//  typedef ... key_type;                                                                    //64 bits integer bound to $1 and $2
+//  static void begin(const std::vector<Connection_t<Tag_t>*> &readers, Connection_t<Tag_t> &source);
+//  static void end(Connection_t<Tag_t> &reader);                                            //ends the read transaction
+
+#include "is_iterator.hpp"
+#include <container/container.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tdb::impl{
+
+	//[first,second] inclusive
+	typedef std::pair<std::int64_t,std::int64_t> Key_range;
+
+	//split [lo,hi] in at most n non empty ranges
+	inline std::vector<Key_range> split_key_range(std::int64_t lo, std::int64_t hi, size_t n){
+		std::vector<Key_range> r;
+		if(hi<lo or n==0){return r;}
+		const std::uint64_t span = static_cast<std::uint64_t>(hi) - static_cast<std::uint64_t>(lo); //number of values - 1
+		if(span < n-1){n = static_cast<size_t>(span)+1;}
+		const std::uint64_t w   = span / n;
+		const std::uint64_t rem = span % n;
+		auto start = [&](std::uint64_t i){return static_cast<std::int64_t>(static_cast<std::uint64_t>(lo) + i*w + std::min(i,rem));};
+		r.reserve(n);
+		for(size_t i = 0; i < n; ++i){
+			const std::int64_t a = start(i);
+			const std::int64_t b = (i+1==n) ? hi : static_cast<std::int64_t>(static_cast<std::uint64_t>(start(i+1))-1);
+			r.emplace_back(a,b);
+		}
+		return r;
+	}
+
+	inline size_t scan_nb_threads(size_t n){return n!=0 ? n : std::max(1u,std::thread::hardware_concurrency());}
+
+
+	template<typename Tag_t, typename Return_tt, typename Snapshot_t>
+	struct Parallel_scanner{
+		typedef typename Snapshot_t::key_type                       key_t;
+		typedef std::tuple<key_t,key_t>                             Bind_tt;
+		typedef std::tuple<std::optional<key_t>,std::optional<key_t> > Bounds_tt;
+
+		//make_reader() returns a new std::unique_ptr<Connection_t<Tag_t> >
+		//bounds_sql returns min(key), max(key) (NULL if the table is empty)
+		template<typename Make_t, typename Sql_t>
+		Parallel_scanner(size_t nb_threads, size_t nb_partitions_, Make_t &&make_reader, const std::string &bounds_sql, const Sql_t &s):
+			nb_partitions(nb_partitions_!=0 ? nb_partitions_ : 8*nb_threads)
+		{
+			readers.reserve(nb_threads);
+			queries.reserve(nb_threads);
+			for(size_t i = 0; i < nb_threads; ++i){
+				readers.push_back(make_reader());
+				queries.push_back(prepare_new<Return_tt,Bind_tt>(*readers.back(),s));
+			}
+			bounds = prepare_new<Bounds_tt,std::tuple<> >(*readers[0],bounds_sql);
+		}
+
+		//starts the read transactions, and returns the partitions
+		//lock(source) : locks the mutex of source (or not), while the snapshot is taken
+		template<typename Lock_t>
+		std::vector<Key_range> begin(Connection_t<Tag_t> &source, Lock_t &&lock){
+			std::vector<Connection_t<Tag_t>*> r;
+			for(auto &c : readers){r.push_back(c.get());}
+			{
+				[[maybe_unused]] auto l = lock(source);
+				Snapshot_t::begin(r,source);
+			}
+			try{
+				Bounds_tt b;
+				tdb::get_unique(bounds,b);
+				if(!std::get<0>(b) or !std::get<1>(b)){return {};} //empty table
+				return split_key_range(*std::get<0>(b), *std::get<1>(b), nb_partitions);
+			}catch(...){
+				end_noexcept();
+				throw;
+			}
+		}
+
+		void end(){
+			for(auto &c : readers){Snapshot_t::end(*c);}
+		}
+
+		//scan(row,partition_index) is called by the threads, for each row. false : stop
+		template<typename Scan_t, typename Lock_t>
+		void run(Connection_t<Tag_t> &source, Lock_t &&lock, Scan_t &&scan, std::vector<Key_range> *ranges_out=nullptr){
+			const std::vector<Key_range> ranges = begin(source,lock);
+			if(ranges_out){*ranges_out = ranges;}
+
+			std::atomic<size_t> next    = 0;
+			std::atomic<bool>   stopped = false;
+			std::mutex          error_mutex;
+			std::exception_ptr  error;
+
+			auto work = [&](size_t t){
+				try{
+					row_t row;
+					for(size_t p = next.fetch_add(1); p < ranges.size() and !stopped.load(std::memory_order_relaxed); p = next.fetch_add(1)){
+						auto result = tdb::get_result_a(queries[t], static_cast<key_t>(ranges[p].first), static_cast<key_t>(ranges[p].second));
+						while(fetch_into(result,row)){
+							if(!scan(row,p)){stopped=true; break;}
+						}
+					}
+				}catch(...){
+					std::lock_guard<std::mutex> l(error_mutex);
+					if(!error){error = std::current_exception();}
+					stopped=true;
+				}
+			};
+
+			std::vector<std::thread> threads;
+			try{
+				for(size_t t = 1; t < queries.size(); ++t){threads.emplace_back(work,t);}
+			}catch(...){
+				stopped=true;
+				for(std::thread &th : threads){th.join();}
+				end_noexcept();
+				throw;
+			}
+			work(0); //the calling thread is a worker too
+			for(std::thread &th : threads){th.join();}
+
+			if(error){
+				end_noexcept();
+				std::rethrow_exception(error);
+			}
+			end();
+		}
+
+		size_t nb_partitions;
+		std::vector<std::unique_ptr<Connection_t<Tag_t> > > readers;
+		std::vector<Query<Tag_t,Return_tt,Bind_tt> >        queries; //queries[i] : on readers[i]
+		Query<Tag_t,Bounds_tt,std::tuple<> >                bounds;  //on readers[0]
+		std::mutex call_mutex; //multi thread version : one call at a time
+
+		private:
+		typedef impl::result_row<Result<Tag_t,Return_tt> > row_t;
+
+		void end_noexcept(){
+			for(auto &c : readers){try{Snapshot_t::end(*c);}catch(...){}}
+		}
+	};
+
+
+	//rows merged in the partition order
+	template<typename Return_tt, typename Scanner_t, typename Source_t, typename Lock_t, typename Write_here_tt>
+	void parallel_scan_table(Source_t &source, Scanner_t &s, Lock_t &&lock, Write_here_tt &write_here){
+		static_assert(!impl::has_borrowed<Return_tt>,"A parallel scan cannot store borrowed types (std::string_view, std::span...), they are invalidated by the next fetch");
+
+		std::vector<Key_range> ranges;
+		std::vector<std::vector<Return_tt> > parts(s.nb_partitions);
+		s.run(source, lock, [&](Return_tt &row, size_t p){parts[p].push_back(std::move(row)); return true;}, &ranges);
+
+		for(size_t p = 0; p < ranges.size(); ++p){
+			for(Return_tt &row : parts[p]){
+				if constexpr(impl::is_iterator<Write_here_tt>){
+					static_assert(impl::is_iterator_of_type<Write_here_tt,std::output_iterator_tag>,"Wrong iterator type in a parallel scan, an output iterator is required.");
+					(*write_here)=std::move(row);
+				}else{
+					static_assert(container::Add_anywhere_t<Write_here_tt>::is_implemented,"Missing implementation of container::Add_anywhere_t (did you forget to include container/xxx.hpp?)");
+					container::add_anywhere(write_here,std::move(row));
+				}
+			}
+			std::vector<Return_tt>().swap(parts[p]); //free as soon as merged
+		}
+	}
+
+	//fn(row...) called concurrently by the threads
+	template<typename Return_tt, typename Scanner_t, typename Source_t, typename Lock_t, typename Fn_t>
+	auto parallel_scan_foreach(Source_t &source, Scanner_t &s, Lock_t &&lock, Fn_t &fn){
+		typedef decltype(std::apply(fn,std::declval<Return_tt&>())) return_t;
+		static constexpr bool is_bool = std::is_convertible<return_t,bool>::value;
+
+		std::atomic<bool> all = true;
+		s.run(source, lock, [&](Return_tt &row, size_t){
+			if constexpr(is_bool){
+				if(!std::apply(fn,row)){all=false; return false;}
+			}else{
+				std::apply(fn,row);
+			}
+			return true;
+		});
+		if constexpr(is_bool){return all.load();}
+	}
+
+	struct Scan_no_lock{
+		template<typename Db_t> int operator()(Db_t&)const{return 0;}
+	};
+
+	struct Scan_connection_lock{
+		template<typename Db_t> auto operator()(Db_t &db)const{return impl::connection_lock_guard(db);}
+	};
+
+}//end namespace tdb::impl
+
+
+
+
+#endif /* LIB_TDB_FUNCTORS_IMPL_PARALLEL_SCAN_HPP_ */
@@ -0,0 +1,262 @@
+#ifndef LIB_TDB_HELPERS_MEMO_CACHE_HPP_
+#define LIB_TDB_HELPERS_MEMO_CACHE_HPP_
+
+//Bounded LRU cache of values, with an optional time to live, split in shards.
+//Used by the cached functors (Fn_get_value_unique_cached, Fn_get_row_optional_cached) :
+//key = the bound values, value = the result of the query.
+//
+//Each shard has its own mutex (Mutex_t), LRU list and index : threads that look up keys of
+//different shards don't wait for each other. The key hash picks the shard.
+//Mutex_t = Mutex_do_nothing : NOT thread safe.
+//
+//Memo_hash_t<T> (optional) : hash of a key element, default std::hash<T>.
+//It is implemented for std::tuple, std::vector and std::optional.
+
+#include "Mutex_do_nothing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tdb{
+
+	struct Memo_policy{
+		size_t                    capacity  = 1024; //cached values, split between the shards
+		std::chrono::milliseconds ttl       = std::chrono::milliseconds(0); //0 : no expiry
+		size_t                    nb_shards = 16;   //multi thread version only, at least 1
+	};
+
+	struct Memo_stats{
+		size_t hit      = 0; //found in the cache
+		size_t miss     = 0; //not found (or expired) : the query was run
+		size_t eviction = 0; //the least recently used value was dropped to make room
+		size_t expired  = 0; //found, but older than ttl
+
+		double hit_rate()const{return hit+miss==0 ? 0.0 : static_cast<double>(hit)/static_cast<double>(hit+miss);}
+	};
+
+
+	//--- Memo_hash_t ---
+	template<typename T>
+	struct Memo_hash_t{
+		size_t operator()(const T &x)const{return std::hash<T>()(x);}
+	};
+
+	namespace impl{
+		inline size_t memo_hash_combine(size_t h1, size_t h2){
+			return h1 ^ (h2 + 0x9e3779b97f4a7c15ull + (h1<<6) + (h1>>2));
+		}
+	}
+
+	template<typename... T>
+	struct Memo_hash_t<std::tuple<T...> >{
+		size_t operator()(const std::tuple<T...> &x)const{
+			return std::apply([](const T&... e){
+				size_t h = 0;
+				((h = impl::memo_hash_combine(h, Memo_hash_t<T>()(e))), ...);
+				return h;
+			}, x);
+		}
+	};
+
+	template<typename T, typename Alloc_t>
+	struct Memo_hash_t<std::vector<T,Alloc_t> >{
+		size_t operator()(const std::vector<T,Alloc_t> &x)const{
+			size_t h = x.size();
+			for(const T &e : x){h = impl::memo_hash_combine(h, Memo_hash_t<T>()(e));}
+			return h;
+		}
+	};
+
+	template<typename T>
+	struct Memo_hash_t<std::optional<T> >{
+		size_t operator()(const std::optional<T> &x)const{return x ? impl::memo_hash_combine(1, Memo_hash_t<T>()(*x)) : 0;}
+	};
+
+
+
+	template<typename Key_t, typename Value_t, typename Mutex_t>
+	struct Memo_cache{
+		typedef std::chrono::steady_clock clock;
+
+		explicit Memo_cache(const Memo_policy &policy):
+			ttl(policy.ttl),
+			shards(std::max<size_t>(1,policy.nb_shards))
+		{
+			const size_t n   = shards.size();
+			const size_t per = (policy.capacity+n-1)/n; //0 : nothing is cached
+			for(Shard &s : shards){s.capacity = per;}
+		}
+
+		//NOT copiable, NOT movable (holds mutexes)
+		Memo_cache(Memo_cache&&)                =delete;
+		Memo_cache& operator=(Memo_cache&&)     =delete;
+		Memo_cache(const Memo_cache&)           =delete;
+		Memo_cache& operator=(const Memo_cache&)=delete;
+
+		//copy of the cached value, or empty if missing or expired
+		//generation : set to the generation of the shard of k, see insert
+		std::optional<Value_t> find(const Key_t &k, uint64_t *generation=nullptr){
+			Shard &s = shard(k);
+			std::lock_guard<Mutex_t> l(s.mutex);
+			if(generation){*generation = s.generation;}
+			auto found = s.index.find(k);
+			if(found==s.index.end()){++s.stats.miss; return std::nullopt;}
+
+			if(ttl.count()!=0 and clock::now() >= found->second->expires){
+				s.entries.erase(found->second);
+				s.index.erase(found);
+				++s.stats.expired;
+				++s.stats.miss;
+				return std::nullopt;
+			}
+
+			++s.stats.hit;
+			s.entries.splice(s.entries.begin(),s.entries,found->second); //most recently used first
+			return found->second->value;
+		}
+
+		//store (or replace) the value of k
+		//generation (from find) : ignored if the shard was invalidated since find, as v may be stale
+		void insert(const Key_t &k, const Value_t &v, const uint64_t *generation=nullptr){
+			Shard &s = shard(k);
+			const clock::time_point expires = ttl.count()!=0 ? clock::now()+ttl : clock::time_point();
+			std::lock_guard<Mutex_t> l(s.mutex);
+			if(s.capacity==0)                                 {return;}
+			if(generation!=nullptr and *generation!=s.generation){return;}
+
+			auto found = s.index.find(k);
+			if(found!=s.index.end()){
+				found->second->value   = v;
+				found->second->expires = expires;
+				s.entries.splice(s.entries.begin(),s.entries,found->second);
+				return;
+			}
+
+			s.entries.push_front(Entry{k,v,expires});
+			try{
+				s.index.emplace(k,s.entries.begin());
+			}catch(...){
+				s.entries.pop_front();
+				throw;
+			}
+			while(s.entries.size()>s.capacity){
+				s.index.erase(s.entries.back().key);
+				s.entries.pop_back();
+				++s.stats.eviction;
+			}
+		}
+
+		//true if k was cached
+		bool erase(const Key_t &k){
+			Shard &s = shard(k);
+			std::lock_guard<Mutex_t> l(s.mutex);
+			++s.generation;
+			auto found = s.index.find(k);
+			if(found==s.index.end()){return false;}
+			s.entries.erase(found->second);
+			s.index.erase(found);
+			return true;
+		}
+
+		//erase the values where pred(key,value) is true, returns how many
+		template<typename Pred_t>
+		size_t erase_if(Pred_t &&pred){
+			size_t r = 0;
+			for(Shard &s : shards){
+				std::lock_guard<Mutex_t> l(s.mutex);
+				++s.generation;
+				for(auto it = s.entries.begin(); it!=s.entries.end();){
+					if(pred(std::as_const(it->key),std::as_const(it->value))){
+						s.index.erase(it->key);
+						it = s.entries.erase(it);
+						++r;
+					}else{
+						++it;
+					}
+				}
+			}
+			return r;
+		}
+
+		//drop all the values (not counted as evictions)
+		void clear(){
+			for(Shard &s : shards){
+				std::lock_guard<Mutex_t> l(s.mutex);
+				++s.generation;
+				s.index.clear();
+				s.entries.clear();
+			}
+		}
+
+		size_t size(){
+			size_t r = 0;
+			for(Shard &s : shards){std::lock_guard<Mutex_t> l(s.mutex); r+=s.entries.size();}
+			return r;
+		}
+
+		//sum of the shards
+		Memo_stats stats(){
+			Memo_stats r;
+			for(Shard &s : shards){
+				std::lock_guard<Mutex_t> l(s.mutex);
+				r.hit      += s.stats.hit;
+				r.miss     += s.stats.miss;
+				r.eviction += s.stats.eviction;
+				r.expired  += s.stats.expired;
+			}
+			return r;
+		}
+
+		void reset_stats(){
+			for(Shard &s : shards){std::lock_guard<Mutex_t> l(s.mutex); s.stats=Memo_stats();}
+		}
+
+
+		private:
+
+		struct Entry{
+			Key_t             key;
+			Value_t           value;
+			clock::time_point expires; //unused when ttl is 0
+		};
+
+		struct Key_hash{
+			size_t operator()(const Key_t &k)const{return Memo_hash_t<Key_t>()(k);}
+		};
+
+		//one cache line each, avoids false sharing between the shard mutexes
+		struct alignas(64) Shard{
+			Mutex_t    mutex;
+			size_t     capacity   = 0;
+			uint64_t   generation = 0; //incremented by each invalidation
+			Memo_stats stats;
+			std::list<Entry> entries; //most recently used first
+			std::unordered_map<Key_t, typename std::list<Entry>::iterator, Key_hash> index;
+		};
+
+		Shard & shard(const Key_t &k){
+			if(shards.size()==1){return shards[0];}
+			const size_t h = Key_hash()(k);
+			return shards[impl::memo_hash_combine(h,0) % shards.size()]; //rehash : the index uses the low bits of h too
+		}
+
+		const std::chrono::milliseconds ttl;
+		std::vector<Shard> shards;
+	};
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_HELPERS_MEMO_CACHE_HPP_ */
@@ -0,0 +1,159 @@
+#ifndef LIB_TDB_HELPERS_QUERY_CACHE_HPP_
+#define LIB_TDB_HELPERS_QUERY_CACHE_HPP_
+
+//Bounded LRU cache of prepared queries, owned by a connection.
+//The convenience functions that take a connection and some sql (execute,
+//execute_a, insert, insert_a, Transaction_t) reuse the cached
+//Query_t instead of preparing (and destroying) a new one at each call.
+//
+//key   : the sql string + the Query_t type (i.e. Tag_t, Return_tt, Bind_tt)
+//value : the prepared Query_t (type erased)
+//
+//NOT thread safe : use it under the connection mutex, as any other query.
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tdb{
+
+	struct Query_cache_stats{
+		size_t hit      = 0; //the query was found in the cache
+		size_t miss     = 0; //the query was prepared, then stored in the cache
+		size_t eviction = 0; //the least recently used query was destroyed to make room
+	};
+
+
+	struct Query_cache{
+		static constexpr size_t default_capacity = 64;
+
+		explicit Query_cache(size_t capacity_=default_capacity):capacity_value(capacity_){}
+
+		//NOT copiable, NOT movable (cached queries refer to the connection)
+		Query_cache(Query_cache&&)                =delete;
+		Query_cache& operator=(Query_cache&&)     =delete;
+		Query_cache(const Query_cache&)           =delete;
+		Query_cache& operator=(const Query_cache&)=delete;
+
+		struct Holder_base{
+			virtual ~Holder_base(){}
+		};
+
+		//queries dropped by get(sql,make,evicted) or erase, destroyed by the caller
+		//(ex : psql queries lock the connection mutex to DEALLOCATE, destroy them once it is unlocked)
+		typedef std::vector<std::unique_ptr<Holder_base> > Evicted;
+
+		//get the cached query, or store make() in the cache.
+		//make() must return a Query_type (it is called on a miss only)
+		//require capacity()>0
+		template<typename Query_type, typename Make_t>
+		Query_type & get(const std::string &sql, Make_t &&make){
+			Evicted evicted;
+			return get<Query_type>(sql,make,evicted);
+		}
+
+		//same, the evicted queries are moved to evicted instead of being destroyed
+		template<typename Query_type, typename Make_t>
+		Query_type & get(const std::string &sql, Make_t &&make, Evicted &evicted){
+			assert(capacity_value!=0);
+
+			Key k(std::type_index(typeid(Query_type)), sql);
+			auto found = index.find(k);
+			if(found!=index.end()){
+				++stats_value.hit;
+				entries.splice(entries.begin(),entries,found->second); //most recently used first
+				return static_cast<Holder<Query_type>&>(*found->second->holder).query;
+			}
+
+			++stats_value.miss;
+			std::unique_ptr<Holder_base> h = std::make_unique<Holder<Query_type>>(make()); //may throw, nothing is stored
+			entries.push_front(Entry{k,std::move(h)});
+			try{
+				index.emplace(std::move(k),entries.begin());
+			}catch(...){
+				entries.pop_front();
+				throw;
+			}
+
+			Query_type &r = static_cast<Holder<Query_type>&>(*entries.front().holder).query;
+			evict_to(capacity_value,evicted);
+			return r;
+		}
+
+		//drop the cached query, if any (ex : its state is unknown after an exception). Not counted as an eviction.
+		template<typename Query_type>
+		void erase(const std::string &sql, Evicted &evicted){
+			auto found = index.find(Key(std::type_index(typeid(Query_type)), sql));
+			if(found==index.end()){return;}
+			evicted.reserve(evicted.size()+1);
+			evicted.push_back(std::move(found->second->holder));
+			entries.erase(found->second);
+			index.erase(found);
+		}
+
+		//capacity : max number of cached queries, 0 disable the cache
+		size_t capacity()const{return capacity_value;}
+		void   set_capacity(size_t c){capacity_value=c; Evicted e; evict_to(c,e);}
+
+		size_t size()const{return entries.size();}
+
+		//destroy all the cached queries (not counted as evictions)
+		void clear(){
+			index.clear();
+			entries.clear();
+		}
+
+		const Query_cache_stats & stats()const{return stats_value;}
+		void reset_stats(){stats_value=Query_cache_stats();}
+
+
+		private:
+
+		template<typename Query_type>
+		struct Holder:Holder_base{
+			explicit Holder(Query_type &&q):query(std::move(q)){}
+			Query_type query;
+		};
+
+		typedef std::pair<std::type_index,std::string> Key;
+
+		struct Key_hash{
+			size_t operator()(const Key &k)const{
+				const size_t h1 = std::hash<std::type_index>()(k.first);
+				const size_t h2 = std::hash<std::string>()(k.second);
+				return h1 ^ (h2 + 0x9e3779b97f4a7c15ull + (h1<<6) + (h1>>2));
+			}
+		};
+
+		struct Entry{
+			Key key;
+			std::unique_ptr<Holder_base> holder;
+		};
+
+		void evict_to(size_t n, Evicted &evicted){
+			while(entries.size()>n){
+				evicted.push_back(std::move(entries.back().holder)); //may throw : nothing is dropped
+				index.erase(entries.back().key);
+				entries.pop_back();
+				++stats_value.eviction;
+			}
+		}
+
+		size_t capacity_value;
+		Query_cache_stats stats_value;
+		std::list<Entry> entries; //most recently used first
+		std::unordered_map<Key, std::list<Entry>::iterator, Key_hash> index;
+	};
+
+}
+
+
+
+#endif /* LIB_TDB_HELPERS_QUERY_CACHE_HPP_ */
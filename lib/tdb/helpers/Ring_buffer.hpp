@@ -0,0 +1,116 @@
+#ifndef LIB_TDB_HELPERS_RING_BUFFER_HPP_
+#define LIB_TDB_HELPERS_RING_BUFFER_HPP_
+
+//Bounded lock free multi producers / multi consumers queue (D. Vyukov's algorithm).
+//Each slot holds a sequence number, that tells if it is free for the push (or the pop)
+//of a given position : push and pop only do one compare_exchange on their position counter.
+//
+//tdb::Ring_buffer<std::string> rb(1024);  //capacity is rounded up to a power of 2
+//rb.try_push("hello");                    //false if full
+//std::string s;
+//rb.try_pop(s);                           //false if empty
+//
+//try_push and try_pop never block. To wait, use the counters :
+//  auto seen = rb.pop_count().load();
+//  while(!rb.try_push(x)){rb.pop_count().wait(seen); seen = rb.pop_count().load();}
+//pop_count() (resp. push_count()) is incremented and notified after each pop (resp. push).
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace tdb{
+
+	template<typename T>
+	struct Ring_buffer{
+
+		//capacity>0
+		explicit Ring_buffer(size_t capacity_):
+			mask(std::bit_ceil(capacity_ < 2 ? size_t(2) : capacity_)-1),
+			slots(new Slot[mask+1])
+		{
+			for(size_t i = 0; i <= mask; ++i){slots[i].sequence.store(i,std::memory_order_relaxed);}
+		}
+
+		//NOT copiable, NOT movable (shared by threads)
+		Ring_buffer(Ring_buffer&&)                =delete;
+		Ring_buffer& operator=(Ring_buffer&&)     =delete;
+		Ring_buffer(const Ring_buffer&)           =delete;
+		Ring_buffer& operator=(const Ring_buffer&)=delete;
+
+		size_t capacity()const{return mask+1;}
+
+		//false if the buffer is full (x is NOT moved from)
+		template<typename U>
+		bool try_push(U &&x){
+			size_t pos = push_pos.load(std::memory_order_relaxed);
+			for(;;){
+				Slot &s = slots[pos & mask];
+				const size_t seq = s.sequence.load(std::memory_order_acquire);
+				const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+				if(diff==0){
+					if(push_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)){
+						s.value = std::forward<U>(x);
+						s.sequence.store(pos+1, std::memory_order_release);
+						nb_push.fetch_add(1, std::memory_order_release);
+						nb_push.notify_all();
+						return true;
+					}
+				}else if(diff<0){
+					return false; //full
+				}else{
+					pos = push_pos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		//false if the buffer is empty
+		bool try_pop(T &x){
+			size_t pos = pop_pos.load(std::memory_order_relaxed);
+			for(;;){
+				Slot &s = slots[pos & mask];
+				const size_t seq = s.sequence.load(std::memory_order_acquire);
+				const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos+1);
+				if(diff==0){
+					if(pop_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)){
+						x = std::move(s.value);
+						s.sequence.store(pos+mask+1, std::memory_order_release);
+						nb_pop.fetch_add(1, std::memory_order_release);
+						nb_pop.notify_all();
+						return true;
+					}
+				}else if(diff<0){
+					return false; //empty
+				}else{
+					pos = pop_pos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		//wait on these to block until a push (resp. a pop) happens, see above
+		std::atomic<uint32_t> & push_count(){return nb_push;}
+		std::atomic<uint32_t> & pop_count() {return nb_pop;}
+
+		private:
+		static constexpr size_t line = 64; //cache line, avoids false sharing between the counters
+
+		struct Slot{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		const size_t mask;
+		std::unique_ptr<Slot[]> slots;
+
+		alignas(line) std::atomic<size_t>   push_pos = 0;
+		alignas(line) std::atomic<size_t>   pop_pos  = 0;
+		alignas(line) std::atomic<uint32_t> nb_push  = 0;
+		alignas(line) std::atomic<uint32_t> nb_pop   = 0;
+	};
+
+}//end namespace tdb
+
+#endif /* LIB_TDB_HELPERS_RING_BUFFER_HPP_ */
@@ -5,17 +5,26 @@
 //Xxxx_t is a template interface (generally for user specialisation)
 //Xxxx   is stuff that should be called to use the database
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <sstream>
 
 #include <filesystem>
 #include <fstream>
 
 #include "helpers/tuple_ref.hpp"
+#include "helpers/Query_cache.hpp"
 
 namespace tdb{
 
@@ -141,6 +150,281 @@ namespace tdb{
 	}
 
 
+
+	//================
+	//=== observer ===
+	//================
+	//Observe the queries run on a connection : prepare, bind, execute, first row, finish.
+	//Compiled in only when TDB_OBSERVER is defined (-DTDB_OBSERVER, for ALL the translation units).
+	//Otherwise the probes are empty, the hooks are not compiled, and set_observer does not compile.
+	//
+	//struct Slow_queries:tdb::Observer_t<Tag_sqlite>{
+	//  void on_finish(const tdb::Query_event_t<Tag_sqlite> &e)noexcept override{
+	//    if(e.elapsed() > std::chrono::milliseconds(100)){std::clog << e.sql << " : "<< e.nb_rows << " rows\n";}
+	//  }
+	//};
+	//Slow_queries o;
+	//tdb::set_observer(connection,&o); //nullptr to stop
+	//
+	//Observed : prepare_new, prepare_here, bind, bind_a, execute, insert, get_result, try_fetch, fetch_into
+	//and everything built on them (functors, cached queries, transactions...). Multi rows inserts and
+	//scripts (read_xxx) are not observed.
+
+#ifdef TDB_OBSERVER
+	constexpr bool has_observer = true;
+#else
+	constexpr bool has_observer = false;
+#endif
+
+	enum class Query_event_kind{prepare, bind, execute, first_row, finish};
+
+	template<typename Tag_t>
+	struct Query_event_t{
+		typedef std::chrono::steady_clock clock;
+
+		Query_event_kind  kind;
+		clock::time_point start;    //prepare : before prepare. Other events : first bind or execute of this statement
+		clock::time_point time;     //of this event
+		std::string_view  sql;      //sql_debug, valid during the call
+		size_t            nb_rows  = 0;     //fetched so far (first_row, finish)
+		size_t            nb_bytes = 0;     //decoded so far, estimated from the C++ values (first_row, finish)
+		bool              failed   = false; //finish : an exception was thrown
+
+		clock::duration elapsed()const{return time-start;}
+	};
+
+	//called by the thread that runs the query (under the connection mutex with Multi_thread functors)
+	//callbacks are noexcept : finish may be called by a destructor
+	template<typename Tag_t>
+	struct Observer_t{
+		virtual ~Observer_t()=default;
+		virtual void on_prepare  (const Query_event_t<Tag_t> &)noexcept{}
+		virtual void on_bind     (const Query_event_t<Tag_t> &)noexcept{}
+		virtual void on_execute  (const Query_event_t<Tag_t> &)noexcept{}
+		virtual void on_first_row(const Query_event_t<Tag_t> &)noexcept{}
+		virtual void on_finish   (const Query_event_t<Tag_t> &)noexcept{}
+	};
+
+
+	namespace impl{
+		//--- stored by Connection_t ---
+		template<typename Tag_t, bool enabled=has_observer>
+		struct Observer_slot{};
+
+		template<typename Tag_t>
+		struct Observer_slot<Tag_t,true>{
+			Observer_t<Tag_t> *observer = nullptr; //NOT owned
+		};
+	}
+
+	//Get_observer_t (optional)
+	//return the impl::Observer_slot<Tag_t> owned by the connection, declare it as
+	//  [[no_unique_address]] impl::Observer_slot<Tag_xxx> observer;
+	//and add the probes to Query_t and Result_t (see below)
+	//default : not implemented, the queries are not observed
+	template<typename Tag_t>
+	struct Get_observer_t{
+		static constexpr bool is_implemented = false;
+	};
+
+	//set before running queries on c, or while c is locked
+	template<typename Tag_t>
+	void set_observer(Connection_t<Tag_t> &c, std::type_identity_t<Observer_t<Tag_t> > *o){
+		static_assert(has_observer and Connection_t<Tag_t>::is_implemented,"set_observer requires TDB_OBSERVER");
+		static_assert(Get_observer_t<Tag_t>::is_implemented,"You need to implement Get_observer_t<Tag_t>");
+		Get_observer_t<Tag_t>::run(c).observer = o;
+	}
+
+	template<typename Tag_t>
+	Observer_t<Tag_t>* get_observer(Connection_t<Tag_t> &c){
+		if constexpr(has_observer and Get_observer_t<Tag_t>::is_implemented){return Get_observer_t<Tag_t>::run(c).observer;}
+		else{return nullptr;}
+	}
+
+
+	//--- probes (implementation helpers, don't touch) ---
+	//Query_t and Result_t observed by a driver declare
+	//  [[no_unique_address]] impl::Query_probe <Tag_xxx> probe; //in Query_t
+	//  [[no_unique_address]] impl::Result_probe<Tag_xxx> probe; //in Result_t
+	//and move (or swap) it with the rest of the object. Both are empty without TDB_OBSERVER.
+	namespace impl{
+
+		//size of a decoded value, in bytes (estimate)
+		template<typename T>
+		size_t decoded_size(const T &t){
+			if constexpr(std::is_arithmetic_v<T>){return sizeof(T);}
+			else if constexpr(std::is_empty_v<T>){return 0;} //tdb::Null
+			else if constexpr(requires{t.has_value(); *t;}){return t.has_value() ? decoded_size(*t) : 0;}
+			else if constexpr(requires{std::size(t); std::data(t);}){return std::size(t)*sizeof(*std::data(t));}
+			else if constexpr(requires{std::tuple_size<T>::value;}){
+				return std::apply([](const auto&... a){return (size_t(0) + ... + decoded_size(a));},t);
+			}
+			else{return sizeof(T);}
+		}
+
+
+		template<typename Tag_t, bool enabled=has_observer>
+		struct Query_probe{};
+
+		template<typename Tag_t, bool enabled=has_observer>
+		struct Result_probe{};
+
+
+		template<typename Tag_t>
+		struct Query_probe<Tag_t,true>{
+			typedef std::chrono::steady_clock clock;
+
+			Observer_t<Tag_t>* observer()const{return slot ? slot->observer : nullptr;}
+
+			void prepared(Connection_t<Tag_t> &c, const SqlData_t<Tag_t> &s, clock::time_point prepare_start){
+				if constexpr(Get_observer_t<Tag_t>::is_implemented){slot = &Get_observer_t<Tag_t>::run(c);}
+				sql   = sql_debug(s);
+				start.reset();
+				if(auto o = observer()){o->on_prepare(event(Query_event_kind::prepare, prepare_start));}
+			}
+
+			void bind_begin(){
+				start = clock::now();
+			}
+
+			void bound(){
+				if(auto o = observer()){o->on_bind(event(Query_event_kind::bind, start.value()));}
+			}
+
+			void execute(){
+				if(!start){start = clock::now();}
+				if(auto o = observer()){o->on_execute(event(Query_event_kind::execute, start.value()));}
+			}
+
+			void finish(bool failed){
+				if(auto o = observer()){
+					Query_event_t<Tag_t> e = event(Query_event_kind::finish, start.value_or(clock::now()));
+					e.failed = failed;
+					o->on_finish(e);
+				}
+				start.reset();
+			}
+
+			Query_event_t<Tag_t> event(Query_event_kind k, clock::time_point t0)const{
+				return Query_event_t<Tag_t>{k, t0, clock::now(), sql};
+			}
+
+			Observer_slot<Tag_t>            *slot = nullptr; //NOT owned, in the connection
+			std::string                      sql;
+			std::optional<clock::time_point> start; //of the statement in progress
+		};
+
+
+		template<typename Tag_t>
+		struct Result_probe<Tag_t,true>{
+			typedef std::chrono::steady_clock clock;
+
+			Result_probe(){}
+
+			//movable, NOT copiable
+			Result_probe(Result_probe &&a)noexcept(true){take(a);}
+			Result_probe& operator=(Result_probe &&a)noexcept(true){
+				if(this!=&a){finish(false); take(a);}
+				return *this;
+			}
+			Result_probe(const Result_probe&)=delete;
+			Result_probe& operator=(const Result_probe&)=delete;
+
+			~Result_probe(){finish(false);}
+
+			//the statement of q continues in this result
+			void start(Query_probe<Tag_t,true> &q){
+				finish(false);
+				observer   = q.observer();
+				sql        = q.sql;
+				start_time = q.start.value_or(clock::now());
+				nb_rows = 0;
+				nb_bytes = 0;
+				q.start.reset();
+			}
+
+			void row(size_t bytes){
+				++nb_rows;
+				nb_bytes += bytes;
+				if(nb_rows==1 and observer){observer->on_first_row(event(Query_event_kind::first_row));}
+			}
+
+			//once : the next calls do nothing
+			void finish(bool failed){
+				if(observer==nullptr){return;}
+				Query_event_t<Tag_t> e = event(Query_event_kind::finish);
+				e.failed = failed;
+				std::exchange(observer,nullptr)->on_finish(e);
+			}
+
+			Query_event_t<Tag_t> event(Query_event_kind k)const{
+				return Query_event_t<Tag_t>{k, start_time, clock::now(), sql, nb_rows, nb_bytes};
+			}
+
+			Observer_t<Tag_t> *observer = nullptr; //nullptr : not observed, or finished
+			std::string_view   sql;                //in the Query_probe
+			clock::time_point  start_time;
+			size_t nb_rows  = 0;
+			size_t nb_bytes = 0;
+
+			private:
+			void take(Result_probe &a){
+				observer   = std::exchange(a.observer,nullptr);
+				sql        = a.sql;
+				start_time = a.start_time;
+				nb_rows    = a.nb_rows;
+				nb_bytes   = a.nb_bytes;
+			}
+		};
+
+
+		//true if T (a Query_t or a Result_t) has a probe, and TDB_OBSERVER is defined
+		template<typename T>
+		concept is_observed = has_observer and requires(T &t){t.probe;};
+
+
+		//execute, from construction to destruction (finish, failed if an exception is thrown)
+		//or until hand_over(result) : the result finishes the statement
+		template<typename Query_type, bool enabled=is_observed<Query_type> >
+		struct Execute_probe_guard{
+			explicit Execute_probe_guard(Query_type &){}
+			template<typename Result_type> void hand_over(Result_type &){}
+		};
+
+		template<typename Query_type>
+		struct Execute_probe_guard<Query_type,true>{
+			explicit Execute_probe_guard(Query_type &q):probe(q.probe),nb_exceptions(std::uncaught_exceptions()){probe.execute();}
+			~Execute_probe_guard(){
+				if(!handed_over){probe.finish(std::uncaught_exceptions()>nb_exceptions);}
+			}
+			Execute_probe_guard(const Execute_probe_guard&)=delete;
+			Execute_probe_guard& operator=(const Execute_probe_guard&)=delete;
+
+			template<typename Result_type>
+			void hand_over(Result_type &r){
+				if constexpr(is_observed<Result_type>){r.probe.start(probe); handed_over=true;}
+			}
+
+			private:
+			decltype(std::declval<Query_type&>().probe) &probe;
+			int  nb_exceptions;
+			bool handed_over = false;
+		};
+
+
+		//fetch() fetches row, return false if there is no more rows
+		template<typename Result_type, typename Row_t, typename Fetch_t>
+		bool observe_fetch(Result_type &r, const Row_t &row, Fetch_t &&fetch){
+			bool found;
+			try{found = fetch();}
+			catch(...){r.probe.finish(true); throw;}
+			if(found){r.probe.row(decoded_size(row));}
+			else     {r.probe.finish(false);}
+			return found;
+		}
+	}
+
+
 	//===============
 	//=== prepare ===
 	//===============
@@ -248,7 +532,14 @@ namespace tdb{
     	static_assert(std::is_constructible<SqlData_t<Tag_t>, A...>::value,"SqlData_t must be constructible from A...");
 
     	const SqlData_t<Tag_t>sql(std::forward<A>(prepare_from)...); //step1
-    	return Prepare_t<Tag_t,Return_t2,Bind_t2>::run(db,sql);      //step2
+    	if constexpr(impl::is_observed<Query_t<Tag_t,Return_t2,Bind_t2> >){
+    		const auto prepare_start = std::chrono::steady_clock::now();
+    		auto q = Prepare_t<Tag_t,Return_t2,Bind_t2>::run(db,sql);  //step2
+    		q.probe.prepared(db,sql,prepare_start);
+    		return q;
+    	}else{
+    		return Prepare_t<Tag_t,Return_t2,Bind_t2>::run(db,sql);    //step2
+    	}
     }
 
     template<
@@ -269,7 +560,13 @@ namespace tdb{
     	static_assert(std::is_constructible<SqlData_t<Tag_t>, A...>::value,"SqlData_t must be constructible from A...");
 
     	const SqlData_t<Tag_t>sql(std::forward<A>(prepare_from)...); //step1
-    	return Prepare_t<Tag_t,Return_t2,Bind_t2>::run(q,db,sql);    //step2
+    	if constexpr(impl::is_observed<Query_t<Tag_t,Return_tt,Bind_tt> >){
+    		const auto prepare_start = std::chrono::steady_clock::now();
+    		Prepare_t<Tag_t,Return_t2,Bind_t2>::run(q,db,sql);         //step2
+    		q.probe.prepared(db,sql,prepare_start);
+    	}else{
+    		Prepare_t<Tag_t,Return_t2,Bind_t2>::run(q,db,sql);         //step2
+    	}
     }
 
     template<
@@ -365,13 +662,27 @@ namespace tdb{
       }
     }
 
+    //--- Bind_t (optional) ---
+    //Bind ALL the arguments of a query at once.
+    //default : recursively calls Bind_one_t, from the first to the last argument
+    //Specialize when the driver needs the whole tuple (ex tdb_psql.hpp)
+    template <typename Tag_t,typename Return_tt, typename Bind_tt>
+    struct Bind_t{
+    	template< typename Bind_t2>
+    	static void run(Query_t<Tag_t, Return_tt, Bind_tt >& q, Bind_t2&& bind_me){
+    		helpers::bind_rt<0>(q,std::forward<Bind_t2>(bind_me));
+    	}
+    };
+
+
     //bind_a (don't touch)
     //bind arguments
     template <typename Tag_t,typename Return_tt, typename Bind_tt, typename...A >
     void bind_a(Query_t<Tag_t, Return_tt, Bind_tt >& q, const A&... bind_me){
     	static_assert(std::tuple_size<Bind_tt>::value == sizeof...(bind_me), "Error in bind_a : wrong number of arguments");
-        //Bind_t<Tag_t,Return_tt,Bind_tt >::run(q, std::tie(bind_me...) );
-        helpers::bind_ra<0>(q,bind_me...);
+    	if constexpr(impl::is_observed<Query_t<Tag_t,Return_tt,Bind_tt> >){q.probe.bind_begin();}
+        Bind_t<Tag_t,Return_tt,Bind_tt >::run(q, std::tie(bind_me...) );
+    	if constexpr(impl::is_observed<Query_t<Tag_t,Return_tt,Bind_tt> >){q.probe.bound();}
     }
 
     //bind a tuple containing ALL arguments
@@ -379,12 +690,13 @@ namespace tdb{
     void bind(Query_t<Tag_t, Return_tt, Bind_tt >& q, Bind_tt2&& bind_me){
 
         static_assert(std::tuple_size<std::remove_reference_t<Bind_tt> >::value == std::tuple_size<std::remove_reference_t<Bind_tt2>>::value, "Error in bind : wrong number of arguments");
-        //Bind_t<Tag_t,Return_tt,Bind_tt >::run(q, std::tie(bind_me...) );
-        helpers::bind_rt<0>(q,std::forward<Bind_tt2>(bind_me));
+    	if constexpr(impl::is_observed<Query_t<Tag_t,Return_tt,Bind_tt> >){q.probe.bind_begin();}
+        Bind_t<Tag_t,Return_tt,Bind_tt >::run(q, std::forward<Bind_tt2>(bind_me) );
+    	if constexpr(impl::is_observed<Query_t<Tag_t,Return_tt,Bind_tt> >){q.probe.bound();}
     }
 
 
-    //--- Bind_t (optional) ---
+    //--- Bind_one_t (optional) ---
 
     //bind Null (optional)
     //default do nothing, NO default, as some DB require to increment a bind counter.
@@ -434,6 +746,78 @@ namespace tdb{
 
 
 
+    //===================
+    //=== query cache ===
+    //===================
+    //Get_query_cache_t (optional)
+    //return the Query_cache owned by the connection (see helpers/Query_cache.hpp)
+    //default : not implemented, the convenience functions that take a
+    //connection and some sql prepare a new Query_t at each call.
+    template<typename Tag_t>
+    struct Get_query_cache_t{
+    	static constexpr bool is_implemented = false;
+    };
+
+    template<typename Tag_t>
+    Query_cache & get_query_cache(Connection_t<Tag_t> &c){
+    	static_assert(Get_query_cache_t<Tag_t>::is_implemented,"You need to implement Get_query_cache_t<Tag_t>");
+    	return Get_query_cache_t<Tag_t>::run(c);
+    }
+
+
+    //implementation helper, don't touch
+    namespace impl{
+    	//fn(query) on a freshly prepared query
+    	template<typename Return_tt, typename Bind_tt, typename Tag_t, typename Fn_t>
+    	decltype(auto) with_new_query(Connection_t<Tag_t> &c, const SqlData_t<Tag_t> &s, Fn_t &&fn){
+    		Query_t<Tag_t,Return_tt,Bind_tt> q;
+    		prepare_here(q,c,s);
+    		return fn(q);
+    	}
+
+    	//fn(query) on the cached query, or on a freshly prepared one
+    	//The cached query is shared by the threads that use the same sql : the connection mutex is
+    	//held from the lookup to the end of fn. If fn throws, the query is dropped from the cache
+    	//(its bind and step state is unknown). Dropped queries are destroyed once the mutex is
+    	//released, as some drivers lock it to destroy a query.
+    	template<typename Return_tt, typename Bind_tt, typename Tag_t, typename Fn_t>
+    	decltype(auto) with_query(Connection_t<Tag_t> &c, const SqlData_t<Tag_t> &s, Fn_t &&fn){
+    		typedef Query_t<Tag_t,Return_tt,Bind_tt> Query_type;
+
+    		if constexpr(Get_query_cache_t<Tag_t>::is_implemented){
+    			Query_cache &cache = Get_query_cache_t<Tag_t>::run(c);
+    			Query_cache::Evicted evicted; //destroyed after l
+    			auto l = connection_lock_guard(c);
+    			if(cache.capacity()!=0){ //else : unlocked at the end of this block
+    				const std::string key(sql_debug(s));
+    				Query_type &q = cache.template get<Query_type>(
+    					key,
+    					[&](){return prepare_new<Return_tt,Bind_tt>(c,s);},
+    					evicted
+    				);
+    				try{
+    					return fn(q);
+    				}catch(...){
+    					cache.template erase<Query_type>(key,evicted);
+    					throw;
+    				}
+    			}
+    		}
+
+    		return with_new_query<Return_tt,Bind_tt>(c,s,fn);
+    	}
+
+    	//execute sql without the query cache, ex : sql that is unique (savepoint names), or when
+    	//the caller already holds the connection mutex
+    	template<typename Tag_t>
+    	void execute_new(Connection_t<Tag_t> &c, const std::string &sql_t){
+    		auto s = sql<Tag_t>(sql_t);
+    		with_new_query<std::tuple<>,std::tuple<> >(c,s,[](auto &q){execute(q);});
+    	}
+    }
+
+
+
 	//===============
 	//=== execute ===
 	//===============
@@ -487,9 +871,104 @@ namespace tdb{
     template<typename Tag_t, typename Return_tt>
     std::optional<Return_tt> try_fetch(Result_t<Tag_t,Return_tt> &r){
     	static_assert(Try_fetch_t<Tag_t,Return_tt>::is_implemented,"Try_fetch_t<Tag_t,Return_tt> must be implemented");
-    	return Try_fetch_t<Tag_t,Return_tt>::run(r);
+    	if constexpr(impl::is_observed<Result_t<Tag_t,Return_tt> >){
+    		std::optional<Return_tt> row;
+    		impl::observe_fetch(r,row,[&](){row = Try_fetch_t<Tag_t,Return_tt>::run(r); return row.has_value();});
+    		return row;
+    	}else{
+    		return Try_fetch_t<Tag_t,Return_tt>::run(r);
+    	}
+    }
+
+
+    //--- fetch_into ---
+    //Same as try_fetch, but the row is written into an existing Return_tt :
+    //nothing is constructed per row, and strings reuse their capacity.
+    //return false when there are no more rows (write_here is left unchanged)
+    // Usage:
+    //Return_tt row;
+    //while( fetch_into(result,row) ){
+    //    std::cout << std::get<0>(row)<<"\n";
+    //}
+    //Try_fetch_t<Tag_t,Return_tt>::run_into(result, write_here) (optional)
+    //default : calls Try_fetch_t::run and moves the row into write_here
+    namespace impl{
+    	template<typename Tag_t, typename Return_tt, typename Write_here_t>
+    	concept has_run_into = requires(Result_t<Tag_t,Return_tt> &r, Write_here_t &w){
+    		Try_fetch_t<Tag_t,Return_tt>::run_into(r,w);
+    	};
+
+    	//Return_tt of a Result_t
+    	template<typename Result_tt> struct result_row_t;
+    	template<typename Tag_t, typename Return_tt> struct result_row_t<Result_t<Tag_t,Return_tt> >{typedef Return_tt type;};
+    	template<typename Result_tt> using result_row = typename result_row_t<Result_tt>::type;
+    }
+
+    //don't touch
+    template<typename Tag_t, typename Return_tt, typename Write_here_t>
+    bool fetch_into(Result_t<Tag_t,Return_tt> &r, Write_here_t &write_here){
+    	static_assert(Try_fetch_t<Tag_t,Return_tt>::is_implemented,"Try_fetch_t<Tag_t,Return_tt> must be implemented");
+    	auto fetch = [&](){
+    		if constexpr(impl::has_run_into<Tag_t,Return_tt,Write_here_t>){
+    			return Try_fetch_t<Tag_t,Return_tt>::run_into(r,write_here);
+    		}else{
+    			auto row = Try_fetch_t<Tag_t,Return_tt>::run(r);
+    			if(!row.has_value()){return false;}
+    			write_here = std::move(row.value());
+    			return true;
+    		}
+    	};
+    	if constexpr(impl::is_observed<Result_t<Tag_t,Return_tt> >){return impl::observe_fetch(r,write_here,fetch);}
+    	else                                                     {return fetch();}
     }
 
+
+    //--- Result_t as an input range (don't touch) ---
+    //A Result_t is a single pass std::ranges::input_range of const Return_tt&.
+    //The iterator owns a single row buffer, filled by fetch_into : the
+    //current row is valid until the iterator is incremented.
+    // Usage:
+    //for(const auto &row : result){...}
+    //std::ranges::copy(result, std::back_inserter(v));
+    //for(int i : result | std::views::transform([](const auto &row){return std::get<0>(row);})){...}
+    template<typename Tag_t, typename Return_tt>
+    struct Result_iterator{
+    	typedef Return_tt               value_type;
+    	typedef std::ptrdiff_t          difference_type;
+    	typedef std::input_iterator_tag iterator_concept;
+
+    	Result_iterator()=default;
+    	explicit Result_iterator(Result_t<Tag_t,Return_tt> &r):result(&r){++(*this);}
+
+    	//movable, NOT copiable (single pass)
+    	Result_iterator(Result_iterator&&)=default;
+    	Result_iterator& operator=(Result_iterator&&)=default;
+    	Result_iterator(const Result_iterator&)=delete;
+    	Result_iterator& operator=(const Result_iterator&)=delete;
+
+    	const Return_tt& operator*()const{return row;}
+    	const Return_tt* operator->()const{return &row;}
+
+    	Result_iterator& operator++(){
+    		if(!fetch_into(*result,row)){result=nullptr;}
+    		return *this;
+    	}
+    	void operator++(int){++(*this);}
+
+    	friend bool operator==(const Result_iterator &i, std::default_sentinel_t){return i.result==nullptr;}
+
+    	private:
+    	Result_t<Tag_t,Return_tt> *result = nullptr; //nullptr : end
+    	Return_tt row;
+    };
+
+    //begin fetches the first row, call it once
+    template<typename Tag_t, typename Return_tt>
+    Result_iterator<Tag_t,Return_tt> begin(Result_t<Tag_t,Return_tt> &r){return Result_iterator<Tag_t,Return_tt>(r);}
+
+    template<typename Tag_t, typename Return_tt>
+    std::default_sentinel_t end(Result_t<Tag_t,Return_tt> &){return std::default_sentinel;}
+
     //--- DOC : try_fetch usage ---
     /*auto r = try_fetch(result);
 	while(r.has_value() ){
@@ -499,6 +978,30 @@ namespace tdb{
 	}*/
 
 
+    //--- Is_borrowed_t (optional) ---
+    //true for the types that point into the result instead of owning a copy
+    //(e.g., std::string_view, std::span<const std::byte>). They are valid until
+    //the next fetch, so they can only be used with a loop on try_fetch, Fn_foreach
+    //or Fn_function. Drivers decide which of these types they can fetch.
+    template<typename T>
+    struct Is_borrowed_t{static constexpr bool value = false;};
+
+    template<> struct Is_borrowed_t<std::string_view>           {static constexpr bool value = true;};
+    template<> struct Is_borrowed_t<std::span<const std::byte> >{static constexpr bool value = true;};
+    template<typename T> struct Is_borrowed_t<std::optional<T> >{static constexpr bool value = Is_borrowed_t<T>::value;};
+
+    namespace impl{
+    	template<typename Return_tt> struct has_borrowed_t;
+    	template<typename... T> struct has_borrowed_t<std::tuple<T...> >{
+    		static constexpr bool value = (Is_borrowed_t<T>::value || ...);
+    	};
+
+    	//true if a row of Return_tt is invalidated by the next fetch
+    	template<typename Return_tt>
+    	inline constexpr bool has_borrowed = has_borrowed_t<Return_tt>::value;
+    }
+
+
     //has_count_row
     //count_row MAY NOT be implemented, as some db don't provide row counting capabilities
     //Caller code MUST use a if constexpr(has_count_row<Tag_t>){...}
@@ -639,6 +1142,7 @@ namespace tdb{
     template<typename Tag_t, typename Return_tt>
     void execute(Query<Tag_t,Return_tt,std::tuple<> > &q){
     	static_assert(Execute_t<Tag_t,Return_tt, std::tuple<> >::is_implemented,"Execute_t is not implemented");
+    	impl::Execute_probe_guard<Query<Tag_t,Return_tt,std::tuple<> > > probe(q);
     	Execute_t<Tag_t,Return_tt, std::tuple<> >::run(q);
     }
 
@@ -647,9 +1151,7 @@ namespace tdb{
     	static_assert(Execute_t<Tag_t,std::tuple<>, std::tuple<> >::is_implemented,"Execute_t is not implemented");
 
     	auto s = sql<Tag_t>(sql_t);
-    	Query_t<Tag_t,std::tuple<>,std::tuple<> > q;
-    	prepare_here(q,c,s);
-    	execute(q);
+    	impl::with_query<std::tuple<>,std::tuple<> >(c,s,[](auto &q){execute(q);} );
     }
 
 
@@ -661,6 +1163,7 @@ namespace tdb{
     void execute(Query<Tag_t,Return_tt,Bind_tt > &q, const Bind_t2 &bind_me){
     	static_assert(Execute_t<Tag_t,Return_tt, Bind_tt >::is_implemented,"Execute_t is not implemented");
     	tdb::bind(q,bind_me);
+    	impl::Execute_probe_guard<Query<Tag_t,Return_tt,Bind_tt> > probe(q);
     	Execute_t<Tag_t,Return_tt, Bind_tt >::run(q);
     }
 
@@ -671,9 +1174,7 @@ namespace tdb{
     	static_assert(Execute_t<Tag_t,std::tuple<>, Bind_tt >::is_implemented,"Execute_t is not implemented");
 
     	auto s = sql<Tag_t>(sql_t);
-    	Query<Tag_t,std::tuple<>, Bind_tt > q;
-    	prepare_here(q,c,s);
-    	execute(q, bind_me);
+    	impl::with_query<std::tuple<>,Bind_tt>(c,s,[&](auto &q){execute(q, bind_me);} );
     }
 
 
@@ -695,46 +1196,139 @@ namespace tdb{
     //read from input stream, multiple queries are allowed
     //will be default implemented trough ReadString_t that execute MULTIPLE queries
     //Execute_t (required)
-    template<typename Tag_t> void read_istream(Connection_t<Tag_t> &q, std::istream &in);
-    template<typename Tag_t> void read_string (Connection_t<Tag_t> &q, const std::string &s);
-    template<typename Tag_t> void read_file   (Connection_t<Tag_t> &q, const std::filesystem::path &p);
+
+    //progress of a script, reported to Script_options::progress
+    struct Script_progress{
+    	size_t nb_statements = 0; //executed so far
+    	size_t nb_bytes      = 0; //read so far
+    	size_t total_bytes   = 0; //size of the input, 0 if unknown
+    };
+
+    struct Script_options{
+    	bool   single_transaction = false;   //BEGIN ... COMMIT around the script, ROLLBACK on error
+    	size_t buffer_size        = 1<<20;   //bytes read at once (grows if a statement is larger)
+    	size_t batch_size         = 1000;    //statements sent before waiting for their results, if the backend pipelines (psql)
+    	std::function<void(const Script_progress&)> progress; //called after each buffer or batch (optional)
+    };
+
+    template<typename Tag_t> void read_istream(Connection_t<Tag_t> &q, std::istream &in,           const Script_options &o=Script_options());
+    template<typename Tag_t> void read_string (Connection_t<Tag_t> &q, const std::string &s,       const Script_options &o=Script_options());
+    template<typename Tag_t> void read_file   (Connection_t<Tag_t> &q, const std::filesystem::path &p, const Script_options &o=Script_options());
 
 
+    //default : slurp the stream, then Read_String_t
     template<typename Tag_t>
     struct Read_Istream_t{
     	static constexpr bool is_implemented = true;
-    	static void run(Connection_t<Tag_t> &q, std::istream &in){
+    	static void run(Connection_t<Tag_t> &q, std::istream &in, const Script_options &o){
     		//https://stackoverflow.com/questions/116038/what-is-the-best-way-to-slurp-a-file-into-a-stdstring-in-c
     		std::string buffer(static_cast<std::stringstream const&>(std::stringstream() << in.rdbuf()).str());
-    		read_string(q,buffer);
+    		read_string(q,buffer,o);
     	}
     };
 
     template<typename Tag_t>
     struct Read_String_t{
     	static constexpr bool is_implemented = false;
-    	//static void run(Connection_t<Tag_t> &q, const std::string &in){}
+    	//static void run(Connection_t<Tag_t> &q, const std::string &in, const Script_options &o){}
     };
 
 
+    //implementation helpers, don't touch
+    namespace impl{
+    	//read only istream on a memory range (no copy)
+    	struct Memory_streambuf:std::streambuf{
+    		Memory_streambuf(const char *begin, const char *end){
+    			char *b = const_cast<char*>(begin); //never written
+    			setg(b,b,const_cast<char*>(end));
+    		}
+
+    		protected:
+    		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)override{
+    			if(!(which & std::ios_base::in)){return pos_type(off_type(-1));}
+    			char *base = eback();
+    			char *pos  = dir==std::ios_base::beg ? base : dir==std::ios_base::cur ? gptr() : egptr();
+    			pos += off;
+    			if(pos<base or pos>egptr()){return pos_type(off_type(-1));}
+    			setg(base,pos,egptr());
+    			return pos_type(pos-base);
+    		}
+    		pos_type seekpos(pos_type p, std::ios_base::openmode which)override{
+    			return seekoff(off_type(p),std::ios_base::beg,which);
+    		}
+    	};
+
+    	//Read_String_t for backends that stream with Read_Istream_t
+    	template<typename Tag_t>
+    	void read_string_as_istream(Connection_t<Tag_t> &q, const std::string &s, const Script_options &o){
+    		Memory_streambuf buf(s.data(), s.data()+s.size());
+    		std::istream in(&buf);
+    		Read_Istream_t<Tag_t>::run(q,in,o);
+    	}
+
+    	//bytes left in a seekable stream, 0 if unknown
+    	inline size_t stream_remaining_size(std::istream &in){
+    		const std::istream::pos_type here = in.tellg();
+    		if(here==std::istream::pos_type(-1)){in.clear(); return 0;}
+    		in.seekg(0,std::ios_base::end);
+    		const std::istream::pos_type end = in.tellg();
+    		in.seekg(here);
+    		if(end==std::istream::pos_type(-1) or !in){in.clear(); in.seekg(here); return 0;}
+    		return static_cast<size_t>(end-here);
+    	}
+
+    	//fixed size buffer over a stream : the unfinished statement stays at the front
+    	struct Script_buffer{
+    		Script_buffer(std::istream &in_, const Script_options &o):in(in_),chunk_size(std::max<size_t>(o.buffer_size,1)){
+    			progress.total_bytes = stream_remaining_size(in);
+    		}
+
+    		//append up to chunk_size bytes, false at the end of the input
+    		bool read(){
+    			if(eof){return false;}
+    			const size_t old_size = data.size();
+    			data.resize(old_size+chunk_size);
+    			in.read(data.data()+old_size, static_cast<std::streamsize>(chunk_size));
+    			const size_t n = static_cast<size_t>(in.gcount());
+    			data.resize(old_size+n);
+    			progress.nb_bytes += n;
+    			if(n<chunk_size){
+    				if(in.bad()){throw std::runtime_error("Cannot read the script");}
+    				eof = true;
+    			}
+    			return n!=0;
+    		}
+
+    		//remove the n first bytes (done)
+    		void consume(size_t n){data.erase(0,n);}
+
+    		std::istream &in;
+    		size_t       chunk_size;
+    		std::string  data;
+    		bool         eof = false;
+    		Script_progress progress;
+    	};
+    }
+
+
     template<typename Tag_t>
-    void read_istream(Connection_t<Tag_t> &q, std::istream &in){
+    void read_istream(Connection_t<Tag_t> &q, std::istream &in, const Script_options &o){
     	static_assert(Read_Istream_t<Tag_t>::is_implemented,"ReadIstream_t is not implemented");
-    	Read_Istream_t<Tag_t>::run(q, in);
+    	Read_Istream_t<Tag_t>::run(q, in, o);
     }
 
     template<typename Tag_t>
-    void read_string(Connection_t<Tag_t> &q, const std::string &s){
-    	static_assert(Read_Istream_t<Tag_t>::is_implemented,"ReadString_t is not implemented");
-    	Read_String_t<Tag_t>::run(q,s);
+    void read_string(Connection_t<Tag_t> &q, const std::string &s, const Script_options &o){
+    	static_assert(Read_String_t<Tag_t>::is_implemented,"ReadString_t is not implemented");
+    	Read_String_t<Tag_t>::run(q,s,o);
     }
 
     template<typename Tag_t>
-    void read_file(Connection_t<Tag_t> &q, const std::filesystem::path &p){
+    void read_file(Connection_t<Tag_t> &q, const std::filesystem::path &p, const Script_options &o){
     	static_assert(Read_Istream_t<Tag_t>::is_implemented,"ReadIstream_t is not implemented");
-    	std::ifstream in(p);
+    	std::ifstream in(p, std::ios_base::binary);
     	if(!in){throw std::runtime_error("Cannot open "+p.string());}
-    	read_istream(q,in);
+    	read_istream(q,in,o);
     }
 
 
@@ -753,6 +1347,7 @@ namespace tdb{
     template<typename Tag_t>
     Rowid<Tag_t> insert(Query<Tag_t,std::tuple<>,std::tuple<> > &q){
     	static_assert(Insert_t<Tag_t,std::tuple<>, std::tuple<> >::is_implemented,"Insert_t is not implemented");
+    	impl::Execute_probe_guard<Query<Tag_t,std::tuple<>,std::tuple<> > > probe(q);
     	return Insert_t<Tag_t,std::tuple<>, std::tuple<> >::run(q);
     }
 
@@ -760,6 +1355,7 @@ namespace tdb{
     Rowid<Tag_t> insert(Query<Tag_t,std::tuple<>,Bind_tt > &q, const Bind_t2 &bind_me){
     	static_assert(Insert_t<Tag_t,std::tuple<>, Bind_tt >::is_implemented,"Insert_t is not implemented");
     	tdb::bind(q,bind_me);
+    	impl::Execute_probe_guard<Query<Tag_t,std::tuple<>,Bind_tt> > probe(q);
     	return Insert_t<Tag_t,std::tuple<>, Bind_tt >::run(q);
     }
 
@@ -768,9 +1364,7 @@ namespace tdb{
     	static_assert(Insert_t<Tag_t,std::tuple<>, std::tuple<> >::is_implemented,"Insert_t is not implemented");
 
     	auto s = sql<Tag_t>(sql_t);
-    	Query_t<Tag_t,std::tuple<>,std::tuple<> > q;
-    	prepare_here(q,c,s);
-    	return insert(q);
+    	return impl::with_query<std::tuple<>,std::tuple<> >(c,s,[](auto &q){return insert(q);} );
     }
 
     template<typename Tag_t , typename Bind_t2, typename Sql_tt>
@@ -779,9 +1373,7 @@ namespace tdb{
     	static_assert(Insert_t<Tag_t,std::tuple<>, Bind_tt >::is_implemented,"Insert_t is not implemented");
 
     	auto s = sql<Tag_t>(sql_t);
-    	Query<Tag_t,std::tuple<>, Bind_tt > q;
-    	prepare_here(q,c,s);
-    	return insert(q, bind_me);
+    	return impl::with_query<std::tuple<>,Bind_tt>(c,s,[&](auto &q){return insert(q, bind_me);} );
     }
 
 
@@ -796,6 +1388,66 @@ namespace tdb{
     	return insert(q,std::tie(bind_me1,bind_me...));
     }
 
+    template<typename Tag_t, typename Sql_tt, typename... A>
+    Rowid<Tag_t> insert_a(Connection_t<Tag_t> &c, const Sql_tt &sql_t, const A&... bind_me){
+    	return insert(c,sql_t,std::tie(bind_me...));
+    }
+
+
+    //--- multi rows insert ---
+    //Get_bind_limit_t (optional)
+    //maximum number of bound parameters in a single statement
+    //default : 999 (the historical sqlite limit)
+    template<typename Tag_t>
+    struct Get_bind_limit_t{
+    	static constexpr bool is_implemented = true;
+    	static size_t run(const Connection_t<Tag_t> &){return 999;}
+    };
+
+    template<typename Tag_t>
+    size_t get_bind_limit(const Connection_t<Tag_t> &c){
+    	return Get_bind_limit_t<Tag_t>::run(c);
+    }
+
+    //Multi_insert_t (optional, required by Fn_insert_batch)
+    //An insert prepared with nb_rows rows of Bind_tt in its VALUES clause :
+    //  head VALUES (...),(...),... tail
+    //Expected interface
+    //  Multi_insert_t();                                  //not prepared, nb_rows()==0
+    //  Multi_insert_t(Multi_insert_t&&);                  //movable, NOT copiable
+    //  Multi_insert_t(Connection_t<Tag_t>&, const std::string &head, const std::string &tail, size_t nb_rows);
+    //  size_t nb_rows()const;
+    //  template<typename It> void run(It &first);        //bind nb_rows rows from first (first is advanced), execute
+    template<typename Tag_t, typename Bind_tt>
+    struct Multi_insert_t{
+    	static constexpr bool is_implemented = false;
+    };
+
+    //implementation helper, don't touch
+    namespace impl{
+    	//head VALUES (p,p),(p,p) tail
+    	//numbered : $1,$2... otherwise ?
+    	inline std::string multi_insert_sql(const std::string &head, const std::string &tail, size_t nb_rows, size_t nb_cols, bool numbered){
+    		std::string r = head;
+    		r.reserve(head.size() + tail.size() + 8 + nb_rows*nb_cols*(numbered ? 8 : 2) );
+    		r+=" VALUES ";
+    		size_t n = 0;
+    		for(size_t i = 0; i < nb_rows; ++i){
+    			if(i!=0){r+=',';}
+    			r+='(';
+    			for(size_t j = 0; j < nb_cols; ++j){
+    				if(j!=0){r+=',';}
+    				++n;
+    				if(numbered){r+='$'; r+=std::to_string(n);}
+    				else        {r+='?';}
+    			}
+    			r+=')';
+    		}
+    		if(!tail.empty()){r+=' '; r+=tail;}
+    		return r;
+    	}
+    }
+
 
     //--- get_result ---
     //get_result returns a result
@@ -815,20 +1467,29 @@ namespace tdb{
     //get_result (don't touch)
     template<typename Tag_t, typename Return_tt>
     Result<Tag_t,Return_tt> get_result( Query_t< Tag_t,Return_tt,std::tuple<> > &q){
-    	return Get_result_t<Tag_t,Return_tt, std::tuple<> >::run(q);
+    	impl::Execute_probe_guard<Query_t<Tag_t,Return_tt,std::tuple<> > > probe(q);
+    	Result<Tag_t,Return_tt> r = Get_result_t<Tag_t,Return_tt, std::tuple<> >::run(q);
+    	probe.hand_over(r);
+    	return r;
     }
 
     template<typename Tag_t, typename Return_tt, typename Bind_tt, typename Bind_t2>
     Result<Tag_t,Return_tt> get_result(Query_t<Tag_t,Return_tt,Bind_tt > &q, const Bind_t2 &bind_me){
     	bind(q,bind_me);
-    	return Get_result_t<Tag_t,Return_tt, Bind_tt >::run(q);
+    	impl::Execute_probe_guard<Query_t<Tag_t,Return_tt,Bind_tt> > probe(q);
+    	Result<Tag_t,Return_tt> r = Get_result_t<Tag_t,Return_tt, Bind_tt >::run(q);
+    	probe.hand_over(r);
+    	return r;
     }
 
     template<typename Tag_t, typename Return_tt, typename Bind_tt, typename... A>
     Result<Tag_t,Return_tt> get_result_a(Query<Tag_t,Return_tt,Bind_tt > &q, const A&... bind_me){
     	static_assert(std::tuple_size<Bind_tt>::value == sizeof...(bind_me), "Error in get_result_a : wrong number of arguments");
     	bind_a(q,bind_me...);
-    	return Get_result_t<Tag_t,Return_tt, Bind_tt >::run(q);
+    	impl::Execute_probe_guard<Query_t<Tag_t,Return_tt,Bind_tt> > probe(q);
+    	Result<Tag_t,Return_tt> r = Get_result_t<Tag_t,Return_tt, Bind_tt >::run(q);
+    	probe.hand_over(r);
+    	return r;
     }
 
 
@@ -860,23 +1521,18 @@ namespace tdb{
 			Write_here_tt &write_here ,
 			const Bind_t2 &bind_me
 	){
-		 if constexpr(has_count_row<Tag_t>){
-			 Result<Tag_t,Return_tt> r = get_result(q,bind_me);
-			 auto row_number = count_row(r);
-			 if(row_number!=1){throw std::runtime_error("Error in get_unique : one row is expected, but result has " + std::to_string(row_number) + " row(s)" );}
-			 write_here =  get_row(r);
-			 return;
-		 }else{
-			Result<Tag_t,Return_tt> r = get_result(q,bind_me);
-			auto row1 = try_fetch(r);
-			auto row2 = try_fetch(r);
+		static_assert(!impl::has_borrowed<Return_tt>,"get_unique cannot return borrowed types (std::string_view, std::span...), they are invalidated by the next fetch");
 
-			if(!row1.has_value()){throw std::runtime_error("Error in get_unique : empty result");}
-			if( row2.has_value()){throw std::runtime_error("Error in get_unique : more than one row");}
+		//NOTE : don't use count_row here, it may not be available at runtime (e.g., streaming psql results)
+		Result<Tag_t,Return_tt> r = get_result(q,bind_me);
+		auto row1 = try_fetch(r);
+		auto row2 = try_fetch(r);
 
-			write_here=row1.value();
-			return;
-		 }
+		if(!row1.has_value()){throw std::runtime_error("Error in get_unique : empty result");}
+		if( row2.has_value()){throw std::runtime_error("Error in get_unique : more than one row");}
+
+		write_here=row1.value();
+		return;
 	}
 
 	template<typename Tag_t, typename Return_tt,typename Write_here_tt>
@@ -940,11 +1596,12 @@ namespace tdb{
 		bool is_finished=false;
 		std::string name;
 
-		void commit()  {is_finished=true; tdb::execute_a(db,"RELEASE SAVEPOINT " + name);}
-		void rollback(){is_finished=true; tdb::execute_a(db,"ROLLBACK TO SAVEPOINT " + name);};
+		//the names are unique : not cached, they would evict the other queries
+		void commit()  {is_finished=true; impl::execute_new(db,"RELEASE SAVEPOINT " + name);}
+		void rollback(){is_finished=true; impl::execute_new(db,"ROLLBACK TO SAVEPOINT " + name);};
 
 		private:
-		void begin()   {tdb::execute_a(db,"SAVEPOINT "+name);}
+		void begin()   {impl::execute_new(db,"SAVEPOINT "+name);}
 
 		static std::string mk_name(void * unique_id){
 			std::stringstream ss;
@@ -955,6 +1612,16 @@ namespace tdb{
 	};
 
 
+	//--- statement errors (optional) ---
+	//true if a failed statement aborts the current transaction : only ROLLBACK (or ROLLBACK TO
+	//SAVEPOINT) can run afterwards (ex : psql).
+	//default : false, the failed statement is undone and the transaction goes on (ex : sqlite)
+	template<typename Tag_t>
+	struct Error_aborts_transaction_t{
+		static constexpr bool value = false;
+	};
+
+
 
 
 
@@ -32,5 +32,86 @@ namespace{
 		while( auto r = try_fetch(result) ){
 		    std::cout << std::get<0>(r.value())<<"\n";
 		}
+
+
+		//--- binary format : characters are bound and fetched as in the text format ---
+		tdb::execute (connection,"drop table if exists test_char;");
+		tdb::execute (connection,"create table test_char(c char(1), u char(1));");
+
+		typedef std::tuple<signed char, unsigned char> Chars_t;
+		auto ins_text = tdb::prepare_new< std::tuple<> , Chars_t >(connection,"insert into test_char (c,u)values($1,$2)");
+		auto sel_text = tdb::prepare_new< Chars_t , std::tuple<> >(connection,"select c,u from test_char");
+		connection.set_default_format(tdb::psql::FORMAT_BINARY);
+		auto ins_bin  = tdb::prepare_new< std::tuple<> , Chars_t >(connection,"insert into test_char (c,u)values($1,$2)");
+		auto sel_bin  = tdb::prepare_new< Chars_t , std::tuple<> >(connection,"select c,u from test_char");
+		//std::string has no type : the server reads it as the integer i1 is
+		auto by_str   = tdb::prepare_new< std::tuple<long long> , std::tuple<std::string> >(connection,"select count(*) from test where i1=$1");
+		connection.set_default_format(tdb::psql::FORMAT_TEXT);
+
+		std::tuple<long long> n_str;
+		tdb::get_unique(by_str, n_str, std::make_tuple(std::string("100")));
+		assert(std::get<0>(n_str)==1);
+
+		tdb::execute_a(ins_text, static_cast<signed char>('a'), static_cast<unsigned char>('b'));
+		tdb::execute_a(ins_bin , static_cast<signed char>('a'), static_cast<unsigned char>('b'));
+		for(auto *sel : {&sel_text, &sel_bin}){
+			auto rc = tdb::get_result_a(*sel);
+			size_t nb_rows = 0;
+			while( auto r = try_fetch(rc) ){
+				assert(r.value()==Chars_t('a','b'));
+				++nb_rows;
+			}
+			assert(nb_rows==2);
+		}
+
+
+#ifdef LIBPQ_HAS_PIPELINING
+		//--- pipeline : statements that are not synced are rolled back ---
+		auto count = tdb::prepare_new< std::tuple<long long> , std::tuple<> >(connection,"select count(*) from test");
+		std::tuple<long long> n0;
+		tdb::get_unique(count, n0);
+
+		auto ins = tdb::prepare_new< std::tuple<> , std::tuple<int,int,double,double> >(connection,"insert into test (i1,i2,d1,d2)values($1,$2,$3,$4)");
+		try{
+			auto p = tdb::psql::pipeline(connection);
+			for(int i = 0; i < 10; ++i){p.execute_a(ins, i,i,0.5,0.5);}
+			throw std::runtime_error("error while the pipeline is being built");
+		}catch(const std::runtime_error&){}
+
+		{
+			auto p = tdb::psql::pipeline(connection);
+			for(int i = 0; i < 10; ++i){p.execute_a(ins, i,i,0.5,0.5);}
+			p.discard();
+			assert(p.pending()==0);
+		}
+
+		std::tuple<long long> n1;
+		tdb::get_unique(count, n1);
+		assert(std::get<0>(n0)==std::get<0>(n1));
+
+		{
+			auto p = tdb::psql::pipeline(connection);
+			for(int i = 0; i < 10; ++i){p.execute_a(ins, i,i,0.5,0.5);}
+			for(const tdb::psql::Pipeline_status &st : p.sync()){assert(st.ok);}
+		}
+		std::tuple<long long> n2;
+		tdb::get_unique(count, n2);
+		assert(std::get<0>(n2)==std::get<0>(n0)+10);
+
+		//a failure rolls back the whole sync() : the statements before it are not ok either
+		auto div = tdb::prepare_new< std::tuple<> , std::tuple<int> >(connection,"insert into test (i1,i2,d1,d2)values(1/$1,1,1,1)");
+		{
+			auto p = tdb::psql::pipeline(connection);
+			p.execute_a(ins, 1,1,0.5,0.5);
+			p.execute_a(div, 0);
+			p.execute_a(ins, 2,2,0.5,0.5);
+			const std::vector<tdb::psql::Pipeline_status> st = p.sync();
+			assert(st.size()==3);
+			for(const tdb::psql::Pipeline_status &s : st){assert(!s.ok and !s.error.empty());}
+		}
+		std::tuple<long long> n3;
+		tdb::get_unique(count, n3);
+		assert(std::get<0>(n3)==std::get<0>(n2));
+#endif
   }
 }
@@ -0,0 +1,339 @@
+#ifndef LIB_TDB_TDB_POOL_HPP_
+#define LIB_TDB_TDB_POOL_HPP_
+
+//--- Pool of connections (any Tag_t) ---
+//A connection serializes its users on its mutex : a Pool owns N connections,
+//and lends each of them to one thread at a time.
+//
+//tdb::Pool<Tag_sqlite> pool(tdb::pool_connector<Tag_sqlite>("db.sqlite", tdb::sqlite::Options::oltp()), options);
+//{
+//  tdb::Pool_lease<Tag_sqlite> c = pool.checkout();   //wait at most options.checkout_timeout
+//  tdb::execute_a(*c, "insert into t values(?)", 42);
+//  auto &fn = c.prepared<Fn_get_value_unique<Tag_sqlite,std::tuple<int>,std::tuple<>,false> >("select count(*) from t");
+//  int n = fn();
+//} //the connection goes back to the pool
+//
+//Health checks : a connection that was not used for health_check_interval is checked
+//(Pool_health_check_t) before being lent, it is reconnected if the check fails, or
+//if set_broken() was called on its last lease.
+//
+//Prepared functors : each connection caches its functors (keyed by type and sql),
+//a prepared functor is valid until its lease is released.
+//Pooled<Fn_type> prepares its functor on whatever connection it gets, on first use.
+//
+//Rw_pool : one writer and N readers (ex : sqlite in WAL mode, where readers don't block the writer).
+//
+//NOTE : a connection is lent as is, don't give it back inside a transaction.
+//The pool must outlive its leases.
+
+#include "tdb.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tdb{
+
+	struct Pool_options{
+		size_t                    size                   = 4;
+		std::chrono::milliseconds checkout_timeout       = std::chrono::milliseconds(5000);
+		std::chrono::milliseconds health_check_interval  = std::chrono::milliseconds(30000); //0 : check at each checkout
+		size_t                    functor_cache_capacity = Query_cache::default_capacity;    //per connection, at least 1
+	};
+
+	struct Pool_stats{
+		size_t checkout  = 0; //successful checkouts
+		size_t wait      = 0; //checkouts that had to wait for a connection
+		size_t timeout   = 0; //checkouts that failed on timeout
+		size_t reconnect = 0; //connections replaced after a failed health check or set_broken()
+	};
+
+
+	//Pool_health_check_t (optional)
+	//return false if the connection is not usable anymore
+	//default : run "SELECT 1"
+	template<typename Tag_t>
+	struct Pool_health_check_t{
+		static bool run(Connection_t<Tag_t> &c){
+			try{
+				tdb::execute(c,"SELECT 1");
+				return true;
+			}catch(const Exception_base&){
+				return false;
+			}
+		}
+	};
+
+
+	//make_connection for a Pool : construct each connection with Connection_t<Tag_t>(a...)
+	template<typename Tag_t, typename... A>
+	auto pool_connector(A... a){
+		return [=](){return std::make_unique<Connection_t<Tag_t> >(a...);};
+	}
+
+
+	template<typename Tag_t> struct Pool;
+
+	namespace impl{
+		template<typename Tag_t>
+		struct Pool_slot{
+			explicit Pool_slot(size_t functor_cache_capacity):functors(functor_cache_capacity){}
+
+			std::unique_ptr<Connection_t<Tag_t> > connection; //nullptr : reconnect on next checkout
+			Query_cache functors; //declared after connection : destroyed first
+			Query_cache::Evicted evicted; //functors evicted during a lease, destroyed when it ends (before the connection)
+			std::chrono::steady_clock::time_point last_check;
+			bool broken = false;
+		};
+	}
+
+
+
+	//--- Pool_lease : a connection, given back to the pool on destruction ---
+	template<typename Tag_t>
+	struct Pool_lease{
+
+		//movable, NOT copiable
+		Pool_lease(Pool_lease &&a):pool(a.pool),slot(a.slot){a.slot=nullptr;}
+		Pool_lease& operator=(Pool_lease &&a){
+			if(this!=&a){release(); pool=a.pool; slot=a.slot; a.slot=nullptr;}
+			return *this;
+		}
+		Pool_lease(const Pool_lease&)=delete;
+		Pool_lease& operator=(const Pool_lease&)=delete;
+
+		~Pool_lease(){release();}
+
+		Connection_t<Tag_t>& connection()const{assert(slot); return *slot->connection;}
+		Connection_t<Tag_t>& operator*  ()const{return connection();}
+		Connection_t<Tag_t>* operator-> ()const{return &connection();}
+
+		//Fn_type(connection, sql), prepared once per connection
+		//The reference is valid until the lease is released : a functor evicted from the cache
+		//(more than functor_cache_capacity functors) is only destroyed when the lease ends.
+		//Don't keep it after : the connection is lent to other threads.
+		template<typename Fn_type>
+		Fn_type & prepared(const std::string &sql){
+			return prepared<Fn_type>(sql, [&](Connection_t<Tag_t> &c){return Fn_type(c,sql);});
+		}
+
+		//make(connection) returns a Fn_type, it is called once per connection and key
+		template<typename Fn_type, typename Make_t>
+		Fn_type & prepared(const std::string &key, Make_t &&make){
+			assert(slot);
+			Connection_t<Tag_t> &c = *slot->connection;
+			return slot->functors.template get<Fn_type>(key, [&](){return make(c);}, slot->evicted);
+		}
+
+		//the connection is replaced before its next checkout
+		void set_broken(){assert(slot); slot->broken=true;}
+
+		//give the connection back now
+		void release();
+
+		private:
+		friend struct Pool<Tag_t>;
+		Pool_lease(Pool<Tag_t> &p, impl::Pool_slot<Tag_t> &s):pool(&p),slot(&s){}
+
+		Pool<Tag_t>            *pool;
+		impl::Pool_slot<Tag_t> *slot; //nullptr : released
+	};
+
+
+
+	//--- Pool ---
+	template<typename Tag_t>
+	struct Pool{
+		typedef std::function<std::unique_ptr<Connection_t<Tag_t> >()> Make_connection_t;
+
+		//NOT copiable, NOT movable (leases point to the pool)
+		Pool(Pool&&)                =delete;
+		Pool& operator=(Pool&&)     =delete;
+		Pool(const Pool&)           =delete;
+		Pool& operator=(const Pool&)=delete;
+
+		//connect options.size connections now (throw if one fails)
+		explicit Pool(Make_connection_t make_connection_, const Pool_options &options_=Pool_options()):
+			make_connection(std::move(make_connection_)),
+			options(options_)
+		{
+			if(options.size==0){throw Exception_t<Tag_t>("Pool : size must be > 0");}
+			options.functor_cache_capacity = std::max<size_t>(1,options.functor_cache_capacity);
+
+			slots.reserve(options.size);
+			idle .reserve(options.size);
+			for(size_t i = 0; i < options.size; ++i){
+				auto s = std::make_unique<impl::Pool_slot<Tag_t> >(options.functor_cache_capacity);
+				s->connection = make_connection();
+				s->last_check = std::chrono::steady_clock::now();
+				idle.push_back(s.get());
+				slots.push_back(std::move(s));
+			}
+		}
+
+		~Pool(){
+			assert(idle.size()==slots.size() && "a Pool_lease outlives its Pool");
+		}
+
+		//wait for a connection, throw Exception_t<Tag_t> on timeout
+		Pool_lease<Tag_t> checkout(){return checkout(options.checkout_timeout);}
+
+		Pool_lease<Tag_t> checkout(std::chrono::milliseconds timeout){
+			auto r = try_checkout(timeout);
+			if(!r){throw Exception_t<Tag_t>("Pool : checkout timeout ("+std::to_string(timeout.count())+" ms), size="+std::to_string(slots.size()));}
+			return std::move(r.value());
+		}
+
+		//empty optional on timeout (default : don't wait)
+		std::optional<Pool_lease<Tag_t> > try_checkout(std::chrono::milliseconds timeout=std::chrono::milliseconds(0)){
+			impl::Pool_slot<Tag_t> *s = nullptr;
+			{
+				std::unique_lock<std::mutex> l(mutex);
+				if(idle.empty()){
+					++stats_value.wait;
+					if(!available.wait_for(l,timeout,[&](){return !idle.empty();})){
+						++stats_value.timeout;
+						return std::nullopt;
+					}
+				}
+				s = idle.back(); //most recently used first : warm caches
+				idle.pop_back();
+				++stats_value.checkout;
+			}
+
+			std::optional<Pool_lease<Tag_t> > r(Pool_lease<Tag_t>(*this,*s)); //given back if check throws
+			check(*s);
+			return r;
+		}
+
+		size_t size()const{return slots.size();}
+
+		size_t idle_count()const{
+			std::lock_guard<std::mutex> l(mutex);
+			return idle.size();
+		}
+
+		Pool_stats stats()const{
+			std::lock_guard<std::mutex> l(mutex);
+			return stats_value;
+		}
+
+		const Pool_options& get_options()const{return options;}
+
+
+		private:
+		friend struct Pool_lease<Tag_t>;
+
+		//health check, or reconnect (without the pool mutex : it may be slow)
+		void check(impl::Pool_slot<Tag_t> &s){
+			const auto now = std::chrono::steady_clock::now();
+			if(s.connection && !s.broken){
+				if(now - s.last_check < options.health_check_interval){return;}
+				if(Pool_health_check_t<Tag_t>::run(*s.connection)){s.last_check=now; return;}
+			}
+
+			s.functors.clear(); //before the connection they use
+			s.connection.reset();
+			s.broken = false;
+			s.connection = make_connection(); //on throw : the slot is given back empty, and retried next time
+			s.last_check = std::chrono::steady_clock::now();
+
+			std::lock_guard<std::mutex> l(mutex);
+			++stats_value.reconnect;
+		}
+
+		void give_back(impl::Pool_slot<Tag_t> &s){
+			s.evicted.clear(); //the functors of the lease are not used anymore
+			s.last_check = std::chrono::steady_clock::now(); //just used
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				idle.push_back(&s);
+			}
+			available.notify_one();
+		}
+
+		Make_connection_t make_connection;
+		Pool_options      options;
+
+		mutable std::mutex      mutex;     //protects idle and stats_value
+		std::condition_variable available;
+		std::vector<std::unique_ptr<impl::Pool_slot<Tag_t> > > slots;
+		std::vector<impl::Pool_slot<Tag_t>*>                   idle;
+		Pool_stats stats_value;
+	};
+
+
+	template<typename Tag_t>
+	void Pool_lease<Tag_t>::release(){
+		if(slot==nullptr){return;}
+		pool->give_back(*slot);
+		slot=nullptr;
+	}
+
+
+
+	//--- Pooled : a functor prepared on each connection of a pool, on first use ---
+	//tdb::Pooled<Fn_get_value_unique<Tag_psql,std::tuple<int>,std::tuple<int>,false> > fn(pool, "select count(*) from t where i>$1");
+	//int n = fn(42); //checkout, run on this connection, give back
+	//
+	//Fn_type is any Fn_xxx<Tag_t,Return_tt,Bind_tt,Multi_thread> constructible from (connection, sql),
+	//Multi_thread=false is enough : a leased connection is used by one thread at a time.
+	namespace impl{
+		template<typename Fn_type> struct Fn_tag;
+
+		template<template<typename,typename,typename,bool> class Fn_tt, typename Tag_t, typename Return_tt, typename Bind_tt, bool Multi_thread>
+		struct Fn_tag<Fn_tt<Tag_t,Return_tt,Bind_tt,Multi_thread> >{typedef Tag_t type;};
+	}
+
+	template<typename Fn_type>
+	struct Pooled{
+		typedef typename impl::Fn_tag<Fn_type>::type Tag_t;
+
+		Pooled(Pool<Tag_t> &pool_, const std::string &sql_):pool(pool_),sql(sql_){}
+
+		template<typename... A>
+		auto operator()(A&&... a){
+			Pool_lease<Tag_t> c = pool.checkout();
+			return c.template prepared<Fn_type>(sql)(std::forward<A>(a)...);
+		}
+
+		private:
+		Pool<Tag_t> &pool;
+		std::string sql;
+	};
+
+
+
+	//--- Rw_pool : one writer, N readers ---
+	//The writer is connected first (ex : it can switch a sqlite database to WAL before the readers open it).
+	template<typename Tag_t>
+	struct Rw_pool{
+		typedef typename Pool<Tag_t>::Make_connection_t Make_connection_t;
+
+		Rw_pool(Make_connection_t make_writer, Make_connection_t make_reader, size_t nb_readers, const Pool_options &options=Pool_options()):
+			writer (std::move(make_writer), with_size(options,1)),
+			readers(std::move(make_reader), with_size(options,nb_readers))
+		{}
+
+		Pool_lease<Tag_t> write(){return writer .checkout();}
+		Pool_lease<Tag_t> read() {return readers.checkout();}
+
+		Pool<Tag_t> writer;  //declared first : connected first
+		Pool<Tag_t> readers;
+
+		private:
+		static Pool_options with_size(Pool_options o, size_t n){o.size=n; return o;}
+	};
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_TDB_POOL_HPP_ */
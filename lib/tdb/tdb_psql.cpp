@@ -1,6 +1,14 @@
 #include "tdb_psql.hpp"
 //#include <catalog/pg_type.h> //-I/usr/include/pgsql/server/
 #include <limits.h>  //CHAR_BIT
+#include <cstdio>    //snprintf
+#include <cstdlib>   //atoll
+#include <ctime>
+#include <cassert>
+#include <cctype>    //toupper
+#include <cstring>   //memchr
+#include <strings.h> //strncasecmp
+#include <string_view>
 
 
 //===============
@@ -9,6 +17,7 @@
 
 void tdb::Connection_t<tdb::Tag_psql>::disconnect(){
 	if(native_connection!=nullptr){
+		query_cache.clear(); //DEALLOCATE cached queries while the connection is alive
 		PQfinish(native_connection);
 		native_connection = nullptr;
 	}
@@ -39,6 +48,7 @@ std::string psql_param(const std::string &s){
 
 void tdb::Connection_t<tdb::Tag_psql>::connect(const std::string &conninfo){
 	if(native_connection!=nullptr){
+		query_cache.clear();
 		PQfinish(native_connection);
 	}
 	native_connection=PQconnectdb(conninfo.c_str());
@@ -73,6 +83,210 @@ void tdb::Connection_t<tdb::Tag_psql>::connect(
 }
 
 
+void tdb::Connection_t<tdb::Tag_psql>::set_default_format(int f){
+	if(f!=psql::FORMAT_TEXT and f!=psql::FORMAT_BINARY){
+		throw tdb::Exception_t<tdb::Tag_psql>("Invalid psql format, format="+std::to_string(f));
+	}
+	if(f==native_default_format){return;}
+	query_cache.clear(); //cached queries were prepared with the old format
+	native_default_format=f;
+}
+
+void tdb::Connection_t<tdb::Tag_psql>::set_default_chunk_size(int n){
+	if(n<0){throw tdb::Exception_t<tdb::Tag_psql>("Invalid psql chunk size : "+std::to_string(n));}
+	native_default_chunk_size=n;
+}
+
+
+
+//===================
+//=== extra types ===
+//===================
+
+namespace{
+	int hex_value(char c){
+		if(c>='0' and c<='9'){return c-'0';}
+		if(c>='a' and c<='f'){return c-'a'+10;}
+		if(c>='A' and c<='F'){return c-'A'+10;}
+		return -1;
+	}
+
+	const char hex_digits[] = "0123456789abcdef";
+
+	//days since 1970-01-01 <=> civil date, see http://howardhinnant.github.io/date_algorithms.html
+	std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d){
+		y -= m <= 2;
+		const std::int64_t era = (y >= 0 ? y : y-399) / 400;
+		const unsigned yoe = static_cast<unsigned>(y - era * 400);
+		const unsigned doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;
+		const unsigned doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+		return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+	}
+
+	void civil_from_days(std::int64_t z, std::int64_t &y, unsigned &m, unsigned &d){
+		z += 719468;
+		const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+		const unsigned doe = static_cast<unsigned>(z - era * 146097);
+		const unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+		y = static_cast<std::int64_t>(yoe) + era * 400;
+		const unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+		const unsigned mp = (5*doy + 2)/153;
+		d = doy - (153*mp+2)/5 + 1;
+		m = mp < 10 ? mp+3 : mp-9;
+		y += (m <= 2);
+	}
+}
+
+
+//bytea : hex format, i.e., \x0123abcd
+std::string tdb::psql::bytea_to_text(const Bytea &b){
+	std::string r = "\\x";
+	r.reserve(2+2*b.size());
+	for(const std::byte &c : b){
+		const unsigned u = std::to_integer<unsigned>(c);
+		r+=hex_digits[u>>4];
+		r+=hex_digits[u&0xf];
+	}
+	return r;
+}
+
+tdb::psql::Bytea tdb::psql::bytea_from_text(const std::string &s){
+	//only the hex format is supported (default since psql 9.0, see bytea_output)
+	if(s.size()<2 or s[0]!='\\' or s[1]!='x' or s.size()%2!=0){
+		throw Exception_t<Tag_psql>("Cannot read bytea, expected hex format, value="+s);
+	}
+	Bytea r;
+	r.reserve( (s.size()-2)/2 );
+	for(size_t i = 2; i < s.size(); i+=2){
+		const int h = hex_value(s[i]);
+		const int l = hex_value(s[i+1]);
+		if(h<0 or l<0){throw Exception_t<Tag_psql>("Cannot read bytea, invalid hex digit, value="+s);}
+		r.push_back(static_cast<std::byte>(h*16+l));
+	}
+	return r;
+}
+
+
+//timestamp : ISO 8601, UTC, microseconds
+std::string tdb::psql::timestamp_to_text(const Timestamp &t){
+	if(t==Timestamp::max()){return "infinity";}
+	if(t==Timestamp::min()){return "-infinity";}
+
+	const std::int64_t us   = std::chrono::floor<std::chrono::microseconds>(t.time_since_epoch()).count();
+	const std::int64_t day_us = 86400LL*1000000LL;
+	std::int64_t days = us / day_us;
+	std::int64_t rem  = us % day_us;
+	if(rem<0){rem+=day_us; --days;}
+
+	std::int64_t y; unsigned m; unsigned d;
+	civil_from_days(days,y,m,d);
+	if(y<1){throw Exception_t<Tag_psql>("Cannot write timestamp before year 1");}
+
+	const std::int64_t sec = rem/1000000;
+	char buf[64];
+	std::snprintf(buf,sizeof(buf),"%04lld-%02u-%02u %02lld:%02lld:%02lld.%06lld+00",
+		static_cast<long long>(y), m, d,
+		static_cast<long long>(sec/3600), static_cast<long long>((sec/60)%60), static_cast<long long>(sec%60),
+		static_cast<long long>(rem%1000000)
+	);
+	return buf;
+}
+
+tdb::psql::Timestamp tdb::psql::timestamp_from_text(const std::string &s){
+	if(s=="infinity") {return Timestamp::max();}
+	if(s=="-infinity"){return Timestamp::min();}
+
+	//YYYY-MM-DD HH:MM:SS[.ffffff][+HH[:MM[:SS]]] (BC dates are not supported)
+	auto fail=[&s]()->Timestamp{throw Exception_t<Tag_psql>("Cannot read timestamp, value="+s);};
+
+	size_t i = 0;
+	auto read_int=[&](size_t min_digits, size_t max_digits, std::int64_t &write_here)->bool{
+		const size_t start = i;
+		write_here=0;
+		while(i<s.size() and i-start<max_digits and s[i]>='0' and s[i]<='9'){write_here = write_here*10+(s[i]-'0'); ++i;}
+		return i-start>=min_digits;
+	};
+	auto read_char=[&](char c)->bool{
+		if(i<s.size() and s[i]==c){++i; return true;}
+		return false;
+	};
+
+	std::int64_t y,mo,d,h,mi,sec;
+	if(!read_int(4,9,y) or !read_char('-') or !read_int(2,2,mo) or !read_char('-') or !read_int(2,2,d)){return fail();}
+	if(!read_char(' ') and !read_char('T')){return fail();}
+	if(!read_int(2,2,h) or !read_char(':') or !read_int(2,2,mi) or !read_char(':') or !read_int(2,2,sec)){return fail();}
+	if(mo<1 or mo>12 or d<1 or d>31 or h>24 or mi>59 or sec>60){return fail();}
+
+	std::int64_t frac_us = 0;
+	if(read_char('.')){
+		const size_t start = i;
+		std::int64_t f;
+		if(!read_int(1,6,f)){return fail();}
+		for(size_t n=i-start; n<6; ++n){f*=10;}
+		frac_us = f;
+		while(i<s.size() and s[i]>='0' and s[i]<='9'){++i;} //truncate beyond microseconds
+	}
+
+	std::int64_t offset_s = 0;
+	if(i<s.size()){
+		int sign;
+		if     (read_char('+')){sign= 1;}
+		else if(read_char('-')){sign=-1;}
+		else if(read_char('Z')){sign= 0;}
+		else{return fail();}
+		if(sign!=0){
+			std::int64_t oh,om=0,os=0;
+			if(!read_int(2,2,oh)){return fail();}
+			if(read_char(':')){
+				if(!read_int(2,2,om)){return fail();}
+				if(read_char(':') and !read_int(2,2,os)){return fail();}
+			}
+			offset_s = sign*(oh*3600+om*60+os);
+		}
+	}
+	if(i!=s.size()){return fail();}
+
+	const std::int64_t days = days_from_civil(y,static_cast<unsigned>(mo),static_cast<unsigned>(d));
+	const std::int64_t unix_s = days*86400 + h*3600 + mi*60 + sec - offset_s;
+	const std::chrono::microseconds us = std::chrono::seconds(unix_s) + std::chrono::microseconds(frac_us);
+	if( us > std::chrono::duration_cast<std::chrono::microseconds>(Timestamp::duration::max()) or us < std::chrono::duration_cast<std::chrono::microseconds>(Timestamp::duration::min()) ){
+		throw Exception_t<Tag_psql>("timestamp out of the range of std::chrono::system_clock, value="+s);
+	}
+	return Timestamp(std::chrono::duration_cast<Timestamp::duration>(us));
+}
+
+
+//uuid : 8-4-4-4-12 hex digits
+std::string tdb::psql::uuid_to_text(const Uuid &u){
+	std::string r;
+	r.reserve(36);
+	for(size_t i = 0; i < 16; ++i){
+		if(i==4 or i==6 or i==8 or i==10){r+='-';}
+		r+=hex_digits[u.bytes[i]>>4];
+		r+=hex_digits[u.bytes[i]&0xf];
+	}
+	return r;
+}
+
+tdb::psql::Uuid tdb::psql::uuid_from_text(const std::string &s){
+	//psql also accepts braces and missing hyphens as input, but always outputs this format
+	Uuid r;
+	size_t b = 0;
+	for(size_t i = 0; i < s.size(); ++i){
+		if(s[i]=='-' and (i==8 or i==13 or i==18 or i==23)){continue;}
+		if(b==16 or i+1>=s.size()){b=17; break;}
+		const int h = hex_value(s[i]);
+		const int l = hex_value(s[i+1]);
+		if(h<0 or l<0){b=17; break;}
+		r.bytes[b++]=static_cast<unsigned char>(h*16+l);
+		++i;
+	}
+	if(b!=16 or s.size()!=36){throw Exception_t<Tag_psql>("Cannot read uuid, value="+s);}
+	return r;
+}
+
+
+
 //=============
 //=== Query_t ===
 //=============
@@ -257,6 +471,777 @@ MK_OID_T( duration_t ,TINTERVALOID);
 
 
 
+//=======================
+//=== execute, insert ===
+//=======================
+
+void tdb::psql::execute_result(PGresult *res, const std::string &sql){
+	if (PQresultStatus(res) != PGRES_COMMAND_OK){
+		std::string msg = "Error in Execute_t: " + result_error(res);
+		PQclear(res);
+		throw Exception_t<tdb::Tag_psql>(msg + "\n  sql: " + sql );
+	}
+	PQclear(res);
+}
+
+
+tdb::Rowid<tdb::Tag_psql> tdb::psql::insert_result(PGresult *res, int result_format, const std::string &sql){
+	const int status = PQresultStatus(res);
+	const bool ok = (status==PGRES_COMMAND_OK)or(status==PGRES_TUPLES_OK) ;
+	if (!ok){
+		std::string msg = "Error in Insert_t: " + result_error(res);
+		PQclear(res);
+		throw Exception_t<tdb::Tag_psql>(msg+ "\n  sql: " + sql );
+	}
+
+	//nothing was inserted : return 0
+	const int nb_rows = PQntuples(res);
+	if(nb_rows==0){PQclear(res); return 0;}
+
+	std::tuple<Rowid<tdb::Tag_psql>> write_here;
+	try{
+		impl::BindInfo_r<1>::template run_from_db<  std::tuple<Rowid<tdb::Tag_psql>>  > (
+				write_here,
+				res,
+				nb_rows-1, //last row
+				result_format
+		);
+	}catch(...){
+		PQclear(res);
+		throw;
+	}
+
+	PQclear(res);
+	return std::get<0>(write_here) ;
+}
+
+
+
+
+//=========================
+//=== streaming results ===
+//=========================
+//doc : https://www.postgresql.org/docs/current/libpq-single-row-mode.html
+
+void tdb::psql::stream_set_mode(PGconn *c, int chunk_size){
+	assert(chunk_size>0);
+	#ifdef LIBPQ_HAS_CHUNK_MODE
+	const int ok = chunk_size==1 ? PQsetSingleRowMode(c) : PQsetChunkedRowsMode(c,chunk_size);
+	#else
+	const int ok = PQsetSingleRowMode(c); //no chunked mode before libpq 17
+	#endif
+
+	if(!ok){
+		PGconn *tmp = c;
+		stream_cancel(tmp);
+		throw Exception_t<Tag_psql>("Cannot set psql single row / chunked rows mode");
+	}
+}
+
+
+void tdb::psql::stream_next(PGconn *&c, PGresult *&res){
+	assert(c!=nullptr);
+	PQclear(res);
+	res = PQgetResult(c);
+
+	const ExecStatusType status = PQresultStatus(res);
+	bool more = status==PGRES_SINGLE_TUPLE;
+	#ifdef LIBPQ_HAS_CHUNK_MODE
+	more = more or status==PGRES_TUPLES_CHUNK;
+	#endif
+	if(more){return;}
+
+	//last result : PGRES_TUPLES_OK (no rows), PGRES_COMMAND_OK or an error.
+	//PQgetResult must then be called until it returns nullptr
+	while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+	c=nullptr;
+
+	if(status==PGRES_TUPLES_OK or status==PGRES_COMMAND_OK){return;}
+
+	std::string msg = "Error in streaming result: " + result_error(res);
+	PQclear(res);
+	res=nullptr;
+	throw Exception_t<Tag_psql>(msg);
+}
+
+
+void tdb::psql::stream_cancel(PGconn *&c)noexcept(true){
+	if(c==nullptr){return;}
+
+	//ask the server to stop sending rows (may fail if the query is already done)
+	if(PGcancel *cancel = PQgetCancel(c)){
+		char err[256];
+		PQcancel(cancel,err,sizeof(err));
+		PQfreeCancel(cancel);
+	}
+
+	//discard what was already sent
+	while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+	c=nullptr;
+}
+
+
+
+
+//================
+//=== pipeline ===
+//================
+//doc : https://www.postgresql.org/docs/current/libpq-pipeline-mode.html
+#ifdef LIBPQ_HAS_PIPELINING
+
+tdb::psql::Pipeline_t::Pipeline_t(Connection_t<Tag_psql> &c):db(c){
+	if(!PQenterPipelineMode(db.native_connection)){
+		throw Exception_t<Tag_psql>("Cannot enter pipeline mode, error="+std::string(PQerrorMessage(db.native_connection)));
+	}
+}
+
+
+tdb::psql::Pipeline_t::~Pipeline_t(){
+	try{
+		discard();
+	}catch(...){}
+	PQexitPipelineMode(db.native_connection);
+}
+
+
+void tdb::psql::Pipeline_t::discard(){
+	if(queued.empty()){return;}
+
+	//outside of an explicit transaction, the statements queued since the last sync point run in an
+	//implicit transaction : ROLLBACK undoes them (the server logs a "no transaction in progress" WARNING).
+	//Inside an explicit transaction, ROLLBACK ends it.
+	const int sent = PQsendQueryParams(db.native_connection, "ROLLBACK", 0, nullptr, nullptr, nullptr, nullptr, FORMAT_TEXT);
+	if(!sent){
+		throw Exception_t<Tag_psql>("Cannot discard pipeline, error="+std::string(PQerrorMessage(db.native_connection)));
+	}
+	queued.push_back(Entry{false,FORMAT_TEXT});
+	read_sync_point(true);
+}
+
+
+std::vector<tdb::psql::Pipeline_status> tdb::psql::Pipeline_t::sync(){
+	return read_sync_point(false);
+}
+
+
+//read and drop the results up to the sync point, so that the pipeline can be used again
+void tdb::psql::Pipeline_t::drain(){
+	bool previous_null = false;
+	for(;;){
+		PGresult *res = PQgetResult(db.native_connection);
+		if(res==nullptr){
+			if(previous_null or PQstatus(db.native_connection)!=CONNECTION_OK){return;} //nothing more to read
+			previous_null = true;
+			continue;
+		}
+		previous_null = false;
+		const bool synced = PQresultStatus(res)==PGRES_PIPELINE_SYNC;
+		PQclear(res);
+		if(synced){return;}
+	}
+}
+
+
+std::vector<tdb::psql::Pipeline_status> tdb::psql::Pipeline_t::read_sync_point(bool discarded){
+	std::vector<Pipeline_status> r;
+	if(queued.empty()){return r;}
+
+	if(!PQpipelineSync(db.native_connection)){
+		throw Exception_t<Tag_psql>("Cannot sync pipeline, error="+std::string(PQerrorMessage(db.native_connection)));
+	}
+
+	std::vector<Entry> entries;
+	std::swap(entries,queued);
+	r.resize(entries.size());
+
+	//one result per statement, each one is followed by a nullptr
+	std::string error;        //the results cannot be read
+	bool rolled_back = discarded; //a statement failed : the implicit transaction is rolled back
+	for(size_t i = 0; i < entries.size(); ++i){
+		PGresult *res = PQgetResult(db.native_connection);
+		if(res==nullptr){
+			error = "Pipeline : missing result, error="+std::string(PQerrorMessage(db.native_connection));
+			break;
+		}
+
+		Pipeline_status &s = r[i];
+		const ExecStatusType status = PQresultStatus(res);
+		if(status==PGRES_COMMAND_OK or status==PGRES_TUPLES_OK){
+			s.ok = true;
+			const char *n = PQcmdTuples(res);
+			s.affected_rows = (n!=nullptr and n[0]!='\0') ? std::atoll(n) : 0;
+
+			const int nb_rows = PQntuples(res);
+			if(entries[i].read_rowid and nb_rows>0){
+				try{
+					std::tuple<Rowid<Tag_psql>> write_here;
+					impl::BindInfo_r<1>::template run_from_db< std::tuple<Rowid<Tag_psql>> >(write_here, res, nb_rows-1, entries[i].result_format);
+					s.rowid = std::get<0>(write_here);
+				}catch(std::exception &e){
+					s.ok    = false;
+					s.error = e.what();
+				}
+			}
+		}else if(status==PGRES_PIPELINE_ABORTED){
+			s.error = "Aborted : a previous statement of the pipeline failed";
+			rolled_back = true;
+		}else{
+			s.error = "Error in pipeline: " + result_error(res);
+			rolled_back = true;
+		}
+		PQclear(res);
+
+		while(PGresult *tmp = PQgetResult(db.native_connection)){PQclear(tmp);}
+	}
+
+	//end of the sync point
+	if(error.empty()){
+		PGresult *res = PQgetResult(db.native_connection);
+		const bool synced = PQresultStatus(res)==PGRES_PIPELINE_SYNC;
+		PQclear(res);
+		if(!synced){error = "Pipeline : cannot read the sync point, error="+std::string(PQerrorMessage(db.native_connection));}
+	}
+	if(!error.empty()){
+		drain();
+		throw Exception_t<Tag_psql>(error);
+	}
+
+	//the statements that ran before the failure are rolled back with it
+	if(rolled_back){
+		for(Pipeline_status &s : r){
+			if(!s.ok){continue;}
+			s.ok    = false;
+			s.error = discarded ? "Rolled back : discard()" : "Rolled back : another statement of the same sync() failed";
+		}
+	}
+
+	return r;
+}
+
+#endif
+
+
+
+
+//===============
+//=== copy in ===
+//===============
+//doc : https://www.postgresql.org/docs/current/libpq-copy.html
+
+void tdb::psql::impl::copy_in_start(PGconn *c, const std::string &sql){
+	PGresult *res = PQexec(c, sql.c_str());
+	if(PQresultStatus(res)!=PGRES_COPY_IN){
+		std::string msg = "Cannot start COPY: " + result_error(res);
+		PQclear(res);
+		while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+		throw Exception_t<Tag_psql>(msg+"\n  sql: "+sql);
+	}
+	PQclear(res);
+}
+
+
+void tdb::psql::impl::copy_in_put(PGconn *c, std::string &buffer){
+	if(buffer.empty()){return;}
+	if(buffer.size() > static_cast<size_t>(std::numeric_limits<int>::max())){
+		throw Exception_t<Tag_psql>("Copy_in_t : buffer too large");
+	}
+	if(PQputCopyData(c, buffer.data(), static_cast<int>(buffer.size()))!=1){
+		throw Exception_t<Tag_psql>("Copy_in_t : cannot send data, error="+std::string(PQerrorMessage(c)));
+	}
+	buffer.clear();
+}
+
+
+long long tdb::psql::impl::copy_in_end(PGconn *c, const char *error_msg){
+	const bool ended = PQputCopyEnd(c, error_msg)==1;
+
+	//the COPY result, then nullptr
+	PGresult *res = PQgetResult(c);
+	const bool ok = ended and error_msg==nullptr and PQresultStatus(res)==PGRES_COMMAND_OK;
+
+	long long r = 0;
+	std::string msg;
+	if(ok){
+		const char *n = PQcmdTuples(res);
+		r = (n!=nullptr and n[0]!='\0') ? std::atoll(n) : 0;
+	}else if(error_msg==nullptr){
+		msg = ended ? result_error(res) : std::string(PQerrorMessage(c));
+	}
+	PQclear(res);
+	while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+
+	if(!ok and error_msg==nullptr){throw Exception_t<Tag_psql>("Error in COPY: "+msg);}
+	return r;
+}
+
+
+
+
+//===============
+//=== scripts ===
+//===============
+//doc : https://www.postgresql.org/docs/current/sql-syntax-lexical.html
+
+namespace{
+	bool is_ident_char(char c){
+		return (c>='a' and c<='z') or (c>='A' and c<='Z') or (c>='0' and c<='9') or c=='_' or c=='$' or static_cast<unsigned char>(c)>=128;
+	}
+
+	//skip a -- or /* */ comment starting at p, return p if there is none.
+	//nullptr : the comment is not complete
+	const char* skip_comment(const char *p, const char *end){
+		if(end-p>=2 and p[0]=='-' and p[1]=='-'){
+			const char *eol = static_cast<const char*>(std::memchr(p,'\n',static_cast<size_t>(end-p)));
+			return eol==nullptr ? nullptr : eol+1;
+		}
+		if(end-p>=2 and p[0]=='/' and p[1]=='*'){
+			int depth = 0; //psql comments are nested
+			while(p<end){
+				if(end-p>=2 and p[0]=='/' and p[1]=='*'){++depth; p+=2; continue;}
+				if(end-p>=2 and p[0]=='*' and p[1]=='/'){--depth; p+=2; if(depth==0){return p;} continue;}
+				++p;
+			}
+			return nullptr;
+		}
+		return p;
+	}
+
+	//skip spaces and comments
+	const char* skip_blank(const char *p, const char *end){
+		while(p<end){
+			if(std::isspace(static_cast<unsigned char>(*p))){++p; continue;}
+			const char *q = skip_comment(p,end);
+			if(q==nullptr){return end;} //unfinished comment : blank
+			if(q==p){return p;}
+			p = q;
+		}
+		return p;
+	}
+
+	//COPY ... FROM stdin
+	bool is_copy_from_stdin(const char *begin, const char *end){
+		const char *p = skip_blank(begin,end);
+		if(end-p<5 or strncasecmp(p,"COPY",4)!=0 or is_ident_char(p[4])){return false;}
+
+		std::string s(p,end);
+		for(char &c : s){c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));}
+		const size_t from = s.rfind("FROM");
+		if(from==std::string::npos){return false;}
+		const char *q = skip_blank(s.data()+from+4, s.data()+s.size());
+		return static_cast<size_t>(s.data()+s.size()-q)>=5 and std::strncmp(q,"STDIN",5)==0 and !is_ident_char(q[5]);
+	}
+
+	//statements sent in a pipeline, results read by sync()
+	struct Psql_script{
+		Psql_script(PGconn *c_, const tdb::Script_options &o, tdb::Script_progress &progress_):
+			c(c_),batch_size(std::max<size_t>(o.batch_size,1)),progress(progress_){}
+
+		void send(const std::string &sql){
+			#ifdef LIBPQ_HAS_PIPELINING
+			if(batch_size>1){
+				if(!in_pipeline){
+					if(!PQenterPipelineMode(c)){throw tdb::Exception_t<tdb::Tag_psql>("Cannot enter pipeline mode, error="+std::string(PQerrorMessage(c)));}
+					in_pipeline = true;
+				}
+				if(!PQsendQueryParams(c, sql.c_str(), 0, nullptr, nullptr, nullptr, nullptr, tdb::psql::FORMAT_TEXT)){
+					throw tdb::Exception_t<tdb::Tag_psql>("Cannot queue query in pipeline\n error:\n"+std::string(PQerrorMessage(c))+"\n  sql: " + excerpt(sql));
+				}
+				queued.push_back(excerpt(sql));
+				if(queued.size()>=batch_size){sync();}
+				return;
+			}
+			#endif
+
+			//one round trip per statement
+			exec(sql);
+			++progress.nb_statements;
+		}
+
+		//run now, outside of the pipeline
+		void exec(const std::string &sql){
+			PGresult *res = PQexec(c, sql.c_str());
+			if(!is_ok(res)){
+				std::string msg = error_msg(progress.nb_statements+1, tdb::psql::result_error(res), excerpt(sql));
+				PQclear(res);
+				throw tdb::Exception_t<tdb::Tag_psql>(msg);
+			}
+			PQclear(res);
+		}
+
+		//wait for the results of the queued statements, leave pipeline mode
+		void sync(){
+			#ifdef LIBPQ_HAS_PIPELINING
+			if(!in_pipeline){return;}
+			if(!queued.empty()){
+				if(!PQpipelineSync(c)){throw tdb::Exception_t<tdb::Tag_psql>("Cannot sync pipeline, error="+std::string(PQerrorMessage(c)));}
+
+				std::vector<std::string> sent;
+				std::swap(sent,queued);
+				std::string error;
+				for(size_t i = 0; i < sent.size(); ++i){
+					PGresult *res = PQgetResult(c);
+					if(res==nullptr){throw tdb::Exception_t<tdb::Tag_psql>("Pipeline : missing result, error="+std::string(PQerrorMessage(c)));}
+					if(error.empty() and !is_ok(res) and PQresultStatus(res)!=PGRES_PIPELINE_ABORTED){
+						error = error_msg(progress.nb_statements+i+1, tdb::psql::result_error(res), sent[i]);
+					}
+					PQclear(res);
+					while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+				}
+
+				PGresult *res = PQgetResult(c);
+				const bool synced = PQresultStatus(res)==PGRES_PIPELINE_SYNC;
+				PQclear(res);
+				if(!synced){throw tdb::Exception_t<tdb::Tag_psql>("Pipeline : cannot read the sync point, error="+std::string(PQerrorMessage(c)));}
+				if(!error.empty()){throw tdb::Exception_t<tdb::Tag_psql>(error);}
+				progress.nb_statements += sent.size();
+			}
+			if(!PQexitPipelineMode(c)){throw tdb::Exception_t<tdb::Tag_psql>("Cannot exit pipeline mode, error="+std::string(PQerrorMessage(c)));}
+			in_pipeline = false;
+			#endif
+		}
+
+		//on errors : discard what is pending, leave pipeline mode
+		void abort()noexcept(true){
+			#ifdef LIBPQ_HAS_PIPELINING
+			if(!in_pipeline){return;}
+			if(!queued.empty() and PQpipelineSync(c)){
+				size_t nb_null = 0;
+				while(nb_null <= queued.size()+1){
+					PGresult *res = PQgetResult(c);
+					if(res==nullptr){++nb_null; continue;}
+					const bool synced = PQresultStatus(res)==PGRES_PIPELINE_SYNC;
+					PQclear(res);
+					if(synced){break;}
+				}
+			}
+			queued.clear();
+			PQexitPipelineMode(c);
+			in_pipeline = false;
+			#endif
+		}
+
+		static bool is_ok(const PGresult *res){
+			const ExecStatusType s = PQresultStatus(res);
+			return s==PGRES_COMMAND_OK or s==PGRES_TUPLES_OK or s==PGRES_EMPTY_QUERY;
+		}
+
+		static std::string excerpt(const std::string &sql){
+			static constexpr size_t max_size = 200;
+			return sql.size()<=max_size ? sql : sql.substr(0,max_size)+"...";
+		}
+
+		static std::string error_msg(size_t statement, const std::string &error, const std::string &sql){
+			return "Error in psql script, statement="+std::to_string(statement)+": "+error+"\n  sql: "+sql;
+		}
+
+		PGconn *c;
+		size_t batch_size;
+		tdb::Script_progress &progress;
+		bool in_pipeline = false;
+		std::vector<std::string> queued; //excerpts of the statements waiting for their result
+	};
+}
+
+
+size_t tdb::psql::impl::script_statement_length(const char *begin, const char *end){
+	const char *p = begin;
+	while(p<end){
+		const char c = *p;
+
+		//comments
+		const char *q = skip_comment(p,end);
+		if(q==nullptr){return 0;}
+		if(q!=p){p=q; continue;}
+
+		//'string', E'string' (backslash escapes), "identifier" ('' and "" are escaped quotes)
+		if(c=='\'' or c=='"'){
+			const bool backslash = c=='\'' and p>begin and (p[-1]=='E' or p[-1]=='e') and (p-1==begin or !is_ident_char(p[-2]));
+			++p;
+			while(true){
+				if(p>=end){return 0;}
+				if(backslash and *p=='\\'){p+=2; continue;}
+				if(*p==c){
+					if(p+1>=end){return 0;}        //maybe an escaped quote : need more
+					if(p[1]==c){p+=2; continue;}
+					++p;
+					break;
+				}
+				++p;
+			}
+			continue;
+		}
+
+		//$tag$ dollar quoted string $tag$ ($1 is a parameter)
+		if(c=='$' and (p==begin or !is_ident_char(p[-1]))){
+			const char *t = p+1;
+			while(t<end and is_ident_char(*t) and *t!='$'){++t;}
+			if(t>=end){return 0;}
+			const bool is_tag = *t=='$' and (t==p+1 or !(p[1]>='0' and p[1]<='9'));
+			if(is_tag){
+				const std::string_view tag(p, static_cast<size_t>(t+1-p));
+				const std::string_view rest(t+1, static_cast<size_t>(end-t-1));
+				const size_t close = rest.find(tag);
+				if(close==std::string_view::npos){return 0;}
+				p = t+1+close+tag.size();
+				continue;
+			}
+		}
+
+		if(c==';'){return static_cast<size_t>(p+1-begin);}
+		++p;
+	}
+	return 0;
+}
+
+
+void tdb::Read_Istream_t<tdb::Tag_psql>::run(Connection_t<Tag_psql> &db, std::istream &in, const Script_options &o){
+	PGconn *c = db.native_connection;
+	impl::Script_buffer b(in,o);
+	Psql_script script(c,o,b.progress);
+
+	//COPY FROM stdin data : lines up to "\."
+	bool        in_copy  = false;
+	bool        copy_eol = false; //skip the end of the COPY line
+	std::string copy_buffer;
+
+	try{
+		if(o.single_transaction){script.exec("BEGIN");}
+
+		while(true){
+			b.read();
+			const char *data = b.data.data();
+			const char *end  = data+b.data.size();
+			const char *p    = data;
+
+			while(p<end){
+				if(in_copy){
+					const char *eol = static_cast<const char*>(std::memchr(p,'\n',static_cast<size_t>(end-p)));
+					if(eol==nullptr and !b.eof){break;} //need more
+					const char *next = eol==nullptr ? end : eol+1;
+
+					if(copy_eol){copy_eol=false; p=next; continue;}
+
+					std::string_view line(p, static_cast<size_t>(next-p));
+					while(!line.empty() and (line.back()=='\n' or line.back()=='\r')){line.remove_suffix(1);}
+					if(line=="\\."){
+						psql::impl::copy_in_put(c,copy_buffer);
+						psql::impl::copy_in_end(c,nullptr);
+						++b.progress.nb_statements;
+						in_copy = false;
+					}else{
+						copy_buffer.append(p,next);
+						if(copy_buffer.size()>=b.chunk_size){psql::impl::copy_in_put(c,copy_buffer);}
+					}
+					p = next;
+					continue;
+				}
+
+				size_t n = psql::impl::script_statement_length(p,end);
+				if(n==0){
+					if(!b.eof){break;}           //need more
+					n = static_cast<size_t>(end-p); //last statement, without ';'
+				}
+				const char *statement_end = p+n;
+
+				if(skip_blank(p,statement_end)!=statement_end){
+					if(is_copy_from_stdin(p,statement_end)){
+						script.sync(); //COPY is not allowed in pipeline mode
+						psql::impl::copy_in_start(c, std::string(p,statement_end));
+						in_copy  = true;
+						copy_eol = true;
+					}else{
+						script.send(std::string(p,statement_end));
+					}
+				}
+				p = statement_end;
+			}
+
+			b.consume(static_cast<size_t>(p-data));
+			if(o.progress){o.progress(b.progress);}
+			if(b.eof){break;} //everything is consumed
+		}
+
+		if(in_copy){throw Exception_t<Tag_psql>("psql script : the data of COPY FROM stdin does not end with \\.");}
+		script.sync();
+		if(o.single_transaction){script.exec("COMMIT");}
+		if(o.progress){o.progress(b.progress);}
+
+	}catch(...){
+		if(in_copy){try{psql::impl::copy_in_end(c,"psql script aborted");}catch(...){}}
+		script.abort();
+		if(o.single_transaction){PQclear(PQexec(c,"ROLLBACK"));}
+		throw;
+	}
+}
+
+
+
+
+//================
+//=== copy out ===
+//================
+
+void tdb::psql::impl::copy_out_start(PGconn *c, const std::string &sql){
+	PGresult *res = PQexec(c, sql.c_str());
+	if(PQresultStatus(res)!=PGRES_COPY_OUT){
+		std::string msg = "Cannot start COPY: " + result_error(res);
+		PQclear(res);
+		while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+		throw Exception_t<Tag_psql>(msg+"\n  sql: "+sql);
+	}
+	PQclear(res);
+}
+
+
+bool tdb::psql::impl::copy_out_row(PGconn *&c, std::string &row){
+	assert(c!=nullptr);
+
+	//one row at a time
+	char *buffer = nullptr;
+	const int n = PQgetCopyData(c, &buffer, 0);
+	if(n>0){
+		row.assign(buffer,n);
+		PQfreemem(buffer);
+		return true;
+	}
+
+	if(n==-1){
+		//end of copy : read the COPY result, then nullptr
+		PGresult *res = PQgetResult(c);
+		const bool ok = PQresultStatus(res)==PGRES_COMMAND_OK;
+		std::string msg = ok ? "" : result_error(res);
+		PQclear(res);
+		while(PGresult *tmp = PQgetResult(c)){PQclear(tmp);}
+		c=nullptr;
+		if(!ok){throw Exception_t<Tag_psql>("Error in COPY: "+msg);}
+		return false;
+	}
+
+	std::string msg = PQerrorMessage(c);
+	copy_out_cancel(c);
+	throw Exception_t<Tag_psql>("Error in COPY: "+msg);
+}
+
+
+void tdb::psql::impl::copy_out_cancel(PGconn *&c)noexcept(true){
+	if(c==nullptr){return;}
+
+	if(PGcancel *cancel = PQgetCancel(c)){
+		char err[256];
+		PQcancel(cancel,err,sizeof(err));
+		PQfreeCancel(cancel);
+	}
+
+	//discard what was already sent
+	char *buffer = nullptr;
+	while(PQgetCopyData(c, &buffer, 0)>0){PQfreemem(buffer);}
+	while(PGresult *tmp = PQgetResult(c)){
+		const ExecStatusType status = PQresultStatus(tmp);
+		PQclear(tmp);
+		if(status==PGRES_COPY_OUT or status==PGRES_COPY_IN){break;} //broken connection, don't loop forever
+	}
+	c=nullptr;
+}
+
+
+void tdb::psql::impl::copy_out_split_text(const std::string &row, std::vector<std::optional<std::string>> &fields){
+	//doc : https://www.postgresql.org/docs/current/sql-copy.html (text format)
+	fields.clear();
+	size_t end = row.size();
+	if(end>0 and row[end-1]=='\n'){--end;}
+
+	size_t i = 0;
+	while(true){
+		//find the end of the field
+		size_t j = i;
+		while(j<end and row[j]!='\t'){++j;}
+
+		if(j-i==2 and row[i]=='\\' and row[i+1]=='N'){
+			fields.emplace_back(); //NULL
+		}else{
+			std::string &f = fields.emplace_back(std::in_place).value();
+			f.reserve(j-i);
+			for(size_t k = i; k < j; ++k){
+				if(row[k]!='\\' or k+1==j){f+=row[k]; continue;}
+				const char e = row[++k];
+				switch(e){
+				case 'b': f+='\b'; break;
+				case 'f': f+='\f'; break;
+				case 'n': f+='\n'; break;
+				case 'r': f+='\r'; break;
+				case 't': f+='\t'; break;
+				case 'v': f+='\v'; break;
+				case 'x':{ //\xh or \xhh
+					int v = 0; size_t n = 0;
+					while(n<2 and k+1<j and hex_value(row[k+1])>=0){v=v*16+hex_value(row[++k]); ++n;}
+					if(n==0){f+='x';}else{f+=static_cast<char>(v);}
+					break;
+				}
+				default:
+					if(e>='0' and e<='7'){ //\d, \dd or \ddd (octal)
+						int v = e-'0'; size_t n = 1;
+						while(n<3 and k+1<j and row[k+1]>='0' and row[k+1]<='7'){v=v*8+(row[++k]-'0'); ++n;}
+						f+=static_cast<char>(v);
+					}else{
+						f+=e; //\\ and any other escaped character
+					}
+				}
+			}
+		}
+
+		if(j>=end){break;}
+		i = j+1;
+	}
+}
+
+
+namespace{
+	std::uint32_t copy_get_u32(const std::string &row, size_t pos){
+		if(pos+4>row.size()){throw tdb::Exception_t<tdb::Tag_psql>("COPY binary : truncated row");}
+		return tdb::psql::impl::get_be<std::uint32_t>(row.data()+pos);
+	}
+	std::uint16_t copy_get_u16(const std::string &row, size_t pos){
+		if(pos+2>row.size()){throw tdb::Exception_t<tdb::Tag_psql>("COPY binary : truncated row");}
+		return tdb::psql::impl::get_be<std::uint16_t>(row.data()+pos);
+	}
+}
+
+bool tdb::psql::impl::copy_out_split_binary(const std::string &row, bool &header_read, std::vector<Copy_field> &fields){
+	//doc : https://www.postgresql.org/docs/current/sql-copy.html (binary format)
+	fields.clear();
+	size_t pos = 0;
+
+	//the header comes with the first row
+	if(!header_read){
+		static const char signature[] = "PGCOPY\n\377\r\n";
+		if(row.size()<19 or row.compare(0,11,std::string(signature,11))!=0){
+			throw Exception_t<Tag_psql>("COPY binary : invalid header");
+		}
+		const std::uint32_t extension = copy_get_u32(row,15);
+		pos = 19+static_cast<size_t>(extension);
+		header_read = true;
+	}
+
+	const std::int16_t n = static_cast<std::int16_t>(copy_get_u16(row,pos));
+	pos+=2;
+	if(n==-1){return false;} //trailer
+
+	for(std::int16_t i = 0; i < n; ++i){
+		const std::int32_t size = static_cast<std::int32_t>(copy_get_u32(row,pos));
+		pos+=4;
+		Copy_field &f = fields.emplace_back();
+		if(size<0){continue;} //NULL
+		if(pos+static_cast<size_t>(size)>row.size()){throw Exception_t<Tag_psql>("COPY binary : truncated row");}
+		f.data = row.data()+pos;
+		f.size = size;
+		pos+=size;
+	}
+	return true;
+}
+
+
+
+
 std::string  tdb::psql::result_error(const PGresult *res)noexcept(true){
 	//doc : https://www.postgresql.org/docs/9.1/libpq-exec.html
 
@@ -283,6 +1268,13 @@ std::string  tdb::psql::result_error(const PGresult *res)noexcept(true){
 		case ExecStatusType::PGRES_FATAL_ERROR:   {return "PGRES_FATAL_ERROR : query failed";}
 		case ExecStatusType::PGRES_COPY_BOTH:     {return "PGRES_COPY_BOTH : Copy In/Out data transfer in progress";}
 		case ExecStatusType::PGRES_SINGLE_TUPLE:  {return "PGRES_SINGLE_TUPLE :single tuple from larger resultset ";}
+		#ifdef LIBPQ_HAS_PIPELINING
+		case ExecStatusType::PGRES_PIPELINE_SYNC:   {return "PGRES_PIPELINE_SYNC : pipeline synchronization point";}
+		case ExecStatusType::PGRES_PIPELINE_ABORTED:{return "PGRES_PIPELINE_ABORTED : command didn't run because of an abort earlier in a pipeline";}
+		#endif
+		#ifdef LIBPQ_HAS_CHUNK_MODE
+		case ExecStatusType::PGRES_TUPLES_CHUNK:    {return "PGRES_TUPLES_CHUNK : chunk of tuples from larger resultset";}
+		#endif
 		}
 		return "Unknown ExecStatusType";
 	};
@@ -299,4 +1291,77 @@ std::string  tdb::psql::result_error(const PGresult *res)noexcept(true){
 
 
 
+//=================
+//=== snapshots ===
+//=================
+//doc : https://www.postgresql.org/docs/current/functions-admin.html#FUNCTIONS-SNAPSHOT-SYNCHRONIZATION
+
+namespace{
+	//returns the first value (or "")
+	std::string snapshot_exec(PGconn *c, const std::string &sql){
+		PGresult *res = PQexec(c, sql.c_str());
+		const ExecStatusType st = PQresultStatus(res);
+		if(st!=PGRES_COMMAND_OK and st!=PGRES_TUPLES_OK){
+			std::string msg = "Cannot share the psql snapshot: " + tdb::psql::result_error(res);
+			PQclear(res);
+			throw tdb::Exception_t<tdb::Tag_psql>(msg+"\n  sql: "+sql);
+		}
+		std::string r = (st==PGRES_TUPLES_OK and PQntuples(res)>0 and PQnfields(res)>0) ? PQgetvalue(res,0,0) : "";
+		PQclear(res);
+		return r;
+	}
+
+	void snapshot_rollback(const std::vector<tdb::Connection_t<tdb::Tag_psql>*> &readers, size_t n){
+		for(size_t i = n; i-- > 0; ){PQclear(PQexec(readers[i]->native_connection,"ROLLBACK"));} //readers[0] last
+	}
+}
+
+std::string tdb::psql::begin_read_same_snapshot(const std::vector<Connection_t<Tag_psql>*> &readers){
+	if(readers.empty()){return "";}
+	const char *begin = "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY";
+
+	size_t started = 0;
+	try{
+		PGconn *c0 = readers[0]->native_connection;
+		snapshot_exec(c0, begin);
+		started = 1;
+		const std::string id = snapshot_exec(c0, "select pg_export_snapshot()");
+
+		char *quoted = PQescapeLiteral(c0, id.c_str(), id.size());
+		if(quoted==nullptr){throw Exception_t<Tag_psql>(std::string("Cannot share the psql snapshot: ") + PQerrorMessage(c0));}
+		const std::string set = std::string("SET TRANSACTION SNAPSHOT ") + quoted;
+		PQfreemem(quoted);
+
+		while(started < readers.size()){
+			PGconn *c = readers[started]->native_connection;
+			snapshot_exec(c, begin);
+			++started;
+			snapshot_exec(c, set);
+		}
+		return id;
+	}catch(...){
+		snapshot_rollback(readers,started);
+		throw;
+	}
+}
+
+void tdb::psql::end_read(Connection_t<Tag_psql> &reader){
+	if(PQtransactionStatus(reader.native_connection)==PQTRANS_IDLE){return;} //no transaction
+	snapshot_exec(reader.native_connection, "COMMIT");
+}
+
+std::string tdb::psql::conninfo(const Connection_t<Tag_psql> &c){
+	PQconninfoOption *options = PQconninfo(c.native_connection);
+	if(options==nullptr){throw Exception_t<Tag_psql>("Cannot read the psql connection parameters");}
+	std::string r;
+	for(PQconninfoOption *o = options; o->keyword!=nullptr; ++o){
+		if(o->val==nullptr or o->val[0]=='\0'){continue;}
+		if(!r.empty()){r+=' ';}
+		r += std::string(o->keyword) + "='" + psql_param(o->val) + "'";
+	}
+	PQconninfoFree(options);
+	return r;
+}
+
+
 
@@ -3,8 +3,12 @@
 #include "tdb.hpp"
 
 #include <libpq-fe.h>
+#include <array>
+#include <chrono>  //timestamp
+#include <cstddef> //std::byte
 #include <cstdint> //for OID
 #include <ctime>   //for OID
+#include <vector>
 
 #include <convert/convert.hpp>
 
@@ -15,6 +19,12 @@ namespace tdb{
 	struct Tag_psql{};
 }
 
+namespace tdb::psql{
+	//exchange format, for bound parameters and for results
+	static constexpr inline int FORMAT_TEXT   = 0;
+	static constexpr inline int FORMAT_BINARY = 1;
+}
+
 //===============
 //=== connect ===
 //===============
@@ -71,8 +81,34 @@ struct tdb::Connection_t<tdb::Tag_psql>{
 	);
 	void disconnect();
 
+	//psql::FORMAT_TEXT (default) or psql::FORMAT_BINARY
+	//used by the queries prepared AFTER this call (clears query_cache)
+	//binary : parameters and results use the binary format when every type
+	//         has a binary BindInfo_t, and fallback to text otherwise.
+	void set_default_format(int f);
+	int  default_format()const{return native_default_format;}
+
+	//number of rows held in memory when fetching results, used by the queries
+	//prepared AFTER this call (see psql::set_chunk_size).
+	//0 (default) : the whole result set is fetched by get_result
+	//1           : single row mode
+	//n>1         : chunks of n rows (libpq>=17), single row mode otherwise
+	void set_default_chunk_size(int n);
+	int  default_chunk_size()const{return native_default_chunk_size;}
+
 	PGconn *   native_connection=nullptr;
 	mutable std::mutex native_connection_mutex;
+
+	//see set_observer (empty without TDB_OBSERVER)
+	[[no_unique_address]] impl::Observer_slot<Tag_psql> observer;
+
+	//prepared queries reused by execute, insert, transaction ...
+	//declared last : cached queries are destroyed first
+	Query_cache query_cache;
+
+	private:
+	int native_default_format     = psql::FORMAT_TEXT;
+	int native_default_chunk_size = 0;
 };
 
 
@@ -84,6 +120,27 @@ template<> struct tdb::Get_mutex_t<tdb::Tag_psql>{
 	}
 };
 
+//Optional: return the cache of prepared queries
+template<> struct tdb::Get_query_cache_t<tdb::Tag_psql>{
+	static constexpr bool is_implemented = true;
+	static auto & run(tdb::Connection_t<tdb::Tag_psql> &c){
+		return c.query_cache;
+	}
+};
+
+//Optional: return the observer slot (see set_observer)
+template<> struct tdb::Get_observer_t<tdb::Tag_psql>{
+	static constexpr bool is_implemented = true;
+	static auto & run(tdb::Connection_t<tdb::Tag_psql> &c){
+		return c.observer;
+	}
+};
+
+//Optional: a failed statement aborts the transaction ("current transaction is aborted")
+template<> struct tdb::Error_aborts_transaction_t<tdb::Tag_psql>{
+	static constexpr bool value = true;
+};
+
 
 //===========
 //=== SQL ===
@@ -115,15 +172,42 @@ namespace tdb::psql{
 
 	std::string  result_error(const PGresult *res)noexcept(true);
 
-	template<typename Bind_tt>
-	std::array<Oid,std::tuple_size<Bind_tt>::value> constexpr  oid();
+	//check the result of an execute (throws on error), take ownership of res
+	void execute_result(PGresult *res, const std::string &sql);
+
+	//check the result of an insert (throws on error), take ownership of res
+	//return the rowid in the last returned row, 0 if no row is returned
+	Rowid<Tag_psql> insert_result(PGresult *res, int result_format, const std::string &sql);
 
+	//--- streaming results (chunk_size!=0) ---
+	//choose single row / chunked mode, right after PQsendQueryPrepared
+	void stream_set_mode(PGconn *c, int chunk_size);
+
+	//replace res with the next chunk.
+	//the last chunk has no rows, then c is set to nullptr (end of stream)
+	//throws on errors (and ends the stream)
+	void stream_next(PGconn *&c, PGresult *&res);
+
+	//stop an unfinished stream : cancel the query and discard the remaining rows
+	void stream_cancel(PGconn *&c)noexcept(true);
+
+	//oid and format of each bound parameter
 	template<typename Bind_tt>
-	std::array<int,std::tuple_size<Bind_tt>::value> constexpr format();
+	void param_info(
+			bool binary,
+			std::array<Oid,std::tuple_size<Bind_tt>::value> &oid_here,
+			std::array<int,std::tuple_size<Bind_tt>::value> &format_here
+	);
 
-	template<typename Bind_tt,typename Return_tt, typename Bind_t2 >
+	//true if all the types in Return_tt can be fetched in binary format
+	template<typename Return_tt>
+	constexpr bool has_binary_result();
+
+	template<typename Bind_tt, typename Bind_t2 >
 	void to_db  (
 			std::array<std::string, std::tuple_size<Bind_tt>::value> &write_here,
+			std::array<int, std::tuple_size<Bind_tt>::value>         &length,
+			const std::array<int, std::tuple_size<Bind_tt>::value>   &format,
 			const Bind_t2 & bind_me
 	);
 
@@ -179,11 +263,17 @@ struct tdb::Query_t<tdb::Tag_psql,Return_tt,Bind_tt>{
 	std::array<std::string, std::tuple_size<Bind_tt>::value> paramValues;//serialize parameters here
 	std::array<int, std::tuple_size<Bind_tt>::value> paramLengths;
 
-	static constexpr std::array<Oid, std::tuple_size<Bind_tt>::value> native_oid    = psql::oid<Bind_tt>();
-	static constexpr std::array<int, std::tuple_size<Bind_tt>::value> paramFormats  = psql::format<Bind_tt>();
+	//chosen at prepare time, from Connection_t::default_format()
+	std::array<Oid, std::tuple_size<Bind_tt>::value> native_oid   = std::array<Oid, std::tuple_size<Bind_tt>::value>();
+	std::array<int, std::tuple_size<Bind_tt>::value> paramFormats = std::array<int, std::tuple_size<Bind_tt>::value>();
 
+	//format of the results (all columns), see psql::set_result_format
+	int result_format = psql::FORMAT_TEXT;
 
+	//rows held in memory by Result_t, 0 = all, see psql::set_chunk_size
+	int chunk_size = 0;
 
+	[[no_unique_address]] impl::Query_probe<Tag_psql> probe; //see set_observer
 };
 
 
@@ -223,13 +313,24 @@ struct tdb::Result_t<tdb::Tag_psql,Return_tt>{
 	template<typename Bind_tt>
 	explicit Result_t(Query_t<Tag_psql,Return_tt,Bind_tt>&q);
 
+	//take ownership of a whole result set (ex : received asynchronously)
+	Result_t(PGresult *res, int format)noexcept(true);
+
 	//Recomended : return the sql as std::string
 	std::string sql_string()const;
 
 	//native
 	PGresult * native_result = nullptr; //OWNED
 	int current_row = 0;
+	int native_format = psql::FORMAT_TEXT; //format of all the columns
 
+	//streaming results (chunk_size!=0) : native_result is the current chunk,
+	//native_stream is the connection until the last chunk is read.
+	//While streaming, the connection cannot run other queries.
+	int native_chunk_size = 0;
+	PGconn * native_stream = nullptr; //NOT owned
+
+	[[no_unique_address]] impl::Result_probe<Tag_psql> probe; //see set_observer
 };
 
 //Required : Fetch data.
@@ -254,10 +355,55 @@ struct tdb::Result_t<tdb::Tag_psql,Return_tt>{
 //=== Bind_t and Get_row_t ===
 //============================
 namespace tdb::psql{
-	static constexpr inline int FORMAT_TEXT   = 0;
-	static constexpr inline int FORMAT_BINARY = 1;
-
+	//How a C++ type T is exchanged with psql
+	//  text   (required) : oid, to_db, from_db
+	//  binary (optional) : has_binary, binary_oid, to_db_binary, from_db_binary
+	//The default implementation is text only, and uses Convert_t<...,tdb::Tag_psql>
 	template<typename T, typename is_enabled=void> struct BindInfo_t;
+
+	//oid of the builtin types (see catalog/pg_type.h)
+	static constexpr inline Oid OID_BOOL        = 16;
+	static constexpr inline Oid OID_BYTEA       = 17;
+	static constexpr inline Oid OID_NAME        = 19;
+	static constexpr inline Oid OID_INT8        = 20;
+	static constexpr inline Oid OID_INT2        = 21;
+	static constexpr inline Oid OID_INT4        = 23;
+	static constexpr inline Oid OID_TEXT        = 25;
+	static constexpr inline Oid OID_FLOAT4      = 700;
+	static constexpr inline Oid OID_FLOAT8      = 701;
+	static constexpr inline Oid OID_UNKNOWN     = 705;
+	static constexpr inline Oid OID_BPCHAR      = 1042;
+	static constexpr inline Oid OID_VARCHAR     = 1043;
+	static constexpr inline Oid OID_TIMESTAMP   = 1114;
+	static constexpr inline Oid OID_TIMESTAMPTZ = 1184;
+	static constexpr inline Oid OID_UUID        = 2950;
+
+	//--- extra types ---
+	typedef std::vector<std::byte>            Bytea;     //bytea
+	typedef std::chrono::system_clock::time_point Timestamp; //timestamptz (microseconds), timestamp is read as UTC
+
+	struct Uuid{                                         //uuid
+		std::array<unsigned char,16> bytes = std::array<unsigned char,16>();
+		friend bool operator==(const Uuid&,const Uuid&)=default;
+	};
+
+	//text format of the extra types (tdb_psql.cpp)
+	std::string bytea_to_text    (const Bytea &b);
+	Bytea       bytea_from_text  (const std::string &s);
+	std::string timestamp_to_text(const Timestamp &t);
+	Timestamp   timestamp_from_text(const std::string &s);
+	std::string uuid_to_text     (const Uuid &u);
+	Uuid        uuid_from_text   (const std::string &s);
+
+	//change the format of the results of q
+	//FORMAT_BINARY throws if a type in Return_tt has no binary BindInfo_t
+	template<typename Return_tt, typename Bind_tt>
+	void set_result_format(Query_t<Tag_psql,Return_tt,Bind_tt> &q, int format);
+
+	//change the number of rows held in memory by the results of q
+	//(see Connection_t<Tag_psql>::set_default_chunk_size)
+	template<typename Return_tt, typename Bind_tt>
+	void set_chunk_size(Query_t<Tag_psql,Return_tt,Bind_tt> &q, int n);
 }
 
 //Bind_t DO NOT USE Bind_one, but relies on tdb::psql::Bind_info
@@ -280,7 +426,355 @@ struct tdb::Get_row_t<tdb::Tag_psql,Return_tt>;
 //   template<typename Return_tt, typename Bind_tt>  struct tdb::Insert_t  <tdb::Tag_psql,Return_tt,Bind_tt>;
 
 
+//--- multi rows insert (optional) ---
+//psql accepts at most 65535 bound parameters in a statement
+template<> struct tdb::Get_bind_limit_t<tdb::Tag_psql>{
+	static constexpr bool is_implemented = true;
+	static size_t run(const tdb::Connection_t<tdb::Tag_psql> &){return 65535;}
+};
+
+//prepared with nb_rows*tuple_size<Bind_tt> parameters, the types and formats of Bind_tt are repeated for each row
+template<typename Bind_tt>
+struct tdb::Multi_insert_t<tdb::Tag_psql,Bind_tt>{
+	static constexpr bool is_implemented = true;
+	static constexpr size_t nb_cols = std::tuple_size<Bind_tt>::value;
+
+	Multi_insert_t()noexcept(true){}
+	Multi_insert_t(Connection_t<Tag_psql> &c, const std::string &head, const std::string &tail, size_t nb_rows_);
+
+	//movable, NOT copiable
+	Multi_insert_t(Multi_insert_t&&a)noexcept(true){swap(a);}
+	Multi_insert_t& operator=(Multi_insert_t&&a)noexcept(true){swap(a); return *this;}
+	Multi_insert_t(const Multi_insert_t&)=delete;
+	Multi_insert_t& operator=(const Multi_insert_t&)=delete;
+
+	//LOCKS the underlying database (DEALLOCATE), as ~Query_t
+	~Multi_insert_t()noexcept(true);
+
+	size_t nb_rows()const{return native_nb_rows;}
+
+	template<typename It>
+	void run(It &first);
+
+	tdb::Connection_t<tdb::Tag_psql> *db=nullptr; //NOT owned
+	char* native_name_holder = nullptr;            //unique name, as in Query_t
+	std::string native_name;
+	std::string native_sql;
+	size_t native_nb_rows = 0;
+
+	//one row
+	std::array<std::string, nb_cols> rowValues;
+	std::array<int, nb_cols>         rowLengths;
+	std::array<Oid, nb_cols>         rowOid     = std::array<Oid, nb_cols>();
+	std::array<int, nb_cols>         rowFormats = std::array<int, nb_cols>();
+
+	//all rows
+	std::vector<std::string>  paramValues;
+	std::vector<const char *> paramValues_cstr;
+	std::vector<int>          paramLengths;
+	std::vector<int>          paramFormats;
+
+	private:
+	void swap(Multi_insert_t &a)noexcept(true);
+};
+
+
+
+//--- scripts (read_istream, read_string, read_file) ---
+//The input is read through a Script_options::buffer_size buffer and split into statements
+//(quotes, comments and $$ dollar quotes are skipped). Statements are sent in pipeline mode,
+//Script_options::batch_size at a time (one round trip per batch, psql>=14).
+//COPY ... FROM stdin followed by its data (as written by pg_dump) is streamed with COPY.
+//- without single_transaction, the statements of a batch run in one implicit transaction :
+//  a failure rolls back its batch. Use batch_size=1 for statements that cannot run in a
+//  transaction block (VACUUM, CREATE DATABASE...).
+//- rows returned by the statements are ignored (use batch_size=1 if they are large).
+//- psql meta commands (\connect, \set...) are not supported.
+template<> struct tdb::Read_Istream_t<tdb::Tag_psql>{
+	static constexpr bool is_implemented = true;
+	static void run(Connection_t<Tag_psql> &c, std::istream &in, const Script_options &o);
+};
+
+template<> struct tdb::Read_String_t<tdb::Tag_psql>{
+	static constexpr bool is_implemented = true;
+	static void run(Connection_t<Tag_psql> &c, const std::string &s, const Script_options &o){impl::read_string_as_istream(c,s,o);}
+};
+
+namespace tdb::psql::impl{
+	//length of the first statement of [begin,end), up to and including its ';'
+	//0 if the statement is not complete
+	size_t script_statement_length(const char *begin, const char *end);
+}
+
+
+
+
+//================
+//=== pipeline ===
+//================
+//Send many bound executions of prepared queries without waiting for each
+//round trip (libpq pipeline mode, psql>=14).
+// Usage:
+//   auto p = tdb::psql::pipeline(connection);
+//   for(...){p.insert_a(query, a, b);}
+//   for(const auto &s : p.sync()){ if(!s.ok){std::cerr << s.error;} }
+//
+//- statements between two sync() run in a single implicit transaction :
+//  when a statement fails, the following ones are aborted, and the previous
+//  ones are rolled back. All of them are reported not ok.
+//- discard() (and the destructor, when statements are pending) rolls back the
+//  statements queued since the last sync() with a ROLLBACK : nothing is commited
+//  on error. Inside an explicit transaction (BEGIN before the pipeline), the
+//  ROLLBACK ends it.
+//- while the pipeline lives, the connection can only be used through it
+//  (don't prepare, destroy queries, execute or get_result).
+//- NOT thread safe : lock the connection if it is shared.
+#ifdef LIBPQ_HAS_PIPELINING
+namespace tdb::psql{
+
+	//outcome of one statement queued in a Pipeline_t
+	struct Pipeline_status{
+		bool ok = false;
+		std::string error;              //empty when ok
+		Rowid<Tag_psql> rowid = 0;      //insert : last returned row (as tdb::insert), 0 if none
+		long long affected_rows = 0;    //rows inserted, updated, deleted...
+	};
+
+	struct Pipeline_t{
+		explicit Pipeline_t(Connection_t<Tag_psql> &c);
+		~Pipeline_t(); //discard() the statements that were not synced
+
+		//NOT copiable, NOT movable
+		Pipeline_t(Pipeline_t&&)                =delete;
+		Pipeline_t& operator=(Pipeline_t&&)     =delete;
+		Pipeline_t(const Pipeline_t&)           =delete;
+		Pipeline_t& operator=(const Pipeline_t&)=delete;
+
+		//queue a statement, return its index in the vector returned by sync()
+		template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+		size_t execute  (Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me){return send(q,bind_me,false);}
+
+		template<typename Return_tt, typename Bind_tt, typename... A>
+		size_t execute_a(Query_t<Tag_psql,Return_tt,Bind_tt> &q, const A&... bind_me){return send(q,std::tie(bind_me...),false);}
+
+		template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+		size_t insert   (Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me){return send(q,bind_me,true);}
+
+		template<typename Return_tt, typename Bind_tt, typename... A>
+		size_t insert_a (Query_t<Tag_psql,Return_tt,Bind_tt> &q, const A&... bind_me){return send(q,std::tie(bind_me...),true);}
+
+		//wait for the queued statements, return their status (in queuing order)
+		//ok : commited (or run, inside an explicit transaction). If one statement fails, none is ok.
+		//throws only on connection errors, after reading the results up to the sync point
+		std::vector<Pipeline_status> sync();
+
+		//roll back the statements queued since the last sync() (some may have run already)
+		//throws only on connection errors
+		void discard();
+
+		//number of statements queued since the last sync()
+		size_t pending()const{return queued.size();}
+
+		Connection_t<Tag_psql> &db;
+
+		private:
+		struct Entry{
+			bool read_rowid;
+			int  result_format;
+		};
+
+		template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+		size_t send(Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me, bool read_rowid);
+
+		std::vector<Pipeline_status> read_sync_point(bool discarded);
+		void drain();
+
+		std::vector<Entry> queued;
+	};
+
+	[[nodiscard]] inline Pipeline_t pipeline(Connection_t<Tag_psql> &c){return Pipeline_t(c);}
+}
+#endif
+
+
+
+
+
 
+//===============
+//=== copy in ===
+//===============
+//Bulk load rows with COPY ... FROM STDIN, much faster than one insert per row.
+// Usage:
+//   tdb::psql::Copy_in_t<std::tuple<int,double>> copy(connection,"test(i1,d1)");
+//   copy.add_a(1,0.5);
+//   copy.add_range(vector_of_tuples);
+//   std::copy(v.begin(),v.end(),copy.inserter());
+//   long long n = copy.finish(); //rows copied
+//
+//- values are written with BindInfo_t (to_db, or to_db_binary in binary format),
+//  an empty std::optional is written as NULL.
+//- FORMAT_BINARY : every type must have a binary BindInfo_t, and the binary
+//  types must match the columns exactly (e.g., int for integer, long long for bigint).
+//- destroyed before finish() : the COPY is aborted (nothing is loaded).
+//- while the copy lives, the connection can only be used through it.
+//- NOT thread safe : lock the connection if it is shared.
+namespace tdb::psql{
+
+	template<typename Bind_tt>
+	struct Copy_in_t{
+
+		//target : table name, optionally followed by the columns, e.g., "test(i1,d1)"
+		Copy_in_t(Connection_t<Tag_psql> &c, const std::string &target, int format = FORMAT_TEXT);
+		~Copy_in_t();
+
+		//NOT copiable, NOT movable
+		Copy_in_t(Copy_in_t&&)                =delete;
+		Copy_in_t& operator=(Copy_in_t&&)     =delete;
+		Copy_in_t(const Copy_in_t&)           =delete;
+		Copy_in_t& operator=(const Copy_in_t&)=delete;
+
+		//add rows
+		template<typename Bind_t2> void add(const Bind_t2 &row);
+		template<typename... A>    void add_a(const A&... a){add(std::tie(a...));}
+		template<typename Range_t> void add_range(const Range_t &rows){for(const auto &row : rows){add(row);}}
+
+		//output iterator, *it = row calls add(row)
+		struct Insert_iterator{
+			typedef std::output_iterator_tag iterator_category;
+			typedef void value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef void pointer;
+			typedef void reference;
+
+			Copy_in_t *copy;
+			template<typename Bind_t2>
+			Insert_iterator& operator=(const Bind_t2 &row){copy->add(row); return *this;}
+			Insert_iterator& operator* (){return *this;}
+			Insert_iterator& operator++(){return *this;}
+			Insert_iterator  operator++(int){return *this;}
+		};
+		Insert_iterator inserter(){return Insert_iterator{this};}
+
+		//end the COPY, return the number of rows copied
+		long long finish();
+
+		Connection_t<Tag_psql> &db;
+		const int format;
+		size_t flush_size = 1<<16; //bytes buffered before PQputCopyData
+
+		private:
+		void flush();
+		std::string buffer;
+		bool is_finished = false;
+	};
+
+	//copy all the rows at once
+	template<typename Bind_tt, typename Range_t>
+	long long copy_in(Connection_t<Tag_psql> &c, const std::string &target, const Range_t &rows, int format = FORMAT_TEXT){
+		Copy_in_t<Bind_tt> copy(c,target,format);
+		copy.add_range(rows);
+		return copy.finish();
+	}
+
+	namespace impl{
+		//non template part of Copy_in_t (tdb_psql.cpp)
+		void        copy_in_start(PGconn *c, const std::string &sql);
+		void        copy_in_put  (PGconn *c, std::string &buffer); //send and clear buffer
+		long long   copy_in_end  (PGconn *c, const char *error_msg); //error_msg!=nullptr : abort the copy
+	}
+}
+
+
+
+//================
+//=== copy out ===
+//================
+//Export rows with COPY (query) TO STDOUT : rows are decoded one by one,
+//the whole result is never held in memory.
+// Usage:
+//   tdb::psql::Copy_out_t<std::tuple<int,double>> copy(connection,"select i1,d1 from test");
+//   while(auto r = copy.try_fetch()){...}
+//See also functors/Fn_copy_out.hpp
+//
+//- COPY cannot have bound parameters.
+//- values are read with BindInfo_t (from_db, or from_db_binary in binary format).
+//- FORMAT_BINARY : every type must have a binary BindInfo_t, and the binary
+//  types must match the columns exactly (COPY doesn't send the column types).
+//- destroyed before the last row : the COPY is cancelled.
+//- while the copy lives, the connection can only be used through it.
+//- NOT thread safe : lock the connection if it is shared.
+namespace tdb::psql{
+
+	namespace impl{
+		struct Copy_field{
+			const char *data = nullptr; //nullptr for NULL
+			int size = 0;
+		};
+	}
+
+	template<typename Return_tt>
+	struct Copy_out_t{
+
+		//sql : a select query
+		Copy_out_t(Connection_t<Tag_psql> &c, const std::string &sql, int format = FORMAT_TEXT);
+		~Copy_out_t();
+
+		//NOT copiable, NOT movable
+		Copy_out_t(Copy_out_t&&)                =delete;
+		Copy_out_t& operator=(Copy_out_t&&)     =delete;
+		Copy_out_t(const Copy_out_t&)           =delete;
+		Copy_out_t& operator=(const Copy_out_t&)=delete;
+
+		//next row, or an empty optional after the last row
+		std::optional<Return_tt> try_fetch();
+
+		Connection_t<Tag_psql> &db;
+		const int format;
+
+		private:
+		PGconn *native_stream = nullptr; //nullptr after the last row
+		std::string row;                 //current row, as sent by psql
+		std::vector<std::optional<std::string>> text_fields;
+		std::vector<impl::Copy_field> binary_fields;
+		bool header_read = false;
+	};
+
+	namespace impl{
+		//non template part of Copy_out_t (tdb_psql.cpp)
+		void copy_out_start (PGconn *c, const std::string &sql);
+		bool copy_out_row   (PGconn *&c, std::string &row); //false (and c=nullptr) after the last row
+		void copy_out_cancel(PGconn *&c)noexcept(true);
+
+		//split a row. text : unescape, binary : fields point into row (data==nullptr for NULL)
+		void copy_out_split_text  (const std::string &row, std::vector<std::optional<std::string>> &fields);
+		bool copy_out_split_binary(const std::string &row, bool &header_read, std::vector<Copy_field> &fields); //false on trailer
+	}
+}
+
+
+
+//=================
+//=== snapshots ===
+//=================
+//Several connections reading the same state of the database (see functors/Fn_parallel_export.hpp).
+// Usage:
+//   std::string id = tdb::psql::begin_read_same_snapshot(readers); //readers : std::vector<Connection_t<Tag_psql>*>
+//   ... read with the readers, from several threads ...
+//   for(auto *r : readers){tdb::psql::end_read(*r);}
+//
+//- readers[0] : BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY, then pg_export_snapshot()
+//- the others : BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY, then SET TRANSACTION SNAPSHOT id
+//- the snapshot only exists while the transaction of readers[0] is open : end it last.
+//- the readers must not be in a transaction. end_read : COMMIT.
+namespace tdb::psql{
+	std::string begin_read_same_snapshot(const std::vector<Connection_t<Tag_psql>*> &readers); //returns the snapshot id
+	void end_read(Connection_t<Tag_psql> &reader);
+
+	//connection string of an open connection, with the parameters actually used (PQconninfo,
+	//password included) : to open more connections to the same database.
+	std::string conninfo(const Connection_t<Tag_psql> &c);
+}
 
 
 #include "tdb_psql.tpp"
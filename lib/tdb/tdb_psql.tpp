@@ -1,6 +1,9 @@
 #include <sstream>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <bit>     //std::bit_cast
+#include <limits>
 
 
 
@@ -9,40 +12,11 @@
 //===============
 //=== Convert ===
 //===============
-
-#include <boost/lexical_cast.hpp>
-//string => number
-template<typename To_tt>
-struct Convert_t<
-		To_tt,
-		std::string,
-		typename std::enable_if <std::is_integral<To_tt>::value or std::is_floating_point<To_tt>::value, tdb::Tag_psql
->::type  >{
-	typedef To_tt To_t;
-	typedef std::string From_t;
-	typedef tdb::Tag_psql Context_tag_t;
-
-	static To_t run(const From_t &f){
-		return boost::lexical_cast<To_t>(f);
-	}
-};
-
-
-//number=> string
-template<typename From_tt>
-struct Convert_t<
-		std::string, //to
-		From_tt,
-		typename std::enable_if <std::is_integral<From_tt>::value or std::is_floating_point<From_tt>::value, tdb::Tag_psql
->::type  >{
-	typedef std::string To_t;
-	typedef From_tt     From_t;
-	typedef tdb::Tag_psql Context_tag_t;
-
-	static To_t run(const From_t &f){
-		return boost::lexical_cast<To_t>(f);
-	}
-};
+//text conversion kernels, based on std::to_chars / std::from_chars
+//(no locale, no iostream, no allocation beyond the destination string)
+#include <charconv>
+#include <cmath>
+#include <system_error>
 
 //string => bool
 //doc : https://www.postgresql.org/docs/9.1/datatype-boolean.html
@@ -85,6 +59,118 @@ struct Convert_t<std::string, bool,   tdb::Tag_psql >{
 };
 
 
+namespace tdb::psql::impl{
+
+	//characters are converted as characters (as boost::lexical_cast did), not as numbers
+	template<typename T>
+	static constexpr bool is_char_type = std::is_same<T,char>::value or std::is_same<T,signed char>::value or std::is_same<T,unsigned char>::value;
+
+	template<typename T>
+	static constexpr bool is_wide_char_type = std::is_same<T,wchar_t>::value or std::is_same<T,char8_t>::value or std::is_same<T,char16_t>::value or std::is_same<T,char32_t>::value;
+
+	//integers, floating points, bool, char
+	template<typename T>
+	static constexpr bool has_text_kernel = std::is_arithmetic<T>::value and !is_wide_char_type<T>;
+
+
+	//--- T => text ---
+	template<typename T>
+	void to_chars_text(const T &t, std::string &write_here){
+		static_assert(has_text_kernel<T>,"");
+
+		if constexpr(std::is_same<T,bool>::value){
+			write_here.assign(1, t ? '1' : '0');
+		}else if constexpr(is_char_type<T>){
+			write_here.assign(1, static_cast<char>(t));
+		}else{
+			if constexpr(std::is_floating_point<T>::value){
+				//psql spelling
+				if(std::isnan(t)){write_here.assign("NaN"); return;}
+				if(std::isinf(t)){write_here.assign(t>0 ? "Infinity" : "-Infinity"); return;}
+			}
+			char buffer[64];
+			const std::to_chars_result r = std::to_chars(buffer, buffer+sizeof(buffer), t); //shortest round trip for floating points
+			assert(r.ec==std::errc());
+			write_here.assign(buffer, r.ptr);
+		}
+	}
+
+
+	//--- text => T ---
+	[[noreturn]] inline void from_chars_error(const char *data, size_t size, const char *type_name){
+		throw Exception_t<tdb::Tag_psql>("Cannot convert string to "+std::string(type_name)+", string="+std::string(data,size)+", context=Tag_psql");
+	}
+
+	template<typename T>
+	T from_chars_text(const char *data, size_t size){
+		static_assert(has_text_kernel<T>,"");
+		const char *last = data+size;
+
+		if constexpr(std::is_same<T,bool>::value){
+			//common cases
+			if(size==1){
+				if(data[0]=='t' or data[0]=='1'){return true;}
+				if(data[0]=='f' or data[0]=='0'){return false;}
+			}
+			//exotic cases
+			return Convert_t<bool,std::string,tdb::Tag_psql>::run(std::string(data,size));
+		}else if constexpr(is_char_type<T>){
+			if(size!=1){from_chars_error(data,size,"char");}
+			return static_cast<T>(data[0]);
+		}else{
+			T t;
+			std::from_chars_result r;
+			if constexpr(std::is_floating_point<T>::value){
+				r = std::from_chars(data, last, t, std::chars_format::general); //also read NaN, Infinity, -Infinity
+			}else{
+				r = std::from_chars(data, last, t);
+			}
+			if(r.ec!=std::errc() or r.ptr!=last){
+				from_chars_error(data, size, std::is_floating_point<T>::value ? "floating point" : "integer");
+			}
+			return t;
+		}
+	}
+}
+
+
+//string => number
+template<typename To_tt>
+struct Convert_t<
+		To_tt,
+		std::string,
+		typename std::enable_if <tdb::psql::impl::has_text_kernel<To_tt> and !std::is_same<To_tt,bool>::value, tdb::Tag_psql
+>::type  >{
+	typedef To_tt To_t;
+	typedef std::string From_t;
+	typedef tdb::Tag_psql Context_tag_t;
+
+	static To_t run(const From_t &f){
+		return tdb::psql::impl::from_chars_text<To_t>(f.data(),f.size());
+	}
+};
+
+
+//number=> string
+template<typename From_tt>
+struct Convert_t<
+		std::string, //to
+		From_tt,
+		typename std::enable_if <tdb::psql::impl::has_text_kernel<From_tt> and !std::is_same<From_tt,bool>::value, tdb::Tag_psql
+>::type  >{
+	typedef std::string To_t;
+	typedef From_tt     From_t;
+	typedef tdb::Tag_psql Context_tag_t;
+
+	static To_t run(const From_t &f){
+		std::string r;
+		tdb::psql::impl::to_chars_text(f,r);
+		return r;
+	}
+};
+
+
+
 //===============
 //=== Query_t ===
 //===============
@@ -101,7 +187,13 @@ tdb::Query_t<tdb::Tag_psql,Return_tt,Bind_tt>::Query_t(Query_t&&q)noexcept(true)
 	std::swap(native_query_result,q.native_query_result);
 	std::swap(db,q.db);
 	std::swap(paramValues,q.paramValues);
+	std::swap(paramLengths,q.paramLengths);
+	std::swap(native_oid,q.native_oid);
+	std::swap(paramFormats,q.paramFormats);
+	std::swap(result_format,q.result_format);
+	std::swap(chunk_size,q.chunk_size);
 	std::swap(native_sql,q.native_sql);
+	std::swap(probe,q.probe);
 }
 
 template<typename Return_tt, typename Bind_tt>
@@ -111,7 +203,13 @@ auto tdb::Query_t<tdb::Tag_psql,Return_tt,Bind_tt>::operator = (Query_t&&q)noexc
 	std::swap(native_query_result,q.native_query_result);
 	std::swap(db,q.db);
 	std::swap(paramValues,q.paramValues);
+	std::swap(paramLengths,q.paramLengths);
+	std::swap(native_oid,q.native_oid);
+	std::swap(paramFormats,q.paramFormats);
+	std::swap(result_format,q.result_format);
+	std::swap(chunk_size,q.chunk_size);
 	std::swap(native_sql,q.native_sql);
+	std::swap(probe,q.probe);
 	return *this;
 }
 
@@ -169,6 +267,12 @@ tdb::Query_t<tdb::Tag_psql,Return_tt,Bind_tt>::Query_t(
 
 	static constexpr size_t param_size = std::tuple_size<Bind_tt>::value;
 
+	//text, or binary when possible
+	const bool binary = c.default_format()==psql::FORMAT_BINARY;
+	psql::param_info<Bind_tt>(binary, native_oid, paramFormats);
+	if(binary and psql::has_binary_result<Return_tt>()){result_format = psql::FORMAT_BINARY;}
+	chunk_size = c.default_chunk_size();
+
 	native_name_holder = new char;
 	this->native_name = psql::query_name(native_name_holder);
 	//std::cout << "create : "<<this->native_name<<std::endl;
@@ -203,6 +307,24 @@ std::string tdb::Query_t<tdb::Tag_psql,Return_tt,Bind_tt>::sql_string()const{
 }
 
 
+template<typename Return_tt, typename Bind_tt>
+void tdb::psql::set_result_format(Query_t<Tag_psql,Return_tt,Bind_tt> &q, int format){
+	if(format==FORMAT_TEXT){q.result_format=FORMAT_TEXT; return;}
+	if(format==FORMAT_BINARY){
+		if(!has_binary_result<Return_tt>()){throw Exception_t<tdb::Tag_psql>("Cannot fetch in binary format, some returned types have no binary BindInfo_t, sql="+q.native_sql);}
+		q.result_format=FORMAT_BINARY;
+		return;
+	}
+	throw Exception_t<tdb::Tag_psql>("Invalid psql format : "+std::to_string(format));
+}
+
+template<typename Return_tt, typename Bind_tt>
+void tdb::psql::set_chunk_size(Query_t<Tag_psql,Return_tt,Bind_tt> &q, int n){
+	if(n<0){throw Exception_t<tdb::Tag_psql>("Invalid psql chunk size : "+std::to_string(n));}
+	q.chunk_size=n;
+}
+
+
 inline std::string tdb::psql::query_name(const void * unique_id){
 	//const void * unique_id = std::addressof(q);
 	std::stringstream ss;
@@ -224,31 +346,38 @@ template<typename Return_tt>
 tdb::Result_t<tdb::Tag_psql,Return_tt>::Result_t(Result_t&& r)noexcept(true){
 	std::swap(native_result,r.native_result);
 	std::swap(current_row,  r.current_row);
+	std::swap(native_format,r.native_format);
+	std::swap(native_chunk_size,r.native_chunk_size);
+	std::swap(native_stream,r.native_stream);
+	std::swap(probe,r.probe);
 }
 
 template<typename Return_tt>
 auto tdb::Result_t<tdb::Tag_psql,Return_tt>::operator = (Result_t&& r)noexcept(true)->Result_t&{
 	std::swap(native_result,r.native_result);
 	std::swap(current_row  , r.current_row);
+	std::swap(native_format, r.native_format);
+	std::swap(native_chunk_size, r.native_chunk_size);
+	std::swap(native_stream, r.native_stream);
+	std::swap(probe,r.probe);
 	return *this;
 }
 
 template<typename Return_tt>
 tdb::Result_t<tdb::Tag_psql,Return_tt>::~Result_t(){
 	PQclear(native_result);
+	psql::stream_cancel(native_stream); //unfinished stream : the connection must be usable again
 }
 
+template<typename Return_tt>
+tdb::Result_t<tdb::Tag_psql,Return_tt>::Result_t(PGresult *res, int format)noexcept(true):native_result(res),native_format(format){}
+
 template<typename Return_tt>
 template<typename Bind_tt>
 tdb::Result_t<tdb::Tag_psql,Return_tt>::Result_t(Query_t<Tag_psql,Return_tt,Bind_tt>&q){
 	assert(native_result==nullptr);
 
-	//TODO bind must fill : paramValues, paramLengths, paramFormats
-
-
-	static constexpr int  resultFormat= 0; //0=string. 1=binary.
-	//WARNING : doc in unclear, no idea which format is expected for binary
-	//(endianes, size ???)
+	native_format = q.result_format;
 
 	//std::string to c_str
 	std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
@@ -257,16 +386,39 @@ tdb::Result_t<tdb::Tag_psql,Return_tt>::Result_t(Query_t<Tag_psql,Return_tt,Bind
 	}
 
 
-	this->native_result = PQexecPrepared(
+	if(q.chunk_size==0){
+		//whole result set
+		this->native_result = PQexecPrepared(
+				q.db->native_connection,
+				q.native_name.c_str() ,
+				std::tuple_size<Bind_tt>::value,
+				paramValues_cstr.data(),
+				q.paramLengths.data(),
+				q.paramFormats.data(),
+				native_format
+		);
+		return;
+	}
+
+	//streaming : rows are received chunk by chunk, by try_fetch
+	//https://www.postgresql.org/docs/current/libpq-single-row-mode.html
+	const int sent = PQsendQueryPrepared(
 			q.db->native_connection,
 			q.native_name.c_str() ,
 			std::tuple_size<Bind_tt>::value,
 			paramValues_cstr.data(),
 			q.paramLengths.data(),
 			q.paramFormats.data(),
-			resultFormat
+			native_format
 	);
+	if(!sent){
+		throw Exception_t<tdb::Tag_psql>("Cannot send query\n error:\n"+std::string(PQerrorMessage(q.db->native_connection))+"\n  sql: " + q.native_sql );
+	}
 
+	native_chunk_size = q.chunk_size;
+	native_stream     = q.db->native_connection;
+	psql::stream_set_mode(native_stream, native_chunk_size);
+	psql::stream_next(native_stream,native_result); //first chunk : errors are reported here
 
 }
 
@@ -289,116 +441,555 @@ namespace tdb::psql{
 
 	template<typename T>
 	static constexpr bool is_optional = is_optional_t<T>::value;
+
+	template<typename T> struct remove_optional_t{typedef T type;};
+	template<typename T> struct remove_optional_t<std::optional<T>>{typedef T type;};
+
+	template<typename T>
+	using remove_optional = typename remove_optional_t<T>::type;
 	}
 
 
+	//NOTE on formats :
+	//libpq can exchange data as text or as binary, but
+	//-  for binding :  text v.s. binary is chosen for each bound parameter
+	//   (binary requires the right oid when the query is prepared)
+	//-  for fetching : all columns must be fetched using the same format
+	//   (see resultFormat in PQexecParams at https://www.postgresql.org/docs/9.1/libpq-exec.html )
+	//=> Parameters are bound in binary when their type has a binary BindInfo_t,
+	//   results are fetched in binary only if ALL returned types have one.
+	//=> Binary is opt-in : see Connection_t<Tag_psql>::set_default_format
+	//   and psql::set_result_format.
+
+	//--- text format (default) ---
+	namespace impl{
+		template<typename T>
+		struct BindInfo_text_t{
+			static constexpr Oid oid = 0; 	//let the server decide
+
+			//convert to text format
+			static std::string to_db(const T&t){
+				return convert<std::string,tdb::Tag_psql>(t);
+			}
+
+			//convert from text format
+			static T from_db(const std::optional<std::string> &s){
+				if constexpr (is_optional<T>){
+					if(s.has_value()){return convert<typename T::value_type,tdb::Tag_psql>(s.value() ); }
+					else{return T();}
+				}else{
+					if(s.has_value()){return convert<T,tdb::Tag_psql>(s.value() );} //Error here : missing Convert_t
+					else             {throw Exception_t<tdb::Tag_psql>("NULL value");}
+				}
+			}
+
+			//fast path (optional in BindInfo_t) : no temporary strings
+			//  to_db_text  (t, write_here) : write the text of t in write_here
+			//  from_db_text(data, size)    : read a non NULL value from PQgetvalue
+			static void to_db_text(const T&t, std::string &write_here) requires has_text_kernel<T> {
+				to_chars_text(t,write_here);
+			}
+
+			static T from_db_text(const char *data, size_t size) requires has_text_kernel<T> {
+				return from_chars_text<T>(data,size);
+			}
+		};
+	}
+
 	template<typename T, typename is_enabled>
-	struct BindInfo_t{
-
-		static constexpr Oid oid    = 0; 	//let the server decide
-
-		//doc for binary format is unclear, so it's safer to pass text
-		static constexpr int format = FORMAT_TEXT;
-
-		static_assert(format==FORMAT_TEXT,"libpq hates you : don't use binary interface.");
-		//WARNING :
-		//libpq propose a text and a binary interface to bind/fetch data but
-		//-  for binding :  text v.s. binary is chosen for each bound parameter
-		//   you can therefore send param 1 as text, and param 2 as binary.
-		//   this is the expected behaviour as it make sence to choose depending
-		//   on the parameter type.
-		//-  for fetching : all column must be fetched using the same interface
-		//   (all are text, or all are binary, no mix). This is terribly stupid
-		//   as exchange format is related to parameters types, not to something
-		//   query specific. Morever it's unconsistend with binding.
-		//=> It's therefore impossible to define how parameters are exchanged
-		//   in a consistent way for each parameter.
-		//
-		//=> !!! ALWAYS bind and fetch as FORMAT_TEXT. !!!
-		//
-		//=> Note that the doc is trolling you, saying that psql CAN define
-		//   a format per fetched column but actually DON'T do it
-		//   (see resultFormat in PQexecParams at
-		//   https://www.postgresql.org/docs/9.1/libpq-exec.html )
-
-		//WARNING2:
-		//The binary interface require architecture independant values + OID,
-		//and the way to generate them from native types is poorly documented.
-
-		//convert to text/binary format
-		//default : text
-		static std::string to_db(const T&t){
-			//std::cout << "binding"<<convert<std::string,tdb::Tag_psql>(t)<<std::endl;
-			return convert<std::string,tdb::Tag_psql>(t);
-		}
-
-		//convert from text/binary format
-		//default : text
-		static T from_db(const std::optional<std::string> &s){
-			if constexpr (impl::is_optional<T>){
-				if(s.has_value()){return convert<typename T::value_type,tdb::Tag_psql>(s.value() ); }
-				else{return T();}
+	struct BindInfo_t:impl::BindInfo_text_t<T>{
+		static constexpr bool has_binary = false;
+	};
+
+
+
+	//--- binary format ---
+	//binary values are in network order (big endian)
+	//  binary_oid                      : oid used when T is bound in binary
+	//  to_db_binary  (t, write_here)   : write the binary representation of t
+	//  from_db_binary(data,size,oid)   : read a non NULL value, oid is the column type
+	namespace impl{
+
+		template<typename U>
+		void put_be(std::string &write_here, U u){
+			static_assert(std::is_unsigned<U>::value,"");
+			char b[sizeof(U)];
+			for(size_t i = 0; i < sizeof(U); ++i){
+				b[sizeof(U)-1-i] = static_cast<char>(u & 0xff);
+				u = static_cast<U>(u >> 8);
+			}
+			write_here.append(b,sizeof(U));
+		}
+
+		template<typename U>
+		U get_be(const char *data){
+			static_assert(std::is_unsigned<U>::value,"");
+			U u = 0;
+			for(size_t i = 0; i < sizeof(U); ++i){
+				u = static_cast<U>( (u << 8) | static_cast<unsigned char>(data[i]) );
+			}
+			return u;
+		}
+
+		inline void check_binary(bool ok, const char *type_name, Oid oid, int size){
+			if(!ok){throw Exception_t<tdb::Tag_psql>(std::string("Cannot read psql binary value as ")+type_name+", column_oid="+std::to_string(oid)+", size="+std::to_string(size) );}
+		}
+
+		//int2, int4, int8 => int64
+		inline std::int64_t get_binary_int(const char *data, int size, Oid oid){
+			const bool ok_oid = (oid==OID_INT2 or oid==OID_INT4 or oid==OID_INT8);
+			if(ok_oid and size==2){return static_cast<std::int16_t>(get_be<std::uint16_t>(data));}
+			if(ok_oid and size==4){return static_cast<std::int32_t>(get_be<std::uint32_t>(data));}
+			if(ok_oid and size==8){return static_cast<std::int64_t>(get_be<std::uint64_t>(data));}
+			check_binary(false,"integer",oid,size);
+			return 0;
+		}
+
+		//integers, except bool and characters
+		//signed char and unsigned char (std::int8_t, std::uint8_t) are characters in the text format, so they stay text
+		template<typename T>
+		static constexpr bool is_binary_int =
+			    std::is_integral<T>::value
+			and ! std::is_same<T,bool>::value
+			and ! is_char_type<T>
+			and ! is_wide_char_type<T>
+			and (std::is_signed<T>::value ? sizeof(T)<=8 : sizeof(T)<=4 ); //unsigned must fit in a signed psql int
+
+		static_assert(!is_binary_int<signed char> and !is_binary_int<unsigned char>,"characters must be bound the same way in text and binary formats");
+	}
+
+
+	//integers -> int2, int4, int8 (the smallest signed type that can store all T values)
+	template<typename T>
+	struct BindInfo_t<T, typename std::enable_if<impl::is_binary_int<T> >::type >:impl::BindInfo_text_t<T>{
+		static constexpr bool has_binary = true;
+
+		static constexpr size_t binary_size = std::is_signed<T>::value ? sizeof(T) : sizeof(T)*2;
+		static constexpr Oid binary_oid     = binary_size==2 ? OID_INT2 : (binary_size==4 ? OID_INT4 : OID_INT8);
+
+		static void to_db_binary(const T &t, std::string &write_here){
+			if constexpr(binary_size==2){impl::put_be(write_here, static_cast<std::uint16_t>(static_cast<std::int16_t>(t)));}
+			if constexpr(binary_size==4){impl::put_be(write_here, static_cast<std::uint32_t>(static_cast<std::int32_t>(t)));}
+			if constexpr(binary_size==8){impl::put_be(write_here, static_cast<std::uint64_t>(static_cast<std::int64_t>(t)));}
+		}
+
+		static T from_db_binary(const char *data, int size, Oid oid){
+			const std::int64_t i = impl::get_binary_int(data,size,oid);
+			bool in_range;
+			if constexpr(std::is_signed<T>::value){
+				in_range = i >= static_cast<std::int64_t>(std::numeric_limits<T>::lowest()) and i <= static_cast<std::int64_t>(std::numeric_limits<T>::max());
 			}else{
-				if(s.has_value()){return convert<T,tdb::Tag_psql>(s.value() );} //Error here : missing Convert_t
-				else             {throw Exception_t<tdb::Tag_psql>("NULL value");}
+				in_range = i >= 0 and static_cast<std::uint64_t>(i) <= static_cast<std::uint64_t>(std::numeric_limits<T>::max());
 			}
+			if(!in_range){throw Exception_t<tdb::Tag_psql>("psql binary integer out of range, value="+std::to_string(i));}
+			return static_cast<T>(i);
 		}
 	};
 
 
+	//float -> float4, double -> float8
+	template<typename T>
+	struct BindInfo_t<T, typename std::enable_if<std::is_same<T,float>::value or std::is_same<T,double>::value>::type >:impl::BindInfo_text_t<T>{
+		static_assert(std::numeric_limits<float>::is_iec559 and std::numeric_limits<double>::is_iec559,"psql binary floats require IEEE 754");
+
+		static constexpr bool has_binary = true;
+		static constexpr Oid binary_oid  = sizeof(T)==4 ? OID_FLOAT4 : OID_FLOAT8;
+
+		static void to_db_binary(const T &t, std::string &write_here){
+			if constexpr(sizeof(T)==4){impl::put_be(write_here, std::bit_cast<std::uint32_t>(t));}
+			else                      {impl::put_be(write_here, std::bit_cast<std::uint64_t>(t));}
+		}
+
+		static T from_db_binary(const char *data, int size, Oid oid){
+			if(oid==OID_FLOAT4 and size==4){return static_cast<T>(std::bit_cast<float >(impl::get_be<std::uint32_t>(data)));}
+			if(oid==OID_FLOAT8 and size==8){return static_cast<T>(std::bit_cast<double>(impl::get_be<std::uint64_t>(data)));}
+			impl::check_binary(false,"floating point",oid,size);
+			return 0;
+		}
+	};
+
+
+	//bool -> bool
+	template<>
+	struct BindInfo_t<bool>:impl::BindInfo_text_t<bool>{
+		static constexpr bool has_binary = true;
+		static constexpr Oid binary_oid  = OID_BOOL;
+
+		static void to_db_binary(const bool &t, std::string &write_here){
+			write_here.push_back(t ? 1 : 0);
+		}
+
+		static bool from_db_binary(const char *data, int size, Oid oid){
+			impl::check_binary(oid==OID_BOOL and size==1,"bool",oid,size);
+			return data[0]!=0;
+		}
+	};
+
+
+	//std::string -> text format in both modes, oid 0 : the server infers the type of the parameter
+	//(a string can be bound to a json, date, numeric, enum... column), and reads any column as text.
+	//The bytes on the wire would be the same in binary.
+	template<>
+	struct BindInfo_t<std::string>:impl::BindInfo_text_t<std::string>{
+		static constexpr bool has_binary = false;
+
+		static void to_db_text(const std::string &t, std::string &write_here){write_here.assign(t);}
+		static std::string from_db_text(const char *data, size_t size){return std::string(data,size);}
+	};
+
+
+	//Bytea -> bytea
+	template<>
+	struct BindInfo_t<Bytea>{
+		static constexpr Oid oid         = OID_BYTEA;
+		static constexpr bool has_binary = true;
+		static constexpr Oid binary_oid  = OID_BYTEA;
+
+		static std::string to_db(const Bytea &t){return bytea_to_text(t);}
+		static Bytea from_db(const std::optional<std::string> &s){
+			if(!s.has_value()){throw Exception_t<tdb::Tag_psql>("NULL value");}
+			return bytea_from_text(s.value());
+		}
+
+		static void to_db_binary(const Bytea &t, std::string &write_here){
+			write_here.append(reinterpret_cast<const char*>(t.data()),t.size());
+		}
+
+		static Bytea from_db_binary(const char *data, int size, Oid oid){
+			impl::check_binary(oid==OID_BYTEA,"bytea",oid,size);
+			const std::byte *b = reinterpret_cast<const std::byte*>(data);
+			return Bytea(b,b+size);
+		}
+	};
+
+
+	//Timestamp -> timestamptz (microseconds since 2000-01-01 UTC)
+	template<>
+	struct BindInfo_t<Timestamp>{
+		static constexpr Oid oid         = OID_TIMESTAMPTZ;
+		static constexpr bool has_binary = true;
+		static constexpr Oid binary_oid  = OID_TIMESTAMPTZ;
+
+		static constexpr std::int64_t psql_epoch_us = 946684800LL*1000000LL; //2000-01-01 - 1970-01-01
+
+		static std::string to_db(const Timestamp &t){return timestamp_to_text(t);}
+		static Timestamp from_db(const std::optional<std::string> &s){
+			if(!s.has_value()){throw Exception_t<tdb::Tag_psql>("NULL value");}
+			return timestamp_from_text(s.value());
+		}
+
+		static void to_db_binary(const Timestamp &t, std::string &write_here){
+			if(t==Timestamp::max()){impl::put_be(write_here, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()));   return;}
+			if(t==Timestamp::min()){impl::put_be(write_here, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::lowest()));return;}
+			const std::int64_t us = std::chrono::floor<std::chrono::microseconds>(t.time_since_epoch()).count() - psql_epoch_us;
+			impl::put_be(write_here, static_cast<std::uint64_t>(us));
+		}
+
+		static Timestamp from_db_binary(const char *data, int size, Oid oid){
+			impl::check_binary( (oid==OID_TIMESTAMPTZ or oid==OID_TIMESTAMP) and size==8,"timestamp",oid,size);
+			const std::int64_t v = static_cast<std::int64_t>(impl::get_be<std::uint64_t>(data));
+			if(v==std::numeric_limits<std::int64_t>::max())   {return Timestamp::max();} //infinity
+			if(v==std::numeric_limits<std::int64_t>::lowest()){return Timestamp::min();} //-infinity
+
+			typedef std::chrono::duration<long double,std::micro> check_t;
+			const check_t us (static_cast<long double>(v) + static_cast<long double>(psql_epoch_us));
+			if(us > std::chrono::duration_cast<check_t>(Timestamp::duration::max()) or us < std::chrono::duration_cast<check_t>(Timestamp::duration::min()) ){
+				throw Exception_t<tdb::Tag_psql>("psql timestamp out of the range of std::chrono::system_clock, value="+std::to_string(v));
+			}
+			return Timestamp( std::chrono::duration_cast<Timestamp::duration>(std::chrono::microseconds(v + psql_epoch_us)) );
+		}
+	};
+
+
+	//Uuid -> uuid
+	template<>
+	struct BindInfo_t<Uuid>{
+		static constexpr Oid oid         = OID_UUID;
+		static constexpr bool has_binary = true;
+		static constexpr Oid binary_oid  = OID_UUID;
+
+		static std::string to_db(const Uuid &t){return uuid_to_text(t);}
+		static Uuid from_db(const std::optional<std::string> &s){
+			if(!s.has_value()){throw Exception_t<tdb::Tag_psql>("NULL value");}
+			return uuid_from_text(s.value());
+		}
+
+		static void to_db_binary(const Uuid &t, std::string &write_here){
+			write_here.append(reinterpret_cast<const char*>(t.bytes.data()),t.bytes.size());
+		}
+
+		static Uuid from_db_binary(const char *data, int size, Oid oid){
+			impl::check_binary(oid==OID_UUID and size==16,"uuid",oid,size);
+			Uuid r;
+			std::copy(data,data+16,r.bytes.begin());
+			return r;
+		}
+	};
+
+
+
+	//arrays (bind only) : std::vector<T>, std::span<const T> -> T[], ex : where id = ANY($1)
+	//T : any type with a BindInfo_t, std::optional<T> elements are NULL or T
+	//doc : https://www.postgresql.org/docs/current/arrays.html#ARRAYS-IO
+	namespace impl{
+		//oid of element[], 0 if unknown (the server decides)
+		constexpr Oid array_oid(Oid element){
+			switch(element){
+			case OID_BOOL        : return 1000;
+			case OID_BYTEA       : return 1001;
+			case OID_NAME        : return 1003;
+			case OID_INT2        : return 1005;
+			case OID_INT4        : return 1007;
+			case OID_TEXT        : return 1009;
+			case OID_BPCHAR      : return 1014;
+			case OID_VARCHAR     : return 1015;
+			case OID_INT8        : return 1016;
+			case OID_FLOAT4      : return 1021;
+			case OID_FLOAT8      : return 1022;
+			case OID_TIMESTAMP   : return 1115;
+			case OID_TIMESTAMPTZ : return 1185;
+			case OID_UUID        : return 2951;
+			}
+			return 0;
+		}
+
+		template<typename T, typename Range_t>
+		struct BindInfo_array_t{
+			typedef remove_optional<T>  value_t;
+			typedef BindInfo_t<value_t> element_t;
+
+			static constexpr Oid element_binary_oid(){
+				if constexpr(element_t::has_binary){return element_t::binary_oid;}
+				else{return 0;}
+			}
+
+			static constexpr Oid  oid        = array_oid(element_t::oid); //numbers : 0, the server decides from the context
+			static constexpr bool has_binary = element_t::has_binary and array_oid(element_binary_oid())!=0;
+			static constexpr Oid  binary_oid = array_oid(element_binary_oid());
+
+			//{1,2,3}, {"a","b\"c",NULL}
+			static void to_db_text(const Range_t &r, std::string &write_here){
+				write_here.assign(1,'{');
+				std::string tmp;
+				bool first = true;
+				for(const T &t : r){
+					if(!first){write_here+=',';}
+					first = false;
+
+					const value_t *v;
+					if constexpr(is_optional<T>){
+						if(!t.has_value()){write_here+="NULL"; continue;}
+						v = &t.value();
+					}else{v = &t;}
+
+					if constexpr(requires{element_t::to_db_text(*v,tmp);}){element_t::to_db_text(*v,tmp);}
+					else{tmp = element_t::to_db(*v);}
+
+					if constexpr(has_text_kernel<value_t> and !is_char_type<value_t>){write_here+=tmp;} //numbers, bool
+					else{
+						write_here+='"';
+						for(char c : tmp){
+							if(c=='"' or c=='\\'){write_here+='\\';}
+							write_here+=c;
+						}
+						write_here+='"';
+					}
+				}
+				write_here+='}';
+			}
+
+			static std::string to_db(const Range_t &r){
+				std::string s;
+				to_db_text(r,s);
+				return s;
+			}
+
+			//ndim, has_null, element oid, (size, lower bound), then (length or -1, value) per element
+			static void to_db_binary(const Range_t &r, std::string &write_here){
+				const size_t size = std::ranges::size(r);
+				if(size > static_cast<size_t>(std::numeric_limits<std::int32_t>::max())){throw Exception_t<tdb::Tag_psql>("psql array too large, size="+std::to_string(size));}
+
+				bool has_null = false;
+				if constexpr(is_optional<T>){for(const T &t : r){if(!t.has_value()){has_null = true; break;}}}
+
+				put_be(write_here, static_cast<std::uint32_t>(size==0 ? 0 : 1));
+				put_be(write_here, static_cast<std::uint32_t>(has_null ? 1 : 0));
+				put_be(write_here, static_cast<std::uint32_t>(element_t::binary_oid));
+				if(size==0){return;}
+				put_be(write_here, static_cast<std::uint32_t>(size));
+				put_be(write_here, std::uint32_t(1));
+
+				std::string length;
+				for(const T &t : r){
+					const value_t *v;
+					if constexpr(is_optional<T>){
+						if(!t.has_value()){put_be(write_here, static_cast<std::uint32_t>(-1)); continue;}
+						v = &t.value();
+					}else{v = &t;}
+
+					const size_t pos = write_here.size();
+					put_be(write_here, std::uint32_t(0));
+					element_t::to_db_binary(*v, write_here);
+					length.clear();
+					put_be(length, static_cast<std::uint32_t>(write_here.size()-pos-4));
+					write_here.replace(pos,4,length);
+				}
+			}
+		};
+	}
+
+	template<typename T>
+	struct BindInfo_t<std::vector<T>>:impl::BindInfo_array_t<T,std::vector<T>>{};
+
+	template<typename T>
+	struct BindInfo_t<std::span<const T>>:impl::BindInfo_array_t<T,std::span<const T>>{};
+
+
+
 	namespace impl{
 
+		//read one value, std::optional<T> is read as NULL or T
+		//text   : s is empty for NULL
+		template<typename T>
+		T from_db_text(const std::optional<std::string> &s){
+			if constexpr(is_optional<T>){
+				if(!s.has_value()){return T();}
+				return T( BindInfo_t<typename T::value_type>::from_db(s) );
+			}else{
+				return BindInfo_t<T>::from_db(s);
+			}
+		}
+
+		//text   : data is nullptr for NULL, use BindInfo_t::from_db_text when available
+		template<typename T>
+		T from_db_text(const char *data, size_t size){
+			typedef remove_optional<T> value_t;
+			if constexpr(requires{ BindInfo_t<value_t>::from_db_text(data,size); }){
+				if(data==nullptr){
+					if constexpr(is_optional<T>){return T();}
+					else{throw Exception_t<tdb::Tag_psql>("NULL value");}
+				}
+				return T( BindInfo_t<value_t>::from_db_text(data,size) );
+			}else{
+				std::optional<std::string> s;
+				if(data!=nullptr){s.emplace(data,size);}
+				return from_db_text<T>(s);
+			}
+		}
+
+		//binary : data is nullptr for NULL
+		template<typename T>
+		T from_db_binary(const char *data, int size, Oid oid){
+			if constexpr(is_optional<T>){
+				if(data==nullptr){return T();}
+				return T( BindInfo_t<typename T::value_type>::from_db_binary(data,size,oid) );
+			}else{
+				if(data==nullptr){throw Exception_t<tdb::Tag_psql>("NULL value");}
+				return BindInfo_t<T>::from_db_binary(data,size,oid);
+			}
+		}
+
+
 		template<size_t I> struct BindInfo_r{
 
 			template<typename Bind_tt>
-			static constexpr void run_oid(std::array<Oid,std::tuple_size<Bind_tt>::value>& write_here){
-				BindInfo_r<I-1>::template run_oid<Bind_tt>(write_here);
-				typedef typename std::tuple_element<I-1,Bind_tt>::type el_t;
-				write_here[I-1]=BindInfo_t<el_t>::oid;
+			static void run_param_info(
+					bool binary,
+					std::array<Oid,std::tuple_size<Bind_tt>::value>& oid_here,
+					std::array<int,std::tuple_size<Bind_tt>::value>& format_here
+			){
+				BindInfo_r<I-1>::template run_param_info<Bind_tt>(binary,oid_here,format_here);
+				typedef BindInfo_t<typename std::tuple_element<I-1,Bind_tt>::type> info_t;
+				if constexpr(info_t::has_binary){
+					if(binary){
+						oid_here   [I-1]=info_t::binary_oid;
+						format_here[I-1]=FORMAT_BINARY;
+						return;
+					}
+				}
+				oid_here   [I-1]=info_t::oid;
+				format_here[I-1]=FORMAT_TEXT;
 			}
 
-			template<typename Bind_tt>
-			static constexpr void run_format(std::array<int, std::tuple_size<Bind_tt>::value>& write_here){
-				BindInfo_r<I-1>::template run_format<Bind_tt>(write_here);
-				typedef typename std::tuple_element<I-1,Bind_tt>::type el_t;
-				write_here[I-1]=BindInfo_t<el_t>::format;
+			template<typename Return_tt>
+			static constexpr bool run_has_binary(){
+				typedef remove_optional<typename std::tuple_element<I-1,Return_tt>::type> el_t;
+				return BindInfo_t<el_t>::has_binary and BindInfo_r<I-1>::template run_has_binary<Return_tt>();
 			}
 
 			template<typename Bind_tt, typename Bind_t2 >
 			static void run_to_db(
 					std::array<std::string, std::tuple_size<Bind_tt>::value> &write_here,
 					std::array<int, std::tuple_size<Bind_tt>::value> &length,
+					const std::array<int, std::tuple_size<Bind_tt>::value> &format,
 					const Bind_t2 & bind_me
 			){
-				BindInfo_r<I-1>::template run_to_db<Bind_tt,Bind_t2>(write_here,length,bind_me);
-				typedef typename std::tuple_element<I-1,Bind_tt>::type el_t;
-				write_here[I-1] = BindInfo_t<el_t>::to_db( std::get<I-1>(bind_me) ) ;
-				length[I-1]     = write_here[I-1].length();
+				BindInfo_r<I-1>::template run_to_db<Bind_tt,Bind_t2>(write_here,length,format,bind_me);
+				typedef BindInfo_t<typename std::tuple_element<I-1,Bind_tt>::type> info_t;
+
+				bool done = false;
+				if constexpr(info_t::has_binary){
+					if(format[I-1]==FORMAT_BINARY){
+						write_here[I-1].clear();
+						info_t::to_db_binary( std::get<I-1>(bind_me), write_here[I-1] );
+						done = true;
+					}
+				}
+				if(!done){
+					if constexpr(requires{ info_t::to_db_text( std::get<I-1>(bind_me), write_here[I-1] ); }){
+						info_t::to_db_text( std::get<I-1>(bind_me), write_here[I-1] ); //reuse the buffer
+					}else{
+						write_here[I-1] = info_t::to_db( std::get<I-1>(bind_me) ) ;
+					}
+				}
+				length[I-1] = write_here[I-1].length();
 			}
 
 			template<typename Return_tt>
 			static void run_from_db(
 				Return_tt & write_here,
 				const PGresult *res,
-				int row
+				int row,
+				int format = FORMAT_TEXT
 			){
-				BindInfo_r<I-1>::template run_from_db<Return_tt>(write_here,res,row);
+				BindInfo_r<I-1>::template run_from_db<Return_tt>(write_here,res,row,format);
 
 				typedef typename std::tuple_element<I-1,Return_tt>::type el_t;
 
 				//https://www.postgresql.org/docs/9.3/libpq-exec.html
 
+				//strings : assign in place, so that fetch_into reuses their capacity
+				if constexpr(std::is_same_v<remove_optional<el_t>,std::string>){
+					auto &w = std::get<I-1>(write_here);
+					if(PQgetisnull(res,row,I-1)){
+						if constexpr(std::is_same_v<el_t,std::string>){throw Exception_t<tdb::Tag_psql>("NULL value");}
+						else{w.reset(); return;}
+					}
+					const int size = PQgetlength(res,row,I-1);
+
+					std::string *str;
+					if constexpr(std::is_same_v<el_t,std::string>){str = &w;}
+					else{
+						if(!w.has_value()){w.emplace();}
+						str = &w.value();
+					}
+					str->assign(PQgetvalue(res,row,I-1), static_cast<size_t>(size));
+					return;
+				}
 
-				std::optional<std::string> s;
-				if(!PQgetisnull(res,row,I-1)){
-					//not null => get data
-					const size_t data_size = PQgetlength(res,row,I-1);
-					s = std::string();
-					s.value().assign(PQgetvalue(res,row,I-1), data_size);
+				if(format==FORMAT_BINARY){
+					if constexpr(BindInfo_t<remove_optional<el_t>>::has_binary){
+						const char *data = PQgetisnull(res,row,I-1) ? nullptr : PQgetvalue(res,row,I-1);
+						std::get<I-1>(write_here) = from_db_binary<el_t>(data, PQgetlength(res,row,I-1), PQftype(res,I-1));
+						return;
+					}else{
+						throw Exception_t<tdb::Tag_psql>("Cannot fetch in binary format, the type has no binary BindInfo_t");
+					}
 				}
 
-				//assign (even if s is null)
-				std::get<I-1>(write_here)=BindInfo_t<el_t>::from_db( s ) ;
+				//parse PQgetvalue directly (even if null)
+				const char *data = PQgetisnull(res,row,I-1) ? nullptr : PQgetvalue(res,row,I-1);
+				std::get<I-1>(write_here)=from_db_text<el_t>( data, PQgetlength(res,row,I-1) ) ;
 			}
 		};
 
@@ -406,15 +997,20 @@ namespace tdb::psql{
 		template<> struct BindInfo_r<0>{
 
 			template<typename Bind_tt>
-			static constexpr void run_oid(std::array<Oid,std::tuple_size<Bind_tt>::value>& write_here){}
+			static void run_param_info(
+					bool binary,
+					std::array<Oid,std::tuple_size<Bind_tt>::value>& oid_here,
+					std::array<int,std::tuple_size<Bind_tt>::value>& format_here
+			){}
 
-			template<typename Bind_tt>
-			static constexpr void run_format(std::array<int, std::tuple_size<Bind_tt>::value>& write_here){}
+			template<typename Return_tt>
+			static constexpr bool run_has_binary(){return true;}
 
 			template<typename Bind_tt, typename Bind_t2 >
 			static void run_to_db(
 					std::array<std::string, std::tuple_size<Bind_tt>::value> &write_here,
 					std::array<int, std::tuple_size<Bind_tt>::value> &length,
+					const std::array<int, std::tuple_size<Bind_tt>::value> &format,
 					const Bind_t2 & bind_me
 			){}
 
@@ -422,7 +1018,8 @@ namespace tdb::psql{
 			static void run_from_db(
 				Return_tt & write_here,
 				const PGresult *res,
-				int row
+				int row,
+				int format = FORMAT_TEXT
 			){}
 		};
 	}
@@ -430,26 +1027,27 @@ namespace tdb::psql{
 
 
 	template<typename Bind_tt>
-	auto constexpr oid()->std::array<Oid,std::tuple_size<Bind_tt>::value>{
-		std::array<Oid,std::tuple_size<Bind_tt>::value> r = std::array<Oid,std::tuple_size<Bind_tt>::value>();
-		impl::BindInfo_r<std::tuple_size<Bind_tt>::value>::template run_oid<Bind_tt>(r);
-		return r;
+	void param_info(
+			bool binary,
+			std::array<Oid,std::tuple_size<Bind_tt>::value> &oid_here,
+			std::array<int,std::tuple_size<Bind_tt>::value> &format_here
+	){
+		impl::BindInfo_r<std::tuple_size<Bind_tt>::value>::template run_param_info<Bind_tt>(binary,oid_here,format_here);
 	}
 
-	template<typename Bind_tt>
-	auto constexpr format()-> std::array<int,std::tuple_size<Bind_tt>::value>{
-		std::array<int,std::tuple_size<Bind_tt>::value> r=std::array<int,std::tuple_size<Bind_tt>::value>();
-		impl::BindInfo_r<std::tuple_size<Bind_tt>::value>::template run_format<Bind_tt>(r);
-		return r;
+	template<typename Return_tt>
+	constexpr bool has_binary_result(){
+		return impl::BindInfo_r<std::tuple_size<Return_tt>::value>::template run_has_binary<Return_tt>();
 	}
 
 	template<typename Bind_tt, typename Bind_t2 >
 	void to_db  (
 			std::array<std::string, std::tuple_size<Bind_tt>::value> &write_here,
 			std::array<int, std::tuple_size<Bind_tt>::value>         &length,
+			const std::array<int, std::tuple_size<Bind_tt>::value>   &format,
 			const Bind_t2 & bind_me
 	){
-		impl::BindInfo_r<std::tuple_size<Bind_tt>::value>::template run_to_db<Bind_tt,Bind_t2>(write_here, length, bind_me);
+		impl::BindInfo_r<std::tuple_size<Bind_tt>::value>::template run_to_db<Bind_tt,Bind_t2>(write_here, length, format, bind_me);
 	}
 
 
@@ -470,7 +1068,8 @@ namespace tdb::psql{
 		impl::BindInfo_r<expected_n_col>::template run_from_db<Return_tt> (
 				write_here,
 				result.native_result ,
-				result.current_row
+				result.current_row,
+				result.native_format
 		);
 
 
@@ -485,7 +1084,7 @@ template <typename Return_tt, typename Bind_tt>
 struct tdb::Bind_t<tdb::Tag_psql,Return_tt,Bind_tt>{
 	template< typename Bind_t2>
 	static void run(Query_t<tdb::Tag_psql, Return_tt, Bind_tt >& q, const Bind_t2& bind_me){
-		 tdb::psql::template to_db<Bind_tt,Bind_t2> (q.paramValues, q.paramLengths ,bind_me); //bind in q
+		 tdb::psql::template to_db<Bind_tt,Bind_t2> (q.paramValues, q.paramLengths, q.paramFormats, bind_me); //bind in q
 	}
 };
 
@@ -505,6 +1104,7 @@ template<typename Return_tt>
 struct tdb::Count_row_t<tdb::Tag_psql,Return_tt>{
 	static constexpr bool is_implemented = true;
 	static tdb::Rowid<tdb::Tag_psql> run(const tdb::Result_t<tdb::Tag_psql,Return_tt> &result){
+		if(result.native_chunk_size!=0){throw Exception_t<tdb::Tag_psql>("count_row is not available on streaming results (chunk_size!=0)");}
 		return PQntuples(result.native_result);
 	}
 };
@@ -514,27 +1114,35 @@ template<typename Return_tt>
 struct tdb::Try_fetch_t<tdb::Tag_psql,Return_tt>{
 	static constexpr bool is_implemented=true;
 	static std::optional<Return_tt> run(tdb::Result_t<tdb::Tag_psql,Return_tt> &result){
-		//TODO_xxx function must be replaced here, by the correct implementation.
-
-		bool row_exists = result.current_row < tdb::count_row(result);
-
-		auto status = PQresultStatus(result.native_result);
-		if(status ==PGRES_COMMAND_OK ){return std::optional<Return_tt>();} //empty result set
-
-		bool ok = status==PGRES_TUPLES_OK;
-
+		std::optional<Return_tt> r(std::in_place);
+		if(!run_into(result,r.value())){r.reset();}
+		return r;
+	}
 
-		if(ok and row_exists ){
-			std::optional<Return_tt> r =  get_row(result);
-			++result.current_row;//next line
-			return r;
-		}
+	//fetch_into : write in place
+	template<typename Write_here_t>
+	static bool run_into(tdb::Result_t<tdb::Tag_psql,Return_tt> &result, Write_here_t &write_here){
+		while(true){
+			const auto status = PQresultStatus(result.native_result);
+			if(status ==PGRES_COMMAND_OK ){return false;} //empty result set
+
+			bool ok = status==PGRES_TUPLES_OK or status==PGRES_SINGLE_TUPLE;
+			#ifdef LIBPQ_HAS_CHUNK_MODE
+			ok = ok or status==PGRES_TUPLES_CHUNK;
+			#endif
+			if(!ok){throw Exception_t<Tag_psql>("Cannot fetch the data" + psql::result_error(result.native_result) );}
+
+			if(result.current_row < PQntuples(result.native_result) ){
+				get_row(result,write_here);
+				++result.current_row;//next line
+				return true;
+			}
 
-		if(ok and !row_exists ){
-			return  std::optional<Return_tt>();//empty
+			//no more rows in this chunk
+			if(result.native_stream==nullptr){return false;}
+			psql::stream_next(result.native_stream,result.native_result);
+			result.current_row=0;
 		}
-
-		throw Exception_t<Tag_psql>("Cannot fetch the data" );
 	}
 };
 
@@ -556,40 +1164,25 @@ struct tdb::Execute_t <tdb::Tag_psql,Return_tt, Bind_tt >{
 	static void run(Query<tdb::Tag_psql,Return_tt, Bind_tt > &q){
 
 
-		PGresult* res = nullptr;
-		if constexpr(std::tuple_size<Bind_tt>::value == 0){
-			res = PQexec(q.db->native_connection, q.native_sql.c_str() );
-		}else{
-
-			//std::string to c_str
-			std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
-			for(size_t i = 0; i < std::tuple_size<Bind_tt>::value; ++i){
-				paramValues_cstr[i]=q.paramValues[i].c_str();
-			}
-
-			res = PQexecParams(
-					q.db->native_connection,  //connection
-					q.native_sql.c_str(), //sql
-					std::tuple_size<Bind_tt>::value, //nParams
-					q.native_oid.data(),//paramTypes (i.e. oid)
-					paramValues_cstr.data(),  //paramValues
-					q.paramLengths.data(), //paramLengths
-					q.paramFormats.data(), //paramFormats
-					tdb::psql::FORMAT_TEXT
-
-			);
-
+		//the query is already prepared : run it, don't parse the sql again
+		//std::string to c_str
+		std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
+		for(size_t i = 0; i < std::tuple_size<Bind_tt>::value; ++i){
+			paramValues_cstr[i]=q.paramValues[i].c_str();
 		}
 
+		PGresult* res = PQexecPrepared(
+				q.db->native_connection,  //connection
+				q.native_name.c_str(),    //prepared statement name
+				std::tuple_size<Bind_tt>::value, //nParams
+				paramValues_cstr.data(),  //paramValues
+				q.paramLengths.data(), //paramLengths
+				q.paramFormats.data(), //paramFormats
+				q.result_format           //resultFormat
+		);
 
-		if (PQresultStatus(res) != PGRES_COMMAND_OK){
-			std::string msg = "Error in Execute_t: " + psql::result_error(res);
-			PQclear(res);
-			throw Exception_t<tdb::Tag_psql>(msg + "\n  sql: " + q.native_sql );
-		}else{
-			PQclear(res);
-		}
 
+		psql::execute_result(res, q.native_sql);
 	};
 };
 
@@ -609,55 +1202,403 @@ struct tdb::Insert_t  <tdb::Tag_psql,Return_tt,Bind_tt>{
 
 
 
-		//auto res = PQexec(q.native_connection, q.native_sql.c_str() );
+		//the query is already prepared : run it, don't parse the sql again
+		//std::string to c_str
+		std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
+		for(size_t i = 0; i < std::tuple_size<Bind_tt>::value; ++i){
+			paramValues_cstr[i]=q.paramValues[i].c_str();
+		}
 
-		PGresult* res = nullptr;
-		if constexpr(std::tuple_size<Bind_tt>::value == 0){
-			res = PQexec(q.db->native_connection, q.native_sql.c_str() );
-		}else{
+		PGresult* res = PQexecPrepared(
+				q.db->native_connection,  //connection
+				q.native_name.c_str(),    //prepared statement name
+				std::tuple_size<Bind_tt>::value, //nParams
+				paramValues_cstr.data(),  //paramValues
+				q.paramLengths.data(), //paramLengths
+				q.paramFormats.data(), //paramFormats
+				q.result_format           //resultFormat
+		);
+
+		return psql::insert_result(res, q.result_format, q.native_sql);
+	}
+};
+
+
+
+//--- multi rows insert ---
+template<typename Bind_tt>
+tdb::Multi_insert_t<tdb::Tag_psql,Bind_tt>::Multi_insert_t(
+		Connection_t<Tag_psql> &c,
+		const std::string &head,
+		const std::string &tail,
+		size_t nb_rows_
+){
+	const size_t nb_params = nb_rows_*nb_cols;
+
+	//text, or binary when possible, as Query_t
+	psql::param_info<Bind_tt>(c.default_format()==psql::FORMAT_BINARY, rowOid, rowFormats);
+
+	std::vector<Oid> oid(nb_params);
+	paramFormats.resize(nb_params);
+	for(size_t i = 0; i < nb_params; ++i){
+		oid[i]          = rowOid    [i%nb_cols];
+		paramFormats[i] = rowFormats[i%nb_cols];
+	}
+	paramValues     .resize(nb_params);
+	paramValues_cstr.resize(nb_params);
+	paramLengths    .resize(nb_params);
+
+	native_name_holder = new char;
+	native_name = psql::query_name(native_name_holder);
+	native_sql  = impl::multi_insert_sql(head, tail, nb_rows_, nb_cols, true);
 
-			//std::string to c_str
-			std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
-			for(size_t i = 0; i < std::tuple_size<Bind_tt>::value; ++i){
-				paramValues_cstr[i]=q.paramValues[i].c_str();
+	PGresult *res = PQprepare(
+			c.native_connection,
+			native_name.c_str(),
+			native_sql.c_str(),
+			static_cast<int>(nb_params),
+			oid.data()
+	);
+
+	if(PQresultStatus(res) != PGRES_COMMAND_OK){
+		std::string err = PQerrorMessage(c.native_connection) + std::string("\n") + psql::result_error(res);
+		PQclear(res);
+		delete native_name_holder;
+		native_name_holder=nullptr;
+		throw Exception_t<tdb::Tag_psql>("Cannot prepare multi rows insert\n error:\n"+err+ "\nsql\n" + head + " VALUES ... " + tail +"\n");
+	}
+	PQclear(res);
+
+	native_nb_rows = nb_rows_;
+	db=&c;
+}
+
+
+template<typename Bind_tt>
+tdb::Multi_insert_t<tdb::Tag_psql,Bind_tt>::~Multi_insert_t()noexcept(true){
+	if(native_name_holder==nullptr){return;}
+
+	auto l = tdb::impl::connection_lock_guard<tdb::Tag_psql> (*db);
+
+	std::string cleanup_sql= std::string("DEALLOCATE ") +  native_name;
+	auto r = PQexec( db->native_connection ,  cleanup_sql.c_str() );
+	if(PQresultStatus(r)!=PGRES_COMMAND_OK){
+		std::cerr << "CANNOT clean psql prepared statement."
+		  <<"\n  sql       ="<<cleanup_sql
+		  <<"\n  msg       ="<<tdb::psql::result_error(r)
+		  <<std::endl;
+	}
+	PQclear(r);
+	delete native_name_holder;
+}
+
+
+template<typename Bind_tt>
+void tdb::Multi_insert_t<tdb::Tag_psql,Bind_tt>::swap(Multi_insert_t &a)noexcept(true){
+	std::swap(db,a.db);
+	std::swap(native_name_holder,a.native_name_holder);
+	std::swap(native_name,a.native_name);
+	std::swap(native_sql,a.native_sql);
+	std::swap(native_nb_rows,a.native_nb_rows);
+	std::swap(rowValues,a.rowValues);
+	std::swap(rowLengths,a.rowLengths);
+	std::swap(rowOid,a.rowOid);
+	std::swap(rowFormats,a.rowFormats);
+	std::swap(paramValues,a.paramValues);
+	std::swap(paramValues_cstr,a.paramValues_cstr);
+	std::swap(paramLengths,a.paramLengths);
+	std::swap(paramFormats,a.paramFormats);
+}
+
+
+template<typename Bind_tt>
+template<typename It>
+void tdb::Multi_insert_t<tdb::Tag_psql,Bind_tt>::run(It &first){
+	//serialize each row, then move it into the parameters of the statement
+	size_t k = 0;
+	for(size_t i = 0; i < native_nb_rows; ++i, ++first){
+		psql::to_db<Bind_tt>(rowValues, rowLengths, rowFormats, *first);
+		for(size_t j = 0; j < nb_cols; ++j, ++k){
+			paramValues[k].swap(rowValues[j]);
+			paramLengths[k] = rowLengths[j];
+		}
+	}
+	for(size_t i = 0; i < paramValues.size(); ++i){
+		paramValues_cstr[i]=paramValues[i].c_str();
+	}
+
+	PGresult* res = PQexecPrepared(
+			db->native_connection,
+			native_name.c_str(),
+			static_cast<int>(paramValues.size()),
+			paramValues_cstr.data(),
+			paramLengths.data(),
+			paramFormats.data(),
+			psql::FORMAT_TEXT
+	);
+
+	const int status = PQresultStatus(res);
+	const bool ok = (status==PGRES_COMMAND_OK)or(status==PGRES_TUPLES_OK) ;
+	if (!ok){
+		std::string msg = "Error in multi rows insert: " + psql::result_error(res);
+		PQclear(res);
+		throw Exception_t<tdb::Tag_psql>(msg + "\n  sql: " + native_sql.substr(0,256) );
+	}
+	PQclear(res);
+}
+
+
+
+
+//================
+//=== pipeline ===
+//================
+#ifdef LIBPQ_HAS_PIPELINING
+template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+size_t tdb::psql::Pipeline_t::send(Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me, bool read_rowid){
+	assert(q.db==&db);
+	tdb::bind(q,bind_me);
+
+	//std::string to c_str
+	std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
+	for(size_t i = 0; i < std::tuple_size<Bind_tt>::value; ++i){
+		paramValues_cstr[i]=q.paramValues[i].c_str();
+	}
+
+	//parameters are copied in the output buffer : q can be bound again
+	const int sent = PQsendQueryPrepared(
+			db.native_connection,
+			q.native_name.c_str(),
+			std::tuple_size<Bind_tt>::value,
+			paramValues_cstr.data(),
+			q.paramLengths.data(),
+			q.paramFormats.data(),
+			q.result_format
+	);
+	if(!sent){
+		throw Exception_t<tdb::Tag_psql>("Cannot queue query in pipeline\n error:\n"+std::string(PQerrorMessage(db.native_connection))+"\n  sql: " + q.native_sql );
+	}
+
+	queued.push_back(Entry{read_rowid,q.result_format});
+	return queued.size()-1;
+}
+#endif
+
+
+
+
+//===============
+//=== copy in ===
+//===============
+//doc : https://www.postgresql.org/docs/current/sql-copy.html
+
+namespace tdb::psql::impl{
+
+	//text format : \t between columns, \n after rows, \N for NULL
+	inline void copy_text_escape(std::string &write_here, const std::string &s){
+		for(const char c : s){
+			switch(c){
+			case '\\': write_here+="\\\\"; break;
+			case '\n': write_here+="\\n";  break;
+			case '\r': write_here+="\\r";  break;
+			case '\t': write_here+="\\t";  break;
+			default  : write_here+=c;
 			}
+		}
+	}
 
-			res = PQexecParams(
-					q.db->native_connection,  //connection
-					q.native_sql.c_str(), //sql
-					std::tuple_size<Bind_tt>::value, //nParams
-					q.native_oid.data(),//paramTypes (i.e. oid)
-					paramValues_cstr.data(),  //paramValues
-					q.paramLengths.data(), //paramLengths
-					q.paramFormats.data(), //paramFormats
-					tdb::psql::FORMAT_TEXT
+	template<typename T, typename V>
+	void copy_text_value(std::string &write_here, const V &v){
+		if constexpr(is_optional<T>){
+			if(!v.has_value()){write_here+="\\N"; return;}
+			copy_text_value<typename T::value_type>(write_here, v.value());
+		}else{
+			if constexpr(has_text_kernel<T>){
+				std::string tmp; //numbers : short string optimization, no allocation
+				BindInfo_t<T>::to_db_text(v,tmp);
+				copy_text_escape(write_here, tmp);
+			}else{
+				copy_text_escape(write_here, BindInfo_t<T>::to_db(v));
+			}
+		}
+	}
 
-			);
+	//binary format : int32 length (-1 for NULL), then the value
+	template<typename T, typename V>
+	void copy_binary_value(std::string &write_here, const V &v){
+		if constexpr(is_optional<T>){
+			if(!v.has_value()){put_be(write_here, static_cast<std::uint32_t>(-1)); return;}
+			copy_binary_value<typename T::value_type>(write_here, v.value());
+		}else{
+			const size_t pos = write_here.size();
+			put_be(write_here, std::uint32_t(0));
+			BindInfo_t<T>::to_db_binary(v, write_here);
+			const size_t length = write_here.size()-pos-4;
+			if(length > static_cast<size_t>(std::numeric_limits<std::int32_t>::max())){throw Exception_t<tdb::Tag_psql>("Copy_in_t : value too large");}
+			std::string l;
+			put_be(l, static_cast<std::uint32_t>(length));
+			write_here.replace(pos,4,l);
+		}
+	}
 
+	template<bool binary, typename Bind_tt, typename Bind_t2, size_t... I>
+	void copy_row(std::string &write_here, const Bind_t2 &row, std::index_sequence<I...>){
+		if constexpr(binary){
+			put_be(write_here, static_cast<std::uint16_t>(sizeof...(I)));
+			(copy_binary_value<typename std::tuple_element<I,Bind_tt>::type>(write_here, std::get<I>(row)),...);
+		}else{
+			size_t i = 0;
+			((write_here += (i++==0 ? "" : "\t"), copy_text_value<typename std::tuple_element<I,Bind_tt>::type>(write_here, std::get<I>(row))),...);
+			write_here+='\n';
 		}
+	}
 
-		const int status = PQresultStatus(res);
-		const bool ok = (status==PGRES_COMMAND_OK)or(status==PGRES_TUPLES_OK) ;
-		if (!ok){
-			std::string msg = "Error in Insert_t: " + psql::result_error(res);
-			PQclear(res);
-			throw Exception_t<tdb::Tag_psql>(msg+ "\n  sql: " + q.native_sql );
+	template<typename Bind_tt>
+	constexpr bool has_binary_copy(){
+		return has_binary_result<Bind_tt>(); //same requirements : all types (optional removed) have a binary BindInfo_t
+	}
+}
+
+
+template<typename Bind_tt>
+tdb::psql::Copy_in_t<Bind_tt>::Copy_in_t(Connection_t<Tag_psql> &c, const std::string &target, int format_):db(c),format(format_){
+	if(format!=FORMAT_TEXT and format!=FORMAT_BINARY){throw Exception_t<tdb::Tag_psql>("Invalid psql format : "+std::to_string(format));}
+
+	std::string sql = "COPY "+target+" FROM STDIN";
+	if(format==FORMAT_BINARY){
+		if constexpr(!impl::has_binary_copy<Bind_tt>()){
+			throw Exception_t<tdb::Tag_psql>("Cannot COPY in binary format, some types have no binary BindInfo_t, target="+target);
 		}
+		sql+=" (FORMAT binary)";
+	}
+	impl::copy_in_start(db.native_connection, sql);
 
-		//nothing was inserted : return 0
-		int nb_rows = PQntuples(res);
-		if(nb_rows==0){return 0;}
+	if(format==FORMAT_BINARY){
+		buffer.append("PGCOPY\n\377\r\n\0",11); //signature
+		impl::put_be(buffer, std::uint32_t(0));   //flags
+		impl::put_be(buffer, std::uint32_t(0));   //header extension length
+	}
+}
 
 
+template<typename Bind_tt>
+tdb::psql::Copy_in_t<Bind_tt>::~Copy_in_t(){
+	if(is_finished){return;}
+	try{
+		impl::copy_in_end(db.native_connection,"Copy_in_t destroyed before finish()");
+	}catch(...){}
+}
 
-		std::tuple<Rowid<tdb::Tag_psql>> write_here;
-		psql::impl::BindInfo_r<1>::template run_from_db<  std::tuple<Rowid<tdb::Tag_psql>>  > (
-				write_here,
-				res,
-				nb_rows-1 //last row
-		);
 
-		PQclear(res);
-		return std::get<0>(write_here) ;
+template<typename Bind_tt>
+template<typename Bind_t2>
+void tdb::psql::Copy_in_t<Bind_tt>::add(const Bind_t2 &row){
+	static_assert(std::tuple_size<Bind_t2>::value == std::tuple_size<Bind_tt>::value, "Copy_in_t : wrong number of columns");
+	assert(!is_finished);
+
+	static constexpr auto columns = std::make_index_sequence<std::tuple_size<Bind_tt>::value>();
+	if constexpr(impl::has_binary_copy<Bind_tt>()){
+		if(format==FORMAT_BINARY){impl::copy_row<true,Bind_tt>(buffer, row, columns);}
+		else                     {impl::copy_row<false,Bind_tt>(buffer, row, columns);}
+	}else{
+		impl::copy_row<false,Bind_tt>(buffer, row, columns); //binary is rejected by the constructor
 	}
-};
+	if(buffer.size()>=flush_size){flush();}
+}
+
+
+template<typename Bind_tt>
+void tdb::psql::Copy_in_t<Bind_tt>::flush(){
+	impl::copy_in_put(db.native_connection, buffer);
+}
+
+
+template<typename Bind_tt>
+long long tdb::psql::Copy_in_t<Bind_tt>::finish(){
+	assert(!is_finished);
+	if(format==FORMAT_BINARY){impl::put_be(buffer, static_cast<std::uint16_t>(-1));} //trailer
+
+	is_finished = true;
+	try{
+		flush();
+	}catch(...){
+		try{impl::copy_in_end(db.native_connection,"Copy_in_t : cannot send data");}catch(...){}
+		throw;
+	}
+	return impl::copy_in_end(db.native_connection,nullptr);
+}
+
+
+
+
+//================
+//=== copy out ===
+//================
+
+namespace tdb::psql::impl{
+
+	template<typename Return_tt, size_t... I>
+	void copy_out_decode_text(Return_tt &write_here, const std::vector<std::optional<std::string>> &fields, std::index_sequence<I...>){
+		((std::get<I>(write_here) = from_db_text<typename std::tuple_element<I,Return_tt>::type>(fields[I])),...);
+	}
+
+	//COPY binary doesn't send the column types : trust Return_tt
+	template<typename Return_tt, size_t... I>
+	void copy_out_decode_binary(Return_tt &write_here, const std::vector<Copy_field> &fields, std::index_sequence<I...>){
+		((std::get<I>(write_here) = from_db_binary<typename std::tuple_element<I,Return_tt>::type>(
+				fields[I].data,
+				fields[I].size,
+				BindInfo_t<remove_optional<typename std::tuple_element<I,Return_tt>::type>>::binary_oid
+		)),...);
+	}
+}
+
+
+template<typename Return_tt>
+tdb::psql::Copy_out_t<Return_tt>::Copy_out_t(Connection_t<Tag_psql> &c, const std::string &sql, int format_):db(c),format(format_){
+	if(format!=FORMAT_TEXT and format!=FORMAT_BINARY){throw Exception_t<tdb::Tag_psql>("Invalid psql format : "+std::to_string(format));}
+
+	std::string copy_sql = "COPY ("+sql+") TO STDOUT";
+	if(format==FORMAT_BINARY){
+		if constexpr(!has_binary_result<Return_tt>()){
+			throw Exception_t<tdb::Tag_psql>("Cannot COPY in binary format, some returned types have no binary BindInfo_t, sql="+sql);
+		}
+		copy_sql+=" (FORMAT binary)";
+	}
+	impl::copy_out_start(db.native_connection, copy_sql);
+	native_stream = db.native_connection;
+}
+
+
+template<typename Return_tt>
+tdb::psql::Copy_out_t<Return_tt>::~Copy_out_t(){
+	impl::copy_out_cancel(native_stream); //unfinished copy : the connection must be usable again
+}
+
+
+template<typename Return_tt>
+std::optional<Return_tt> tdb::psql::Copy_out_t<Return_tt>::try_fetch(){
+	static constexpr size_t n_col = std::tuple_size<Return_tt>::value;
+	static constexpr auto columns = std::make_index_sequence<n_col>();
+
+	while(native_stream!=nullptr){
+		if(!impl::copy_out_row(native_stream,row)){break;} //no more rows
+
+		std::optional<Return_tt> r(std::in_place);
+		if constexpr(has_binary_result<Return_tt>()){
+			if(format==FORMAT_BINARY){
+				if(!impl::copy_out_split_binary(row,header_read,binary_fields)){continue;} //trailer
+				if(binary_fields.size()!=n_col){throw Exception_t<tdb::Tag_psql>("Copy_out_t : the row has "+std::to_string(binary_fields.size())+" columns, Return_tt has "+std::to_string(n_col));}
+				impl::copy_out_decode_binary(r.value(), binary_fields, columns);
+				return r;
+			}
+		}
+
+		impl::copy_out_split_text(row,text_fields);
+		if(text_fields.size()!=n_col){throw Exception_t<tdb::Tag_psql>("Copy_out_t : the row has "+std::to_string(text_fields.size())+" columns, Return_tt has "+std::to_string(n_col));}
+		impl::copy_out_decode_text(r.value(), text_fields, columns);
+		return r;
+	}
+	return std::optional<Return_tt>();
+}
+
@@ -0,0 +1,197 @@
+#include "tdb_psql_async.hpp"
+
+#include <cerrno>
+#include <cstring> //strerror
+#include <memory>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>  //close
+
+
+//==================
+//=== Event_loop ===
+//==================
+//doc : https://man7.org/linux/man-pages/man7/epoll.7.html
+
+namespace{
+	tdb::psql::impl::Root_task make_root(tdb::psql::Task<void> t){
+		co_await t;
+	}
+
+	[[noreturn]] void throw_errno(const std::string &what){
+		throw tdb::Exception_t<tdb::Tag_psql>("Event_loop : "+what+", error="+std::string(std::strerror(errno)));
+	}
+}
+
+
+void tdb::psql::impl::Root_task::promise_type::unhandled_exception()noexcept{
+	if(!loop->error){loop->error = std::current_exception();}
+}
+
+tdb::psql::impl::Root_task::promise_type::~promise_type(){
+	loop->roots.erase(this);
+}
+
+
+tdb::psql::Event_loop::Event_loop(){
+	native_epoll = epoll_create1(EPOLL_CLOEXEC);
+	if(native_epoll<0){throw_errno("cannot create epoll");}
+}
+
+
+tdb::psql::Event_loop::~Event_loop(){
+	ready.clear();
+	waiting.clear();
+	//destroy the suspended tasks (each one removes itself from roots)
+	while(!roots.empty()){
+		impl::Root_task::promise_type *p = *roots.begin();
+		std::coroutine_handle<impl::Root_task::promise_type>::from_promise(*p).destroy();
+	}
+	close(native_epoll);
+}
+
+
+void tdb::psql::Event_loop::spawn(Task<void> t){
+	impl::Root_task r = make_root(std::move(t));
+	r.handle.promise().loop = this;
+	roots.insert(&r.handle.promise());
+	ready.push_back(r.handle);
+}
+
+
+void tdb::psql::Event_loop::watch(Fd_awaiter &a){
+	if(waiting.count(a.fd)!=0){
+		throw Exception_t<Tag_psql>("Event_loop : another task already waits on fd "+std::to_string(a.fd)+" (one query at a time per connection)");
+	}
+
+	epoll_event ev;
+	ev.events   = a.events | EPOLLONESHOT;
+	ev.data.ptr = &a;
+
+	//the fd stays registered (disabled by EPOLLONESHOT) after each wait
+	if(epoll_ctl(native_epoll, EPOLL_CTL_MOD, a.fd, &ev)!=0){
+		if(errno!=ENOENT or epoll_ctl(native_epoll, EPOLL_CTL_ADD, a.fd, &ev)!=0){
+			throw_errno("cannot watch fd "+std::to_string(a.fd));
+		}
+	}
+	waiting.emplace(a.fd,&a);
+}
+
+
+void tdb::psql::Event_loop::run(){
+	std::vector<epoll_event> events(64);
+
+	while(!roots.empty()){
+
+		while(!ready.empty()){
+			std::coroutine_handle<> h = ready.front();
+			ready.pop_front();
+			h.resume();
+			if(error){std::rethrow_exception(std::exchange(error,nullptr));}
+		}
+		if(roots.empty()){break;}
+
+		if(waiting.empty()){
+			throw Exception_t<Tag_psql>("Event_loop : deadlock, "+std::to_string(roots.size())+" tasks wait for something else than the loop");
+		}
+
+		const int n = epoll_wait(native_epoll, events.data(), static_cast<int>(events.size()), -1);
+		if(n<0){
+			if(errno==EINTR){continue;}
+			throw_errno("epoll_wait failed");
+		}
+
+		for(int i = 0; i < n; ++i){
+			Fd_awaiter *a = static_cast<Fd_awaiter*>(events[i].data.ptr);
+			a->ready_events = events[i].events;
+			waiting.erase(a->fd);
+			ready.push_back(a->handle);
+		}
+	}
+}
+
+
+
+
+//=======================
+//=== async functions ===
+//=======================
+//doc : https://www.postgresql.org/docs/current/libpq-async.html
+
+namespace{
+	struct Pg_result_delete{
+		void operator()(PGresult *r)const{PQclear(r);}
+	};
+
+	//libpq must not block on send while the query is in flight
+	struct Nonblocking_guard{
+		explicit Nonblocking_guard(PGconn *c_):c(c_){
+			if(PQsetnonblocking(c,1)!=0){
+				throw tdb::Exception_t<tdb::Tag_psql>("Cannot set psql nonblocking mode, error="+std::string(PQerrorMessage(c)));
+			}
+		}
+		~Nonblocking_guard(){PQsetnonblocking(c,0);}
+		Nonblocking_guard(const Nonblocking_guard&)=delete;
+		Nonblocking_guard& operator=(const Nonblocking_guard&)=delete;
+		PGconn *c;
+	};
+
+	void consume_input(PGconn *c, const std::string &sql){
+		if(!PQconsumeInput(c)){
+			throw tdb::Exception_t<tdb::Tag_psql>("Cannot read psql result\n error:\n"+std::string(PQerrorMessage(c))+"\n  sql: " + sql );
+		}
+	}
+}
+
+
+tdb::psql::Task<PGresult*> tdb::psql::impl::async_exec(
+		Event_loop &loop,
+		PGconn *c,
+		const char *name,
+		int nb_params,
+		const char * const *values,
+		const int *lengths,
+		const int *formats,
+		int result_format,
+		const std::string &sql
+){
+	if(c==nullptr or PQstatus(c)!=CONNECTION_OK){
+		throw Exception_t<Tag_psql>("Cannot run an async query, the connection is not open\n  sql: " + sql );
+	}
+	if(PQisBusy(c) or PQtransactionStatus(c)==PQTRANS_ACTIVE){
+		throw Exception_t<Tag_psql>("Cannot run an async query, another query is in flight on this connection\n  sql: " + sql );
+	}
+
+	const int fd = PQsocket(c);
+	Nonblocking_guard nonblocking(c);
+
+	if(!PQsendQueryPrepared(c, name, nb_params, values, lengths, formats, result_format)){
+		throw Exception_t<tdb::Tag_psql>("Cannot send query\n error:\n"+std::string(PQerrorMessage(c))+"\n  sql: " + sql );
+	}
+
+	//send : the server may need to be read before it accepts more data
+	while(true){
+		const int f = PQflush(c);
+		if(f==0){break;}
+		if(f<0){throw Exception_t<tdb::Tag_psql>("Cannot send query\n error:\n"+std::string(PQerrorMessage(c))+"\n  sql: " + sql );}
+		const std::uint32_t ev = co_await loop.wait(fd, EPOLLIN | EPOLLOUT);
+		if(ev & (EPOLLIN|EPOLLERR|EPOLLHUP)){consume_input(c,sql);}
+	}
+
+	//receive : one result, then nullptr
+	std::unique_ptr<PGresult,Pg_result_delete> r;
+	while(true){
+		while(PQisBusy(c)){
+			co_await loop.wait(fd, EPOLLIN);
+			consume_input(c,sql);
+		}
+		PGresult *next = PQgetResult(c);
+		if(next==nullptr){break;}
+		if(!r){r.reset(next);}
+		else  {PQclear(next);}
+	}
+
+	if(!r){throw Exception_t<tdb::Tag_psql>("No psql result\n error:\n"+std::string(PQerrorMessage(c))+"\n  sql: " + sql );}
+	co_return r.release();
+}
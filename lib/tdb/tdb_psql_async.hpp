@@ -0,0 +1,332 @@
+#ifndef LIB_TDB_TDB_PSQL_ASYNC_HPP_
+#define LIB_TDB_TDB_PSQL_ASYNC_HPP_
+
+//--- asynchronous psql queries with C++20 coroutines (linux, epoll) ---
+//One thread drives many queries in flight, on many connections :
+//a coroutine that waits for the server is suspended, and resumed by the
+//Event_loop when the socket of its connection is ready.
+//
+//tdb::psql::Task<long long> count(tdb::psql::Event_loop &loop, tdb::Query<Tag_psql,std::tuple<long long>,std::tuple<int>> &q, int i){
+//  auto result = co_await tdb::psql::async_get_result_a(loop, q, i);
+//  co_return std::get<0>(tdb::try_fetch(result).value());
+//}
+//
+//tdb::psql::Event_loop loop;
+//for(...){loop.spawn(some_task(loop, connection[i]));} //started by run()
+//loop.run();                                           //until all the tasks are done
+//long long n = loop.run(count(loop,q,42));             //run a task, return its result
+//
+//- Queries are prepared as usual (synchronously), only their execution is asynchronous.
+//- The whole result set is received before the result is returned (chunk_size is ignored).
+//- A connection runs one query at a time : don't await two queries on the same connection
+//  together (the second one throws). The connection mutex is NOT locked (a std::mutex
+//  cannot be held across a co_await) : use each connection from the loop thread only.
+//- async_xxx(...) binds its parameters immediately, and copies them into the Task : the query is
+//  sent when the Task is awaited, and q can be bound again (ex : two Tasks on q) meanwhile.
+//- The loop, the queries and the connections must outlive the tasks that use them.
+
+#include "tdb_psql.hpp"
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace tdb::psql{
+
+	struct Event_loop;
+	template<typename T=void> struct Task;
+
+
+	//============
+	//=== Task ===
+	//============
+	//Lazy coroutine : it starts when it is awaited (or run by the Event_loop),
+	//the awaiting coroutine is resumed when it is done.
+	namespace impl{
+
+		struct Task_promise_base{
+			std::coroutine_handle<> continuation = std::noop_coroutine();
+			std::exception_ptr      error;
+
+			std::suspend_always initial_suspend()noexcept{return {};}
+
+			struct Final_awaiter{
+				bool await_ready()noexcept{return false;}
+				template<typename Promise_t>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise_t> h)noexcept{return h.promise().continuation;}
+				void await_resume()noexcept{}
+			};
+			Final_awaiter final_suspend()noexcept{return {};}
+
+			void unhandled_exception()noexcept{error = std::current_exception();}
+		};
+
+		template<typename T>
+		struct Task_promise:Task_promise_base{
+			std::optional<T> value;
+			Task<T> get_return_object();
+
+			template<typename U>
+			void return_value(U &&u){value.emplace(std::forward<U>(u));}
+
+			T result(){
+				if(error){std::rethrow_exception(error);}
+				return std::move(value.value());
+			}
+		};
+
+		template<>
+		struct Task_promise<void>:Task_promise_base{
+			Task<void> get_return_object();
+			void return_void(){}
+			void result(){if(error){std::rethrow_exception(error);}}
+		};
+	}
+
+
+	template<typename T>
+	struct [[nodiscard]] Task{
+		typedef impl::Task_promise<T> promise_type;
+		typedef std::coroutine_handle<promise_type> handle_type;
+
+		//movable, NOT copiable
+		Task(Task &&a)noexcept(true):handle(std::exchange(a.handle,nullptr)){}
+		Task& operator=(Task &&a)noexcept(true){std::swap(handle,a.handle); return *this;}
+		Task(const Task&)=delete;
+		Task& operator=(const Task&)=delete;
+
+		~Task(){if(handle){handle.destroy();}}
+
+		//awaitable
+		bool await_ready()const noexcept{return !handle or handle.done();}
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)noexcept{
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+		T await_resume(){return handle.promise().result();}
+
+		private:
+		friend promise_type;
+		explicit Task(handle_type h)noexcept(true):handle(h){}
+		handle_type handle;
+	};
+
+	namespace impl{
+		template<typename T>
+		Task<T> Task_promise<T>::get_return_object(){return Task<T>(std::coroutine_handle<Task_promise<T>>::from_promise(*this));}
+
+		inline
+		Task<void> Task_promise<void>::get_return_object(){return Task<void>(std::coroutine_handle<Task_promise<void>>::from_promise(*this));}
+	}
+
+
+
+	//==================
+	//=== Event_loop ===
+	//==================
+	namespace impl{
+		//detached coroutine owned by the loop, runs a Task<void>
+		struct Root_task{
+			struct promise_type{
+				Event_loop *loop = nullptr;
+
+				Root_task get_return_object(){return Root_task{std::coroutine_handle<promise_type>::from_promise(*this)};}
+				std::suspend_always initial_suspend()noexcept{return {};}
+				std::suspend_never  final_suspend()  noexcept{return {};} //the frame destroys itself
+				void return_void(){}
+				void unhandled_exception()noexcept;
+				~promise_type();
+			};
+			std::coroutine_handle<promise_type> handle;
+		};
+	}
+
+
+	struct Event_loop{
+		Event_loop();
+		~Event_loop(); //destroy the unfinished tasks
+
+		//NOT copiable, NOT movable (suspended coroutines point to the loop)
+		Event_loop(Event_loop&&)                =delete;
+		Event_loop& operator=(Event_loop&&)     =delete;
+		Event_loop(const Event_loop&)           =delete;
+		Event_loop& operator=(const Event_loop&)=delete;
+
+		//run t in the loop (it starts at the next run)
+		void spawn(Task<void> t);
+
+		//resume the tasks until they are all done.
+		//an exception that escapes a task stops the loop and is rethrown
+		//(the other tasks are kept, and continue at the next run)
+		void run();
+
+		//spawn t, run, return the result of t
+		template<typename T>
+		T run(Task<T> t);
+
+		//number of tasks not finished
+		size_t size()const{return roots.size();}
+
+		//--- awaitable : wait until fd is ready for events (EPOLLIN, EPOLLOUT...) ---
+		//return the ready events (may contain EPOLLERR or EPOLLHUP)
+		//only one coroutine at a time can wait on a given fd (the others throw)
+		struct Fd_awaiter{
+			Event_loop &loop;
+			int fd;
+			std::uint32_t events;
+			std::uint32_t ready_events = 0;
+			std::coroutine_handle<> handle;
+
+			bool await_ready()const noexcept{return false;}
+			void await_suspend(std::coroutine_handle<> h){handle = h; loop.watch(*this);}
+			std::uint32_t await_resume()const noexcept{return ready_events;}
+		};
+		Fd_awaiter wait(int fd, std::uint32_t events){return Fd_awaiter{*this,fd,events,0,{}};}
+
+
+		private:
+		friend struct impl::Root_task::promise_type;
+
+		void watch(Fd_awaiter &a);
+
+		int native_epoll = -1; //OWNED
+		std::deque<std::coroutine_handle<> > ready;  //to resume
+		std::unordered_set<impl::Root_task::promise_type*> roots; //unfinished tasks
+		std::unordered_map<int,Fd_awaiter*> waiting; //by fd : one Fd_awaiter per fd
+		std::exception_ptr         error;            //escaped from a task
+	};
+
+
+	template<typename T>
+	T Event_loop::run(Task<T> t){
+		std::optional<T> r;
+		spawn([](Task<T> t_, std::optional<T> &r_)->Task<void>{r_.emplace(co_await t_);}(std::move(t),r));
+		run();
+		return std::move(r.value());
+	}
+
+	template<>
+	inline void Event_loop::run(Task<void> t){
+		spawn(std::move(t));
+		run();
+	}
+
+
+
+	//=======================
+	//=== async functions ===
+	//=======================
+	namespace impl{
+		//send the bound query q (PQsendQueryPrepared), wait for its result.
+		//the result is owned by the caller.
+		Task<PGresult*> async_exec(Event_loop &loop, PGconn *c, const char *name, int nb_params, const char * const *values, const int *lengths, const int *formats, int result_format, const std::string &sql);
+
+		//parameters of q, copied into the coroutine frame when async_xxx is called :
+		//q can be bound again (ex : by another async_xxx) before the first Task is awaited
+		template<size_t N>
+		struct Async_params{
+			std::array<std::string,N> values;
+			std::array<int,N>         lengths;
+			std::array<int,N>         formats;
+		};
+
+		template<typename Return_tt, typename Bind_tt>
+		Async_params<std::tuple_size<Bind_tt>::value> async_params(const Query_t<Tag_psql,Return_tt,Bind_tt> &q){
+			return {q.paramValues, q.paramLengths, q.paramFormats};
+		}
+
+		//p lives in the frame of the caller, which awaits this task at once
+		template<typename Return_tt, typename Bind_tt>
+		Task<PGresult*> async_exec(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Async_params<std::tuple_size<Bind_tt>::value> &p){
+			//std::string to c_str (copied by libpq when the query is sent)
+			std::array<const char *, std::tuple_size<Bind_tt>::value > paramValues_cstr;
+			for(size_t i = 0; i < std::tuple_size<Bind_tt>::value; ++i){
+				paramValues_cstr[i]=p.values[i].c_str();
+			}
+			co_return co_await async_exec(
+					loop,
+					q.db->native_connection,
+					q.native_name.c_str(),
+					std::tuple_size<Bind_tt>::value,
+					paramValues_cstr.data(),
+					p.lengths.data(),
+					p.formats.data(),
+					q.result_format,
+					q.native_sql
+			);
+		}
+
+		template<typename Return_tt, typename Bind_tt>
+		Task<Result_t<Tag_psql,Return_tt> > async_get_result(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, Async_params<std::tuple_size<Bind_tt>::value> p){
+			tdb::impl::Execute_probe_guard<Query_t<Tag_psql,Return_tt,Bind_tt> > probe(q);
+			PGresult *res = co_await async_exec(loop,q,p);
+			Result_t<Tag_psql,Return_tt> r(res,q.result_format);
+			probe.hand_over(r);
+			co_return r;
+		}
+
+		template<typename Return_tt, typename Bind_tt>
+		Task<void> async_execute(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, Async_params<std::tuple_size<Bind_tt>::value> p){
+			tdb::impl::Execute_probe_guard<Query_t<Tag_psql,Return_tt,Bind_tt> > probe(q);
+			psql::execute_result(co_await async_exec(loop,q,p), q.native_sql);
+		}
+
+		template<typename Return_tt, typename Bind_tt>
+		Task<Rowid<Tag_psql> > async_insert(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, Async_params<std::tuple_size<Bind_tt>::value> p){
+			tdb::impl::Execute_probe_guard<Query_t<Tag_psql,Return_tt,Bind_tt> > probe(q);
+			co_return psql::insert_result(co_await async_exec(loop,q,p), q.result_format, q.native_sql);
+		}
+	}
+
+
+	//--- get_result ---
+	template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+	Task<Result_t<Tag_psql,Return_tt> > async_get_result(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me){
+		tdb::bind(q,bind_me);
+		return impl::async_get_result(loop,q,impl::async_params(q));
+	}
+
+	template<typename Return_tt, typename Bind_tt, typename... A>
+	Task<Result_t<Tag_psql,Return_tt> > async_get_result_a(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const A&... bind_me){
+		tdb::bind_a(q,bind_me...);
+		return impl::async_get_result(loop,q,impl::async_params(q));
+	}
+
+
+	//--- execute ---
+	template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+	Task<void> async_execute(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me){
+		tdb::bind(q,bind_me);
+		return impl::async_execute(loop,q,impl::async_params(q));
+	}
+
+	template<typename Return_tt, typename Bind_tt, typename... A>
+	Task<void> async_execute_a(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const A&... bind_me){
+		tdb::bind_a(q,bind_me...);
+		return impl::async_execute(loop,q,impl::async_params(q));
+	}
+
+
+	//--- insert ---
+	template<typename Return_tt, typename Bind_tt, typename Bind_t2>
+	Task<Rowid<Tag_psql> > async_insert(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const Bind_t2 &bind_me){
+		tdb::bind(q,bind_me);
+		return impl::async_insert(loop,q,impl::async_params(q));
+	}
+
+	template<typename Return_tt, typename Bind_tt, typename... A>
+	Task<Rowid<Tag_psql> > async_insert_a(Event_loop &loop, Query_t<Tag_psql,Return_tt,Bind_tt> &q, const A&... bind_me){
+		tdb::bind_a(q,bind_me...);
+		return impl::async_insert(loop,q,impl::async_params(q));
+	}
+
+}//end namespace tdb::psql
+
+
+
+#endif /* LIB_TDB_TDB_PSQL_ASYNC_HPP_ */
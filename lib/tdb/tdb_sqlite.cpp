@@ -1,5 +1,10 @@
 #include "tdb_sqlite.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <new>
 
 //====================
 //=== Connection_t ===
@@ -39,6 +44,7 @@ void tdb::Connection_t<tdb::Tag_sqlite>::cstr_limits(){
 	};
 	read_limit(sqlite_max_length_range             , sqlite_max_length_value);
 	read_limit(sqlite_max_column_range             , sqlite_max_column_value);
+	read_limit(sqlite_max_sql_length_range         , sqlite_max_sql_length_value);
 	read_limit(sqlite_max_expr_depth_range         , sqlite_max_expr_depth_value);
 	read_limit(sqlite_max_function_arg_range       , sqlite_max_function_arg_value);
 	read_limit(sqlite_max_compound_select_range    , sqlite_max_compound_select_value);
@@ -57,6 +63,7 @@ void tdb::Connection_t<tdb::Tag_sqlite>::disconnect(){
 
 	if(native_connection==nullptr){return;}
 
+	query_cache.clear(); //finalize cached statements before closing
 	auto status = sqlite3_close_v2(native_connection);
 	native_connection=nullptr;
 
@@ -64,10 +71,103 @@ void tdb::Connection_t<tdb::Tag_sqlite>::disconnect(){
 }
 
 
-void tdb::Connection_t<tdb::Tag_sqlite>::connect(const std::string &db_name){
+namespace{
+	//immutable=1 needs an URI filename, percent encode the characters that have a meaning in URIs
+	//doc : https://www.sqlite.org/uri.html
+	std::string sqlite_immutable_uri(const std::string &db_name){
+		if(db_name.rfind("file:",0)==0){
+			return db_name + (db_name.find('?')==std::string::npos ? "?" : "&") + "immutable=1";
+		}
+		std::string r="file:";
+		for(char c : db_name){
+			switch(c){
+			case '%' : r+="%25"; break;
+			case '?' : r+="%3f"; break;
+			case '#' : r+="%23"; break;
+			default  : r+=c;
+			}
+		}
+		return r+"?immutable=1";
+	}
+
+	const char* pragma_str(tdb::sqlite::Journal_mode m){
+		switch(m){
+		case tdb::sqlite::Journal_mode::Delete   : return "DELETE";
+		case tdb::sqlite::Journal_mode::Truncate : return "TRUNCATE";
+		case tdb::sqlite::Journal_mode::Persist  : return "PERSIST";
+		case tdb::sqlite::Journal_mode::Memory   : return "MEMORY";
+		case tdb::sqlite::Journal_mode::Wal      : return "WAL";
+		case tdb::sqlite::Journal_mode::Off      : return "OFF";
+		}
+		throw tdb::Exception_t<tdb::Tag_sqlite>("wrong sqlite journal_mode");
+	}
+
+	const char* pragma_str(tdb::sqlite::Synchronous m){
+		switch(m){
+		case tdb::sqlite::Synchronous::Off    : return "OFF";
+		case tdb::sqlite::Synchronous::Normal : return "NORMAL";
+		case tdb::sqlite::Synchronous::Full   : return "FULL";
+		case tdb::sqlite::Synchronous::Extra  : return "EXTRA";
+		}
+		throw tdb::Exception_t<tdb::Tag_sqlite>("wrong sqlite synchronous");
+	}
+
+	const char* pragma_str(tdb::sqlite::Temp_store m){
+		switch(m){
+		case tdb::sqlite::Temp_store::Default : return "DEFAULT";
+		case tdb::sqlite::Temp_store::File    : return "FILE";
+		case tdb::sqlite::Temp_store::Memory  : return "MEMORY";
+		}
+		throw tdb::Exception_t<tdb::Tag_sqlite>("wrong sqlite temp_store");
+	}
+
+	//pragmas are run with sqlite3_exec : no need to keep them in the query cache, and some return a row
+	void exec_pragma(sqlite3 *c, const std::string &sql){
+		char *err = nullptr;
+		int rc = sqlite3_exec(c, sql.c_str(), nullptr, nullptr, &err);
+		if(rc!=SQLITE_OK){
+			std::string msg = err ? err : sqlite3_errmsg(c);
+			sqlite3_free(err);
+			throw tdb::Exception_t<tdb::Tag_sqlite>("Cannot set sqlite option, error="+msg+", sql="+sql);
+		}
+	}
+}
+
+
+void tdb::Connection_t<tdb::Tag_sqlite>::apply_options(){
+	const sqlite::Options &o = native_options;
+
+	//busy_timeout first : the other pragmas may need to wait on a lock
+	if(o.busy_timeout){sqlite3_busy_timeout(native_connection,o.busy_timeout.value());}
+
+	//page_size must be set before WAL (and before the first table is created)
+	if(o.page_size   ){exec_pragma(native_connection, "PRAGMA page_size = "   + std::to_string(o.page_size.value()));}
+	if(o.journal_mode){exec_pragma(native_connection, std::string("PRAGMA journal_mode = ") + pragma_str(o.journal_mode.value()));}
+	if(o.synchronous ){exec_pragma(native_connection, std::string("PRAGMA synchronous = ")  + pragma_str(o.synchronous.value()));}
+	if(o.cache_size  ){exec_pragma(native_connection, "PRAGMA cache_size = "  + std::to_string(o.cache_size.value()));}
+	if(o.mmap_size   ){exec_pragma(native_connection, "PRAGMA mmap_size = "   + std::to_string(o.mmap_size.value()));}
+	if(o.temp_store  ){exec_pragma(native_connection, std::string("PRAGMA temp_store = ")   + pragma_str(o.temp_store.value()));}
+	if(o.foreign_keys){exec_pragma(native_connection, "PRAGMA foreign_keys = ON");}
+}
+
+
+void tdb::Connection_t<tdb::Tag_sqlite>::connect(const std::string &db_name, const sqlite::Options &o){
 	std::lock_guard<std::mutex> lk(native_mutex);
 
-	int rc = sqlite3_open(db_name.c_str() , &native_connection);
+	native_options = o;
+
+	//doc : https://www.sqlite.org/c3ref/open.html
+	int flags = 0;
+	if(o.read_only || o.immutable){flags |= SQLITE_OPEN_READONLY;}
+	else{
+		flags |= SQLITE_OPEN_READWRITE;
+		if(o.create){flags |= SQLITE_OPEN_CREATE;}
+	}
+	if(o.no_mutex ){flags |= SQLITE_OPEN_NOMUTEX;}
+	if(o.immutable){flags |= SQLITE_OPEN_URI;}
+
+	const std::string filename = o.immutable ? sqlite_immutable_uri(db_name) : db_name;
+	int rc = sqlite3_open_v2(filename.c_str() , &native_connection, flags, nullptr);
 
 	if(rc!= SQLITE_OK){
 		//doc says : Whether or not an error occurs when it is opened, resources associated with the database connection handle should be released by passing it to sqlite3_close() when it is no longer required.
@@ -78,8 +178,9 @@ void tdb::Connection_t<tdb::Tag_sqlite>::connect(const std::string &db_name){
 	}
 
 	try{
-		tdb::execute(*this,"PRAGMA foreign_keys = ON");
+		apply_options();
 		cstr_limits();
+		sqlite::register_array_module(native_connection);
 	}catch(...){
 		sqlite3_close(native_connection);
 		native_connection=nullptr;
@@ -90,6 +191,131 @@ void tdb::Connection_t<tdb::Tag_sqlite>::connect(const std::string &db_name){
 
 
 
+//=== options presets ===
+tdb::sqlite::Options tdb::sqlite::Options::bulk_load(){
+	Options o;
+	o.no_mutex     = true;
+	o.journal_mode = Journal_mode::Wal;
+	o.synchronous  = Synchronous::Off;
+	o.cache_size   = -262144;    //256 MiB
+	o.mmap_size    = 268435456;  //256 MiB
+	o.temp_store   = Temp_store::Memory;
+	o.busy_timeout = 5000;
+	return o;
+}
+
+tdb::sqlite::Options tdb::sqlite::Options::oltp(){
+	Options o;
+	o.journal_mode = Journal_mode::Wal;
+	o.synchronous  = Synchronous::Normal;
+	o.cache_size   = -65536;     //64 MiB
+	o.mmap_size    = 268435456;  //256 MiB
+	o.temp_store   = Temp_store::Memory;
+	o.busy_timeout = 5000;
+	return o;
+}
+
+tdb::sqlite::Options tdb::sqlite::Options::read_only_analytics(){
+	Options o;
+	o.read_only    = true;
+	o.foreign_keys = false;      //nothing is written
+	o.cache_size   = -262144;    //256 MiB
+	o.mmap_size    = 1073741824; //1 GiB
+	o.temp_store   = Temp_store::Memory;
+	o.busy_timeout = 5000;
+	return o;
+}
+
+
+
+
+
+//=== scripts ===
+namespace{
+	//length of the longest prefix of data made of complete statements, 0 if none.
+	//b.data is NUL terminated in place for sqlite3_complete, then restored.
+	size_t sqlite_complete_prefix(std::string &data){
+		static constexpr size_t max_tries = 8; //';' inside strings or triggers : read more instead
+		size_t end = data.size();
+		for(size_t i = 0; i < max_tries and end!=0; ++i){
+			const size_t semicolon = data.rfind(';',end-1);
+			if(semicolon==std::string::npos){return 0;}
+
+			const size_t n = semicolon+1;
+			if(n==data.size()){
+				if(sqlite3_complete(data.c_str())){return n;}
+			}else{
+				const char saved = data[n];
+				data[n] = '\0';
+				const bool complete = sqlite3_complete(data.c_str());
+				data[n] = saved;
+				if(complete){return n;}
+			}
+			end = semicolon;
+		}
+		return 0;
+	}
+
+	//run the statements in [begin, end) (sqlite3_prepare_v2 over the tail)
+	void sqlite_run_statements(sqlite3 *c, const char *begin, const char *end, tdb::Script_progress &progress){
+		const char *p = begin;
+		while(p<end){
+			sqlite3_stmt *stmt = nullptr;
+			const char   *tail = nullptr;
+			const size_t  size = static_cast<size_t>(end-p);
+			if(size > static_cast<size_t>(std::numeric_limits<int>::max())){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite script : statement too large");}
+
+			int rc = sqlite3_prepare_v2(c, p, static_cast<int>(size), &stmt, &tail);
+			if(rc!=SQLITE_OK){
+				throw tdb::Exception_t<tdb::Tag_sqlite>("Wrong sqlite query in script, statement="+std::to_string(progress.nb_statements+1)+", error_code=" + std::to_string(rc)+", sqlite3_msg="+sqlite3_errmsg(c)+", sql="+std::string(p,std::min<size_t>(size,200)));
+			}
+			if(stmt==nullptr){p=tail; continue;} //only spaces or comments
+
+			do{rc = sqlite3_step(stmt);}while(rc==SQLITE_ROW);
+			if(rc!=SQLITE_DONE){
+				std::string msg = "Error in sqlite script, statement="+std::to_string(progress.nb_statements+1)+", error_code="+tdb::sqlite::error_to_string(rc)+", sqlite3_msg="+sqlite3_errmsg(c)+", sql="+std::string(p,tail);
+				sqlite3_finalize(stmt);
+				throw tdb::Exception_t<tdb::Tag_sqlite>(msg);
+			}
+			sqlite3_finalize(stmt);
+			++progress.nb_statements;
+			p = tail;
+		}
+	}
+
+	void sqlite_script_exec(sqlite3 *c, const char *sql){
+		char *err = nullptr;
+		if(sqlite3_exec(c, sql, nullptr, nullptr, &err)!=SQLITE_OK){
+			std::string msg = err ? err : sqlite3_errmsg(c);
+			sqlite3_free(err);
+			throw tdb::Exception_t<tdb::Tag_sqlite>("Error in sqlite script, error="+msg+", sql="+sql);
+		}
+	}
+}
+
+
+void tdb::Read_Istream_t<tdb::Tag_sqlite>::run(Connection_t<Tag_sqlite> &c, std::istream &in, const Script_options &o){
+	impl::Script_buffer b(in,o);
+
+	if(o.single_transaction){sqlite_script_exec(c.native_connection, "BEGIN transaction");}
+	try{
+		while(b.read() or !b.data.empty()){
+			const size_t n = b.eof ? b.data.size() : sqlite_complete_prefix(b.data);
+			if(n!=0){
+				sqlite_run_statements(c.native_connection, b.data.data(), b.data.data()+n, b.progress);
+				b.consume(n);
+			}
+			if(o.progress){o.progress(b.progress);}
+			if(b.eof){break;}
+		}
+		if(o.single_transaction){sqlite_script_exec(c.native_connection, "COMMIT");}
+	}catch(...){
+		if(o.single_transaction){sqlite3_exec(c.native_connection, "ROLLBACK", nullptr, nullptr, nullptr);}
+		throw;
+	}
+}
+
+
 
 
 //=== native stuff ===
@@ -177,5 +403,295 @@ void  tdb::sqlite::reset_binding(sqlite3_stmt* &native_query, int *native_nb_bin
 
 
 
+//=======================
+//=== validate_schema ===
+//=======================
+tdb::sqlite::Affinity tdb::sqlite::affinity(const char *declared_type){
+	if(declared_type==nullptr){return Affinity::Blob;}
+
+	std::string t(declared_type);
+	std::transform(t.begin(), t.end(), t.begin(), [](unsigned char c){return static_cast<char>(std::toupper(c));});
+	auto has = [&](const char *s){return t.find(s)!=std::string::npos;};
+
+	//the order of the rules matters
+	if(has("INT"))                                 {return Affinity::Integer;}
+	if(has("CHAR") or has("CLOB") or has("TEXT"))  {return Affinity::Text;}
+	if(has("BLOB") or t.empty())                   {return Affinity::Blob;}
+	if(has("REAL") or has("FLOA") or has("DOUB"))  {return Affinity::Real;}
+	return Affinity::Numeric;
+}
+
+tdb::sqlite::Column_schema tdb::sqlite::column_schema(sqlite3_stmt *native_query, int i){
+	Column_schema r;
+#ifndef TDB_SQLITE_NO_COLUMN_METADATA
+	//doc : https://www.sqlite.org/c3ref/column_database_name.html
+	const char *db     = sqlite3_column_database_name(native_query,i);
+	const char *table  = sqlite3_column_table_name   (native_query,i);
+	const char *column = sqlite3_column_origin_name  (native_query,i);
+	if(db==nullptr or table==nullptr or column==nullptr){return r;} //expression
+
+	//doc : https://www.sqlite.org/c3ref/table_column_metadata.html
+	const char *declared_type = nullptr;
+	int not_null = 0;
+	const int status = sqlite3_table_column_metadata(sqlite3_db_handle(native_query), db, table, column, &declared_type, nullptr, &not_null, nullptr, nullptr);
+	if(status!=SQLITE_OK){return r;}
+
+	r.affinity = affinity(declared_type);
+	r.not_null = not_null!=0;
+#else
+	(void)native_query; (void)i;
+#endif
+	return r;
+}
+
+
+
+//=================
+//=== tdb_array ===
+//=================
+//eponymous only virtual table, tdb_array(pointer) returns one row per element (column value)
+//doc : https://www.sqlite.org/vtab.html  https://www.sqlite.org/carray.html  https://www.sqlite.org/bindptr.html
+namespace{
+	using tdb::sqlite::Array_type;
+	using tdb::sqlite::Array_view;
+
+	struct Array_cursor{
+		sqlite3_vtab_cursor base; //first : sqlite casts Array_cursor* to sqlite3_vtab_cursor*
+		const Array_view *array = nullptr;
+		size_t            i     = 0;
+	};
+
+	constexpr int array_column_value   = 0;
+	constexpr int array_column_pointer = 1; //hidden, the argument of tdb_array(...)
+
+	int array_connect(sqlite3 *db, void*, int, const char *const*, sqlite3_vtab **pp_vtab, char**){
+		const int rc = sqlite3_declare_vtab(db, "CREATE TABLE x(value, pointer hidden)");
+		if(rc!=SQLITE_OK){return rc;}
+		*pp_vtab = static_cast<sqlite3_vtab*>(sqlite3_malloc(sizeof(sqlite3_vtab)));
+		if(*pp_vtab==nullptr){return SQLITE_NOMEM;}
+		std::memset(*pp_vtab, 0, sizeof(sqlite3_vtab));
+		sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+		return SQLITE_OK;
+	}
+
+	int array_disconnect(sqlite3_vtab *vtab){
+		sqlite3_free(vtab);
+		return SQLITE_OK;
+	}
+
+	//the pointer must be given : tdb_array(?)
+	int array_best_index(sqlite3_vtab*, sqlite3_index_info *info){
+		for(int i = 0; i < info->nConstraint; ++i){
+			const auto &c = info->aConstraint[i];
+			if(c.iColumn==array_column_pointer and c.op==SQLITE_INDEX_CONSTRAINT_EQ and c.usable){
+				info->aConstraintUsage[i].argvIndex = 1;
+				info->aConstraintUsage[i].omit      = 1;
+				info->idxNum        = 1;
+				info->estimatedCost = 1;
+				info->estimatedRows = 100;
+				return SQLITE_OK;
+			}
+		}
+		info->idxNum        = 0;
+		info->estimatedCost = 2147483647;
+		info->estimatedRows = 2147483647;
+		return SQLITE_OK;
+	}
+
+	int array_open(sqlite3_vtab*, sqlite3_vtab_cursor **pp_cursor){
+		Array_cursor *c = new(std::nothrow) Array_cursor();
+		if(c==nullptr){return SQLITE_NOMEM;}
+		*pp_cursor = &c->base;
+		return SQLITE_OK;
+	}
+
+	int array_close(sqlite3_vtab_cursor *cursor){
+		delete reinterpret_cast<Array_cursor*>(cursor);
+		return SQLITE_OK;
+	}
+
+	int array_filter(sqlite3_vtab_cursor *cursor, int idx_num, const char*, int argc, sqlite3_value **argv){
+		Array_cursor *c = reinterpret_cast<Array_cursor*>(cursor);
+		c->array = (idx_num==1 and argc==1) ? static_cast<const Array_view*>(sqlite3_value_pointer(argv[0], tdb::sqlite::array_pointer_type)) : nullptr;
+		c->i     = 0;
+		return SQLITE_OK;
+	}
+
+	int array_next(sqlite3_vtab_cursor *cursor){
+		++reinterpret_cast<Array_cursor*>(cursor)->i;
+		return SQLITE_OK;
+	}
+
+	int array_eof(sqlite3_vtab_cursor *cursor){
+		const Array_cursor *c = reinterpret_cast<Array_cursor*>(cursor);
+		return c->array==nullptr or c->i >= c->array->size;
+	}
+
+	int array_column(sqlite3_vtab_cursor *cursor, sqlite3_context *ctx, int column){
+		const Array_cursor *c = reinterpret_cast<Array_cursor*>(cursor);
+		if(column!=array_column_value){sqlite3_result_null(ctx); return SQLITE_OK;}
+
+		const Array_view &a = *c->array;
+		switch(a.type){
+		case Array_type::Int    : sqlite3_result_int   (ctx, static_cast<const int*          >(a.data)[c->i]); break;
+		case Array_type::Int64  : sqlite3_result_int64 (ctx, static_cast<const sqlite3_int64*>(a.data)[c->i]); break;
+		case Array_type::Double : sqlite3_result_double(ctx, static_cast<const double*       >(a.data)[c->i]); break;
+		case Array_type::String :{
+			const std::string &s = static_cast<const std::string*>(a.data)[c->i];
+			sqlite3_result_text64(ctx, s.data(), s.size(), SQLITE_STATIC, SQLITE_UTF8); //the array outlives the query
+			break;
+		}
+		case Array_type::String_view :{
+			const std::string_view &s = static_cast<const std::string_view*>(a.data)[c->i];
+			sqlite3_result_text64(ctx, s.data(), s.size(), SQLITE_STATIC, SQLITE_UTF8);
+			break;
+		}
+		}
+		return SQLITE_OK;
+	}
+
+	int array_rowid(sqlite3_vtab_cursor *cursor, sqlite3_int64 *rowid){
+		*rowid = static_cast<sqlite3_int64>(reinterpret_cast<Array_cursor*>(cursor)->i) + 1;
+		return SQLITE_OK;
+	}
+
+	sqlite3_module make_array_module(){
+		sqlite3_module m;
+		std::memset(&m, 0, sizeof(m));
+		m.iVersion    = 0;
+		m.xCreate     = nullptr; //eponymous only : no CREATE VIRTUAL TABLE
+		m.xConnect    = array_connect;
+		m.xBestIndex  = array_best_index;
+		m.xDisconnect = array_disconnect;
+		m.xOpen       = array_open;
+		m.xClose      = array_close;
+		m.xFilter     = array_filter;
+		m.xNext       = array_next;
+		m.xEof        = array_eof;
+		m.xColumn     = array_column;
+		m.xRowid      = array_rowid;
+		return m;
+	}
+
+	const sqlite3_module array_module = make_array_module();
+}
+
+int tdb::sqlite::bind_array(sqlite3_stmt *native_query, int index, const Array_view &a){
+	Array_view *copy = new Array_view(a);
+	//sqlite calls the destructor when the parameter is rebound or cleared, and on error
+	return sqlite3_bind_pointer(native_query, index, copy, array_pointer_type, [](void *p){delete static_cast<Array_view*>(p);});
+}
+
+void tdb::sqlite::register_array_module(sqlite3 *native_connection){
+	const int rc = sqlite3_create_module_v2(native_connection, array_pointer_type, &array_module, nullptr, nullptr);
+	if(rc!=SQLITE_OK){throw Exception_t<tdb::Tag_sqlite>("Cannot register the sqlite module tdb_array, error_code=" + sqlite::error_to_string(rc) + ", msg=" + sqlite3_errmsg(native_connection));}
+}
+
+
+
+//=== read snapshots ===
+namespace{
+	void snapshot_exec(sqlite3 *c, const char *sql){
+		char *err = nullptr;
+		if(sqlite3_exec(c, sql, nullptr, nullptr, &err)!=SQLITE_OK){
+			std::string msg = err ? err : sqlite3_errmsg(c);
+			sqlite3_free(err);
+			throw tdb::Exception_t<tdb::Tag_sqlite>("Cannot start a sqlite read transaction, error="+msg+", sql="+sql);
+		}
+	}
+
+	//BEGIN is deferred : the read transaction (and its view of the database) starts with the first read
+	void begin_read(sqlite3 *c){
+		snapshot_exec(c, "BEGIN");
+		try{
+			snapshot_exec(c, "select count(*) from sqlite_master");
+		}catch(...){
+			sqlite3_exec(c, "ROLLBACK", nullptr, nullptr, nullptr);
+			throw;
+		}
+	}
+
+	//end the read transactions of readers[0..n)
+	void end_reads(const std::vector<tdb::Connection_t<tdb::Tag_sqlite>*> &readers, size_t n){
+		for(size_t i = 0; i < n; ++i){sqlite3_exec(readers[i]->native_connection, "ROLLBACK", nullptr, nullptr, nullptr);}
+	}
+
+#ifdef SQLITE_ENABLE_SNAPSHOT
+	//false : no snapshot support for this database (ex : not WAL), nothing is started
+	bool begin_read_snapshot(const std::vector<tdb::Connection_t<tdb::Tag_sqlite>*> &readers){
+		sqlite3 *c0 = readers[0]->native_connection;
+		begin_read(c0);
+		sqlite3_snapshot *snapshot = nullptr;
+		if(sqlite3_snapshot_get(c0, "main", &snapshot)!=SQLITE_OK){
+			end_reads(readers,1);
+			return false;
+		}
+
+		size_t started = 1;
+		try{
+			for(; started < readers.size(); ++started){
+				sqlite3 *c = readers[started]->native_connection;
+				snapshot_exec(c, "BEGIN");
+				const int rc = sqlite3_snapshot_open(c, "main", snapshot);
+				if(rc!=SQLITE_OK){
+					sqlite3_exec(c, "ROLLBACK", nullptr, nullptr, nullptr);
+					throw tdb::Exception_t<tdb::Tag_sqlite>("Cannot open the sqlite snapshot, error_code=" + tdb::sqlite::error_to_string(rc) + ", msg=" + sqlite3_errmsg(c));
+				}
+			}
+		}catch(...){
+			sqlite3_snapshot_free(snapshot);
+			end_reads(readers,started);
+			throw;
+		}
+		sqlite3_snapshot_free(snapshot);
+		return true;
+	}
+#endif
+}
+
+bool tdb::sqlite::begin_read_same_snapshot(const std::vector<Connection_t<Tag_sqlite>*> &readers, Connection_t<Tag_sqlite> *writer){
+	if(readers.empty()){return false;}
+
+#ifdef SQLITE_ENABLE_SNAPSHOT
+	if(begin_read_snapshot(readers)){return true;}
+#endif
+
+	//nothing can be commited between the read transactions when :
+	// - there is a single reader
+	// - the file is immutable (it MUST NOT change)
+	// - writer already holds a write transaction
+	// - writer takes the RESERVED lock (BEGIN IMMEDIATE) while they start
+	const bool single    = readers.size()==1;
+	const bool immutable = std::all_of(readers.begin(), readers.end(), [](const Connection_t<Tag_sqlite> *r){return r->options().immutable;});
+	const bool writing   = writer!=nullptr and sqlite3_txn_state(writer->native_connection, "main")==SQLITE_TXN_WRITE;
+	const bool pin       = !single and !immutable and !writing
+	                   and writer!=nullptr
+	                   and !writer->options().read_only
+	                   and !writer->options().immutable
+	                   and sqlite3_get_autocommit(writer->native_connection)!=0;
+	if(!single and !immutable and !writing and !pin){
+		throw Exception_t<tdb::Tag_sqlite>("Cannot start the read transactions on the same snapshot : no sqlite snapshot (SQLITE_ENABLE_SNAPSHOT and WAL), and no writable connection outside of a transaction to hold the commits meanwhile");
+	}
+	if(pin){snapshot_exec(writer->native_connection, "BEGIN IMMEDIATE");}
+
+	size_t started = 0;
+	try{
+		for(; started < readers.size(); ++started){begin_read(readers[started]->native_connection);}
+	}catch(...){
+		end_reads(readers,started);
+		if(pin){sqlite3_exec(writer->native_connection, "ROLLBACK", nullptr, nullptr, nullptr);}
+		throw;
+	}
+	if(pin){sqlite3_exec(writer->native_connection, "ROLLBACK", nullptr, nullptr, nullptr);}
+	return false;
+}
+
+void tdb::sqlite::end_read(Connection_t<Tag_sqlite> &reader){
+	if(sqlite3_get_autocommit(reader.native_connection)!=0){return;} //no transaction
+	if(sqlite3_exec(reader.native_connection, "COMMIT", nullptr, nullptr, nullptr)!=SQLITE_OK){
+		throw Exception_t<tdb::Tag_sqlite>(std::string("Cannot end the sqlite read transaction, msg=") + sqlite3_errmsg(reader.native_connection));
+	}
+}
+
 
 
@@ -7,6 +7,8 @@
 
 #include <tdb/tdb.hpp>
 #include <sqlite3.h>
+#include <cstdint>
+#include <vector>
 
 
 namespace tdb{
@@ -24,12 +26,56 @@ template<> struct tdb::Rowid_t<tdb::Tag_sqlite>{
 };
 
 
+//--- connection options (optional) ---
+//applied by connect, empty std::optional : keep the sqlite default
+//doc : https://www.sqlite.org/pragma.html  https://www.sqlite.org/c3ref/open.html
+namespace tdb::sqlite{
+
+	enum class Journal_mode{Delete, Truncate, Persist, Memory, Wal, Off};
+	enum class Synchronous {Off, Normal, Full, Extra};
+	enum class Temp_store  {Default, File, Memory};
+
+	struct Options{
+		//--- sqlite3_open_v2 flags ---
+		bool read_only = false; //SQLITE_OPEN_READONLY, otherwise SQLITE_OPEN_READWRITE
+		bool create    = true;  //SQLITE_OPEN_CREATE (ignored when read_only)
+		bool no_mutex  = false; //SQLITE_OPEN_NOMUTEX : tdb locks the connection mutex, but queries
+		                        //are destroyed without it. Use only if all the queries are
+		                        //created, used and destroyed by one thread at a time.
+		bool immutable = false; //URI immutable=1 : no locking at all, the file MUST NOT change (implies read_only)
+
+		//--- pragmas ---
+		bool foreign_keys = true;
+		std::optional<Journal_mode> journal_mode;
+		std::optional<Synchronous>  synchronous;
+		std::optional<long long>    cache_size;   //pages if >0, KiB if <0
+		std::optional<long long>    mmap_size;    //bytes
+		std::optional<Temp_store>   temp_store;
+		std::optional<int>          page_size;    //bytes, only for new databases (or after VACUUM), not in WAL mode
+		std::optional<int>          busy_timeout; //milliseconds to wait on a locked database
+
+		//--- queries ---
+		bool validate_schema = false; //sqlite::validate_schema on each prepared query that returns rows
+
+		//--- presets ---
+		//bulk load           : WAL, synchronous=OFF (a crash may lose the last transactions, not corrupt the db),
+		//                      big cache, temp in memory, NOMUTEX
+		//oltp                : WAL, synchronous=NORMAL, busy_timeout, mmap
+		//read only analytics : read only, big cache and mmap, temp in memory
+		static Options bulk_load();
+		static Options oltp();
+		static Options read_only_analytics();
+	};
+}
+
+
 template<>
 struct tdb::Connection_t<tdb::Tag_sqlite>{
 	static constexpr bool is_implemented = true;
 
 	~Connection_t() noexcept(false) {disconnect(); }            //disconnect
-	void connect(const std::string &s);
+	void connect(const std::string &s){connect(s,sqlite::Options());}
+	void connect(const std::string &s, const sqlite::Options &o);
 	void disconnect();
 
 	//Connection_t(Connection_t&&);
@@ -46,6 +92,7 @@ struct tdb::Connection_t<tdb::Tag_sqlite>{
 	Connection_t(){}
 	explicit Connection_t(const char* db_name_)       {connect(db_name_);}
 	explicit Connection_t(const std::string& db_name_){connect(db_name_);}
+	Connection_t(const std::string& db_name_, const sqlite::Options &o){connect(db_name_,o);}
 
 	//if possible construct from : db_name, db_host="", db_user="", db_pass="",port=0,extra="");
 	explicit Connection_t(
@@ -66,6 +113,15 @@ struct tdb::Connection_t<tdb::Tag_sqlite>{
 	mutable std::mutex native_mutex;
 	sqlite3   *native_connection=nullptr; //OWNED
 
+	//--- prepared queries reused by execute, insert, transaction ... ---
+	Query_cache query_cache;
+
+	//--- see set_observer (empty without TDB_OBSERVER) ---
+	[[no_unique_address]] impl::Observer_slot<Tag_sqlite> observer;
+
+	//--- options used by the last connect ---
+	const sqlite::Options& options()const{return native_options;}
+
 	//TODO
 	//Generate_unique_id<size_t> savepoint_ids;
 
@@ -82,12 +138,12 @@ struct tdb::Connection_t<tdb::Tag_sqlite>{
 	};
 	static constexpr Sqlite_limit_range sqlite_max_length_range             ={SQLITE_LIMIT_LENGTH     ,1000000000,1,2147483647};//Maximum length of a string or BLOB
 	static constexpr Sqlite_limit_range sqlite_max_column_range             ={SQLITE_LIMIT_COLUMN     ,2000      ,1,32767}; //Maximum Number Of Columns
-	static constexpr Sqlite_limit_range sqlite_max_sql_length_range         ={SQLITE_LIMIT_LENGTH     ,1000000   ,1,1073741824};  //Maximum Length Of An SQL Statement
+	static constexpr Sqlite_limit_range sqlite_max_sql_length_range         ={SQLITE_LIMIT_SQL_LENGTH ,1000000000,1,1073741824};  //Maximum Length Of An SQL Statement
 	static constexpr Sqlite_limit_range sqlite_max_expr_depth_range         ={SQLITE_LIMIT_EXPR_DEPTH  ,1000,0,std::numeric_limits<int>::max()-1};   //Maximum Depth Of An Expression Tree
 	static constexpr Sqlite_limit_range sqlite_max_function_arg_range       ={SQLITE_LIMIT_FUNCTION_ARG,100,1,127}; //Maximum Number Of Arguments On A Function
 	static constexpr Sqlite_limit_range sqlite_max_compound_select_range    ={SQLITE_LIMIT_COMPOUND_SELECT,500,1,500}; //Maximum Number Of Terms In A Compound SELECT Statement
 	static constexpr Sqlite_limit_range sqlite_max_like_pattern_length_range={SQLITE_LIMIT_LIKE_PATTERN_LENGTH,50000,1,50000};//Maximum Length Of A LIKE Or GLOB Pattern
-	static constexpr Sqlite_limit_range sqlite_max_variable_number_range    ={SQLITE_LIMIT_VARIABLE_NUMBER,999,0,999};//Maximum Number Of Host Parameters In A Single SQL Statement
+	static constexpr Sqlite_limit_range sqlite_max_variable_number_range    ={SQLITE_LIMIT_VARIABLE_NUMBER,32766,0,std::numeric_limits<int>::max()-1};//Maximum Number Of Host Parameters In A Single SQL Statement (999 before sqlite 3.32.0)
 	static constexpr Sqlite_limit_range sqlite_max_trigger_depth_range      ={SQLITE_LIMIT_TRIGGER_DEPTH,1000,1,std::numeric_limits<int>::max()-1};//Maximum Depth Of Trigger Recursion
 	static constexpr Sqlite_limit_range sqlite_max_attached_range           ={SQLITE_LIMIT_ATTACHED,10,1,25};//Maximum Number Of Attached Databases
 
@@ -104,11 +160,15 @@ struct tdb::Connection_t<tdb::Tag_sqlite>{
 
 	private:
 	void cstr_limits();
+	void apply_options();
+	sqlite::Options native_options;
 
 };
 
 
 template<> struct tdb::Get_mutex_t<tdb::Tag_sqlite>;
+template<> struct tdb::Get_query_cache_t<tdb::Tag_sqlite>;
+template<> struct tdb::Get_observer_t<tdb::Tag_sqlite>;
 
 
 
@@ -159,7 +219,9 @@ struct tdb::Query_t<tdb::Tag_sqlite,Return_tt,Bind_tt>{
 	sqlite3_stmt             *native_query     =nullptr; //OWNED
 	sqlite3                  *native_connection=nullptr; //NOT owned
 	int                       native_nb_bind   =0;//number of bound parameters
+	std::uint64_t             native_unchecked =0;//bit I : column I is fetched without type check, see sqlite::validate_schema
 
+	[[no_unique_address]] impl::Query_probe<Tag_sqlite> probe; //see set_observer
 };
 
 
@@ -190,7 +252,7 @@ struct tdb::Result_t<tdb::Tag_sqlite,Return_tt>{
 
 	//construct from query (required for default implementation of Get_result_t)
 	template<typename Bind_tt>
-	explicit Result_t(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q):native_query(q.native_query),native_nb_bind(&q.native_nb_bind){}
+	explicit Result_t(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q):native_query(q.native_query),native_nb_bind(&q.native_nb_bind),native_unchecked(q.native_unchecked){}
 
 	//--- extra ---
 	std::string sql_string()   const {return ::sqlite3_sql(native_query);}
@@ -199,6 +261,9 @@ struct tdb::Result_t<tdb::Tag_sqlite,Return_tt>{
 	sqlite3_stmt *native_query  =nullptr; //NOT owned
 	int          *native_nb_bind=nullptr; //NOT owned
 	int           native_result=4; //what sqlite3_step returns. TODO
+	std::uint64_t native_unchecked=0; //copy of Query_t::native_unchecked
+
+	[[no_unique_address]] impl::Result_probe<Tag_sqlite> probe; //see set_observer
 };
 
 
@@ -222,6 +287,13 @@ template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,bool         ,I>; //bo
 template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,char         ,I>; //char          -> sqlite3_bind_text
 template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,const char*  ,I>; //const char*   -> sqlite3_bind_text
 template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,tdb::Null    ,I>; //tdb::Null     -> sqlite3_bind_null
+template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::string_view          ,I>; //std::string_view           -> sqlite3_bind_text
+template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::span<const std::byte>,I>; //std::span<const std::byte> -> sqlite3_bind_blob
+
+//arrays -> sqlite3_bind_pointer, read with the tdb_array table valued function (see sqlite::Array_view)
+//T : int, sqlite3_int64, double, std::string, std::string_view
+template<typename T, size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::vector<T>,I>;        //std::vector<T>        -> tdb_array(?)
+template<typename T, size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::span<const T>,I>;    //std::span<const T>    -> tdb_array(?)
 
 
 //=================
@@ -238,6 +310,10 @@ template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,char,          I>; //ch
 
 template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,tdb::Null,     I>; //Null          <- do nothing
 
+//borrowed (see tdb::Is_borrowed_t) : no copy, valid until the next fetch
+template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,std::string_view,          I>; //std::string_view           <- sqlite3_column_text
+template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,std::span<const std::byte>,I>; //std::span<const std::byte> <- sqlite3_column_blob
+
 //std::optional
 template<size_t I, typename T > struct tdb::Get_one_t<tdb::Tag_sqlite,std::optional<T>, I>; //std::optional<T> <- dispatch, treat Null as empty optional
 
@@ -259,6 +335,50 @@ template<typename Return_tt, typename Bind_tt> struct tdb::Insert_t    <tdb::Tag
 //  template<typename Return_tt, typename Bind_tt> struct tdb::Get_result_t<tdb::Tag_sqlite,Return_tt,Bind_tt>; //default use Result_t::Result_t(Query_t&)
 
 
+//--- multi rows insert (optional) ---
+//bind limit : sqlite_max_variable_number_value
+template<> struct tdb::Get_bind_limit_t<tdb::Tag_sqlite>;
+
+//Bind_one_t binds sequentially, so a Query_t<Tag_sqlite,std::tuple<>,Bind_tt> can bind nb_rows rows one after one
+template<typename Bind_tt>
+struct tdb::Multi_insert_t<tdb::Tag_sqlite,Bind_tt>{
+	static constexpr bool is_implemented = true;
+
+	Multi_insert_t(){}
+	Multi_insert_t(Connection_t<Tag_sqlite> &c, const std::string &head, const std::string &tail, size_t nb_rows_);
+
+	//movable, NOT copiable
+	Multi_insert_t(Multi_insert_t&&)=default;
+	Multi_insert_t& operator=(Multi_insert_t&&)=default;
+	Multi_insert_t(const Multi_insert_t&)=delete;
+	Multi_insert_t& operator=(const Multi_insert_t&)=delete;
+
+	size_t nb_rows()const{return native_nb_rows;}
+
+	template<typename It>
+	void run(It &first);
+
+	Query_t<Tag_sqlite,std::tuple<>,Bind_tt> q;
+	size_t native_nb_rows = 0;
+};
+
+
+
+//--- scripts (read_istream, read_string, read_file) ---
+//streamed through a Script_options::buffer_size buffer : each complete statement
+//(sqlite3_complete) is prepared with sqlite3_prepare_v2, run, and finalized.
+//Rows returned by the statements are ignored.
+template<> struct tdb::Read_Istream_t<tdb::Tag_sqlite>{
+	static constexpr bool is_implemented = true;
+	static void run(Connection_t<Tag_sqlite> &c, std::istream &in, const Script_options &o);
+};
+
+template<> struct tdb::Read_String_t<tdb::Tag_sqlite>{
+	static constexpr bool is_implemented = true;
+	static void run(Connection_t<Tag_sqlite> &c, const std::string &s, const Script_options &o){impl::read_string_as_istream(c,s,o);}
+};
+
+
 
 
 
@@ -274,6 +394,79 @@ namespace tdb::sqlite{
 	void reset_binding(sqlite3_stmt* &native_query, int* native_nb_bind  );
 
 
+	//--- schema validation (optional) ---
+	//Get_one_t checks the type of each value (sqlite3_column_type) on each row.
+	//validate_schema checks the query once : the number of columns must match Return_tt (or it throws),
+	//and the columns that come from a table column with the affinity of their C++ type skip the check :
+	//  int, sqlite3_int64, size_t, bool : INTEGER  | double : REAL  | std::string, std::string_view, char : TEXT
+	//  std::span<const std::byte> : BLOB
+	//  the table column must be NOT NULL, except for std::optional<T> (NULL is still checked).
+	//Other columns (expressions, other affinities, other types) keep the check.
+	//Returns the number of unchecked columns.
+	//
+	//WARNING : sqlite only enforces types in STRICT tables. Elsewhere a value that cannot be converted
+	//is stored as is (ex : 'abc' in an INTEGER column), and an unchecked column reads it with the sqlite
+	//conversion instead of throwing. The right side of a LEFT JOIN can be NULL even for a NOT NULL column :
+	//use std::optional there. Validate again after a schema change.
+	//Needs the column metadata (sqlite compiled with SQLITE_ENABLE_COLUMN_METADATA, as most distributions do);
+	//with -DTDB_SQLITE_NO_COLUMN_METADATA, only the number of columns is checked.
+	template<typename Return_tt, typename Bind_tt>
+	size_t validate_schema(Query_t<Tag_sqlite,Return_tt,Bind_tt> &q);
+
+	enum class Affinity{None, Integer, Real, Text, Blob, Numeric}; //None : not a table column
+
+	//doc : https://www.sqlite.org/datatype3.html#determination_of_column_affinity
+	Affinity affinity(const char *declared_type);
+
+	struct Column_schema{
+		Affinity affinity = Affinity::None;
+		bool     not_null = false;
+	};
+	Column_schema column_schema(sqlite3_stmt *native_query, int i); //None if column i is not a table column
+
+
+	//--- arrays (optional) ---
+	//std::vector<T> and std::span<const T> are bound as a pointer (sqlite3_bind_pointer), and read
+	//in sql with the tdb_array table valued function (like the carray extension, registered by connect) :
+	//  select * from t where id in tdb_array(?)
+	//  select t.* from tdb_array(?) a join t on t.id=a.value
+	//The array is NOT copied : it must outlive the execution (and the results) of the query.
+	enum class Array_type{Int, Int64, Double, String, String_view};
+
+	template<typename T> struct Array_type_t{static constexpr bool is_implemented = false;};
+	template<> struct Array_type_t<int>             {static constexpr bool is_implemented = true; static constexpr Array_type value = Array_type::Int;};
+	template<> struct Array_type_t<sqlite3_int64>   {static constexpr bool is_implemented = true; static constexpr Array_type value = Array_type::Int64;};
+	template<> struct Array_type_t<double>          {static constexpr bool is_implemented = true; static constexpr Array_type value = Array_type::Double;};
+	template<> struct Array_type_t<std::string>     {static constexpr bool is_implemented = true; static constexpr Array_type value = Array_type::String;};
+	template<> struct Array_type_t<std::string_view>{static constexpr bool is_implemented = true; static constexpr Array_type value = Array_type::String_view;};
+
+	struct Array_view{
+		const void *data = nullptr; //NOT owned
+		size_t      size = 0;
+		Array_type  type = Array_type::Int;
+	};
+
+	static constexpr const char *array_pointer_type = "tdb_array";
+
+	//bind a copy of a (not of the data) to the parameter index (1 based)
+	int  bind_array(sqlite3_stmt *native_query, int index, const Array_view &a); //returns the sqlite3_bind_pointer status
+	void register_array_module(sqlite3 *native_connection);                        //tdb_array, throws on error
+
+
+	//--- read snapshots (optional) ---
+	//Start a read transaction on each reader, all reading the same state of the database (see Fn_parallel_scan).
+	//With -DSQLITE_ENABLE_SNAPSHOT (sqlite built with it) and a WAL database : sqlite3_snapshot_get on
+	//readers[0], then sqlite3_snapshot_open on the others. Otherwise writer (writable, and outside of a
+	//transaction) holds BEGIN IMMEDIATE while the read transactions start, so nothing can be commited in
+	//between. No lock is needed with a single reader, immutable readers, or a writer that already holds
+	//a write transaction. Else it throws : the readers could see different states.
+	//Returns true if sqlite snapshots were used.
+	//The readers must not be in a transaction. end_read ends the read transaction (COMMIT).
+	//WARNING : without WAL, the open read transactions block the writers until end_read.
+	bool begin_read_same_snapshot(const std::vector<Connection_t<Tag_sqlite>*> &readers, Connection_t<Tag_sqlite> *writer);
+	void end_read(Connection_t<Tag_sqlite> &reader);
+
+
 	struct Query_guard{
 
 		explicit Query_guard(sqlite3_stmt* &native_query_,int* native_nb_bind_ ):
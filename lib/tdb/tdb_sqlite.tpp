@@ -1,4 +1,4 @@
-#include "helpers/select_type.hpp"
+#include <utility> //std::in_range
 #include <cstring> //strlen
 #include <cassert>
 
@@ -20,6 +20,30 @@ struct tdb::Get_mutex_t<tdb::Tag_sqlite>{
 	}
 };
 
+template<>
+struct tdb::Get_query_cache_t<tdb::Tag_sqlite>{
+	static constexpr bool is_implemented = true;
+	static auto & run(tdb::Connection_t<tdb::Tag_sqlite> &c){
+		return c.query_cache;
+	}
+};
+
+template<>
+struct tdb::Get_observer_t<tdb::Tag_sqlite>{
+	static constexpr bool is_implemented = true;
+	static auto & run(tdb::Connection_t<tdb::Tag_sqlite> &c){
+		return c.observer;
+	}
+};
+
+
+template<>
+struct tdb::Get_bind_limit_t<tdb::Tag_sqlite>{
+	static constexpr bool is_implemented = true;
+	static size_t run(const tdb::Connection_t<tdb::Tag_sqlite> &c){
+		return static_cast<size_t>(c.sqlite_max_variable_number_value);
+	}
+};
 
 
 //=============
@@ -33,6 +57,8 @@ tdb::Query_t<tdb::Tag_sqlite,Return_tt,Bind_tt>::Query_t(
   std::swap(this->native_query        ,q.native_query);
   std::swap(this->native_connection   ,q.native_connection);
   std::swap(this->native_nb_bind      ,q.native_nb_bind);
+  std::swap(this->native_unchecked    ,q.native_unchecked);
+  std::swap(this->probe               ,q.probe);
 }
 
 template<typename Return_tt, typename Bind_tt>
@@ -43,6 +69,8 @@ auto tdb::Query_t<tdb::Tag_sqlite,Return_tt,Bind_tt>::operator = (
 	std::swap(this->native_query        ,q.native_query);
 	std::swap(this->native_connection   ,q.native_connection);
 	std::swap(this->native_nb_bind      ,q.native_nb_bind);
+	std::swap(this->native_unchecked    ,q.native_unchecked);
+	std::swap(this->probe               ,q.probe);
 	return *this;
 }
 
@@ -58,6 +86,13 @@ tdb::Query_t<tdb::Tag_sqlite,Return_tt,Bind_tt>::Query_t(
   int status = sqlite3_prepare_v2(c.native_connection, sql.c_str(), -1,  &native_query, 0);
   if(status !=  SQLITE_OK){throw Exception_t<tdb::Tag_sqlite>("Wrong sqlite query, error_code=" + std::to_string(status)+ ", sql=" + sql.to_string() +", sqlite3_msg="+sqlite3_errmsg(c.native_connection) );}
   this->native_connection = c.native_connection;
+
+  if constexpr(std::tuple_size<Return_tt>::value > 0){
+	  if(c.options().validate_schema){
+		  try{sqlite::validate_schema(*this);}
+		  catch(...){sqlite::finalize(native_query); throw;} //the destructor won't run
+	  }
+  }
 }
 
 
@@ -77,6 +112,8 @@ tdb::Result_t<tdb::Tag_sqlite,Return_tt>::Result_t(tdb::Result_t<tdb::Tag_sqlite
 	std::swap(a.native_query,   this->native_query);
 	std::swap(a.native_nb_bind, this->native_nb_bind);
 	std::swap(a.native_result,  this->native_result);
+	std::swap(a.native_unchecked,this->native_unchecked);
+	std::swap(a.probe,          this->probe);
 }
 
 template<typename Return_tt>
@@ -84,6 +121,8 @@ tdb::Result_t<tdb::Tag_sqlite,Return_tt>& tdb::Result_t<tdb::Tag_sqlite,Return_t
 	std::swap(a.native_query,   this->native_query);
 	std::swap(a.native_nb_bind, this->native_nb_bind);
 	std::swap(a.native_result,  this->native_result);
+	std::swap(a.native_unchecked,this->native_unchecked);
+	std::swap(a.probe,          this->probe);
 	return *this;
 }
 
@@ -120,16 +159,22 @@ template<typename Return_tt>
 struct tdb::Try_fetch_t<tdb::Tag_sqlite,Return_tt>{
 	static constexpr bool is_implemented=true;
 	static std::optional<Return_tt> run(tdb::Result_t<tdb::Tag_sqlite,Return_tt> &result){
-		std::optional<Return_tt> r;
+		std::optional<Return_tt> r(std::in_place);
+		if(!run_into(result,r.value())){r.reset();}
+		return r;
+	}
 
+	//fetch_into : write in place
+	template<typename Write_here_t>
+	static bool run_into(tdb::Result_t<tdb::Tag_sqlite,Return_tt> &result, Write_here_t &write_here){
 		result.native_result = sqlite3_step(result.native_query);
 
 		if(result.native_result == SQLITE_ROW){
-			r = get_row(result);
-			return r;
+			get_row(result,write_here);
+			return true;
 		}
 		else if(result.native_result == SQLITE_DONE){
-			return r;
+			return false;
 		}else{
 			//sqlite3_finalize(result.native_query);
 			throw Exception_t<Tag_sqlite>("Cannot fetch the data" + sqlite::error_to_string(result.native_result)  );
@@ -154,6 +199,8 @@ struct tdb::Try_fetch_t<tdb::Tag_sqlite,Return_tt>{
   //tdb::Null     -> sqlite3_bind_null
   //bool          -> sqlite3_bind_int
   //char          -> sqlite3_bind_text
+  //std::string_view           -> sqlite3_bind_text
+  //std::span<const std::byte> -> sqlite3_bind_blob
 
 //double -> sqlite3_bind_double
 template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,double,I>{
@@ -216,13 +263,8 @@ template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,size_t,I>{
 	//	if(status != SQLITE_OK){throw Exception_t<tdb::Tag_sqlite>("Cannot bind size_t as blob in sqlite3, index=" + std::to_string(q.nb_bind) +", value=" + std::to_string(d) + ",  error_code="+ std::to_string(status)+", sql="+q.sql_string());}
 	//	return;
 
-	//convert to the largest type first
-	typedef typename tdb::impl::select_type< (std::numeric_limits<sqlite3_int64>::max() > std::numeric_limits<size_t>::max())      , sqlite3_int64, size_t >::type max_t;
-	typedef typename tdb::impl::select_type< (std::numeric_limits<sqlite3_int64>::lowest() < std::numeric_limits<size_t>::lowest()), sqlite3_int64, size_t >::type min_t;
-
-	bool is_small_enough =
-				static_cast<max_t>(d) <= static_cast<max_t>( std::numeric_limits<sqlite3_int64>::max() )
-			and static_cast<min_t>(d) >= static_cast<min_t>( std::numeric_limits<sqlite3_int64>::lowest() );
+	//signed / unsigned safe comparison (comparing the limits directly converts lowest() to a huge size_t)
+	const bool is_small_enough = std::in_range<sqlite3_int64>(d);
 	if(!is_small_enough){
 		throw Exception_t<tdb::Tag_sqlite>(
 				"Cannot bind size_t as int64 in sqlite3, the size is out of range"
@@ -258,6 +300,42 @@ template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::string,I>{
 };
 
 
+//std::string_view -> sqlite3_bind_text (the viewed string must outlive the execution)
+template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::string_view,I>{
+	static constexpr bool is_implemented=true;
+	static_assert(I <  std::numeric_limits<int>::max() , "Too many bound parameters");
+
+	template<typename Return_tt, typename Bind_tt>
+	static void run(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q, const std::string_view & d){
+		++q.native_nb_bind;
+		if(d.size() >= static_cast<size_t>(std::numeric_limits<int>::max())){throw Exception_t<tdb::Tag_sqlite>("Cannot bind string_view as text, too large, index=" + std::to_string(q.native_nb_bind) +", sql="+q.sql_string());}
+
+		//data() may be nullptr for an empty view, sqlite would bind NULL
+		auto status = sqlite3_bind_text(q.native_query,q.native_nb_bind, d.empty() ? "" : d.data(),static_cast<int>(d.size()),SQLITE_STATIC);
+		if(status != SQLITE_OK){throw Exception_t<tdb::Tag_sqlite>("Cannot bind string_view as text, index=" + std::to_string(q.native_nb_bind) +", value=" + std::string(d) + ",  error_code="+ std::to_string(status)+", sql="+q.sql_string());}
+	}
+};
+
+
+//std::span<const std::byte> -> sqlite3_bind_blob (the viewed bytes must outlive the execution)
+template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::span<const std::byte>,I>{
+	static constexpr bool is_implemented=true;
+	static_assert(I <  std::numeric_limits<int>::max() , "Too many bound parameters");
+
+	template<typename Return_tt, typename Bind_tt>
+	static void run(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q, const std::span<const std::byte> & d){
+		++q.native_nb_bind;
+		if(d.size() >= static_cast<size_t>(std::numeric_limits<int>::max())){throw Exception_t<tdb::Tag_sqlite>("Cannot bind span as blob, too large, index=" + std::to_string(q.native_nb_bind) +", sql="+q.sql_string());}
+
+		//an empty blob, not NULL
+		auto status = d.empty() ?
+			sqlite3_bind_zeroblob(q.native_query,q.native_nb_bind,0) :
+			sqlite3_bind_blob    (q.native_query,q.native_nb_bind,d.data(),static_cast<int>(d.size()),SQLITE_STATIC);
+		if(status != SQLITE_OK){throw Exception_t<tdb::Tag_sqlite>("Cannot bind span as blob, index=" + std::to_string(q.native_nb_bind) +", size=" + std::to_string(d.size()) + ",  error_code="+ std::to_string(status)+", sql="+q.sql_string());}
+	}
+};
+
+
 //const char* -> sqlite3_bind_text
 template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,const char * ,I>{
 	  static constexpr bool is_implemented=true;
@@ -317,11 +395,50 @@ template<size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,char,I>{
 };
 
 
+//arrays -> sqlite3_bind_pointer (NOT copied, see sqlite::Array_view)
+namespace tdb::sqlite::impl{
+	template<typename T, typename Return_tt, typename Bind_tt>
+	void bind_array(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q, const T *data, size_t size){
+		static_assert(Array_type_t<T>::is_implemented,"sqlite arrays support int, sqlite3_int64, double, std::string and std::string_view");
+		++q.native_nb_bind;
+		const auto status = sqlite::bind_array(q.native_query, q.native_nb_bind, Array_view{data, size, Array_type_t<T>::value});
+		if(status != SQLITE_OK){throw Exception_t<tdb::Tag_sqlite>("Cannot bind array, index=" + std::to_string(q.native_nb_bind) +", size=" + std::to_string(size) + ",  error_code="+ std::to_string(status)+", sql="+q.sql_string());}
+	}
+}
+
+template<typename T, size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::vector<T>,I>{
+	static constexpr bool is_implemented=true;
+
+	template<typename Return_tt, typename Bind_tt>
+	static void run(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q, const std::vector<T> &d){
+		sqlite::impl::bind_array(q, d.data(), d.size());
+	}
+};
+
+template<typename T, size_t I> struct tdb::Bind_one_t<tdb::Tag_sqlite,std::span<const T>,I>{
+	static constexpr bool is_implemented=true;
+
+	template<typename Return_tt, typename Bind_tt>
+	static void run(Query_t<Tag_sqlite,Return_tt,Bind_tt>&q, std::span<const T> d){
+		sqlite::impl::bind_array(q, d.data(), d.size());
+	}
+};
+
 
 
 //===============
 //=== Get_one ===
 //===============
+//column I skips the type check (see sqlite::validate_schema)
+namespace tdb::sqlite::impl{
+	template<size_t I, typename Return_tt>
+	bool is_unchecked(const Result_t<Tag_sqlite,Return_tt> &result){
+		if constexpr(I < 64){return (result.native_unchecked >> I) & 1;}
+		else                {return false;}
+	}
+}
+
+
 //double <- sqlite3_column_double;
 template<size_t I>
 struct tdb::Get_one_t<tdb::Tag_sqlite,double,I>{
@@ -331,8 +448,10 @@ struct tdb::Get_one_t<tdb::Tag_sqlite,double,I>{
 	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, double& write_here){
 		  //assert(I < sqlite3_column_count(result.native_query) );
 		  assert(I < std::numeric_limits<int>::max() );
-		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
-		  if(coltype!=SQLITE_FLOAT){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get double ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_FLOAT){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get double ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
 		  write_here=sqlite3_column_double(result.native_query,static_cast<int>(I));
 	 }
 };
@@ -346,8 +465,10 @@ struct tdb::Get_one_t<tdb::Tag_sqlite,int,I>{
 	  template<typename Return_tt>
 	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, int& write_here){
 		  static_assert(I <  std::numeric_limits<int>::max(),"I is too large");
-		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
-		  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get int ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get int ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
 		  write_here=sqlite3_column_int(result.native_query,static_cast<int>(I));
 	 }
 };
@@ -360,8 +481,10 @@ template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,sqlite3_int64,I>{
 	  template<typename Return_tt>
 	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, sqlite3_int64& write_here){
 		  static_assert(I <  std::numeric_limits<int>::max(),"I is too large");
-		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
-		  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get int ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get int ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
 		  write_here=sqlite3_column_int64(result.native_query,static_cast<int>(I));
 	 }
 };
@@ -376,8 +499,10 @@ template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,size_t,I>{
 		  static_assert(I <  std::numeric_limits<int>::max(),"");
 		  //assert( static_cast<int>(I) < sqlite3_column_count(result.native_query) );
 		  //assert( result.native_query != nullptr);
-		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
-		  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get size_t as sqlite3_int64 ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get size_t as sqlite3_int64 ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
 		  //TODO bound checking
 		  write_here=sqlite3_column_int64(result.native_query,static_cast<int>(I));
 	 }
@@ -392,9 +517,50 @@ template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,std::string,I>{
 	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, std::string& write_here){
 		  //doc : https://stackoverflow.com/questions/804123/const-unsigned-char-to-stdstring
 		  static_assert(I <  std::numeric_limits<int>::max(),"I is too large");
-		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
-		  if(coltype!=SQLITE_TEXT){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get string ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
-		  write_here=static_cast<std::string>( reinterpret_cast<const char*>(sqlite3_column_text  (result.native_query, static_cast<int>(I))) );
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_TEXT){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get string ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
+		  //text first, then bytes (doc : https://www.sqlite.org/c3ref/column_blob.html)
+		  const char *d = reinterpret_cast<const char*>(sqlite3_column_text(result.native_query, static_cast<int>(I)));
+		  const int   n = sqlite3_column_bytes(result.native_query, static_cast<int>(I));
+		  write_here.assign(d, static_cast<size_t>(n)); //no strlen, reuses write_here capacity
+	 }
+};
+
+
+//std::string_view <- sqlite3_column_text (BORROWED : valid until the next fetch)
+template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,std::string_view,I>{
+	  static constexpr bool is_implemented=true;
+
+	  template<typename Return_tt>
+	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, std::string_view& write_here){
+		  static_assert(I <  std::numeric_limits<int>::max(),"I is too large");
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_TEXT){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get string_view ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
+		  const char *d = reinterpret_cast<const char*>(sqlite3_column_text(result.native_query, static_cast<int>(I)));
+		  const int   n = sqlite3_column_bytes(result.native_query, static_cast<int>(I));
+		  write_here = std::string_view(d, static_cast<size_t>(n));
+	 }
+};
+
+
+//std::span<const std::byte> <- sqlite3_column_blob (BORROWED : valid until the next fetch)
+template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,std::span<const std::byte>,I>{
+	  static constexpr bool is_implemented=true;
+
+	  template<typename Return_tt>
+	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, std::span<const std::byte>& write_here){
+		  static_assert(I <  std::numeric_limits<int>::max(),"I is too large");
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_BLOB){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get span (from blob) ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
+		  const void *d = sqlite3_column_blob (result.native_query, static_cast<int>(I)); //nullptr for an empty blob
+		  const int   n = sqlite3_column_bytes(result.native_query, static_cast<int>(I));
+		  write_here = std::span<const std::byte>(static_cast<const std::byte*>(d), static_cast<size_t>(n));
 	 }
 };
 
@@ -404,16 +570,18 @@ template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,bool,I>{
 	  static constexpr bool is_implemented=true;
 
 	  template<typename Return_tt>
-	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, std::string& write_here){
+	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, bool& write_here){
 		  //get an int
-		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
-		  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get bool (from integer) ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  if(!sqlite::impl::is_unchecked<I>(result)){
+			  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
+			  if(coltype!=SQLITE_INTEGER){throw tdb::Exception_t<tdb::Tag_sqlite>("sqlite : wrong type cannot get bool (from integer) ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype));}
+		  }
 		  int i=sqlite3_column_int(result.native_query,static_cast<int>(I));
 
 		  //int to bool
 		  if     (i==0){write_here = false; return;}
 		  else if(i==1){write_here = true;  return;}
-		  throw Exception_t<tdb::Tag_sqlite>("sqlite : wrong value cannot interpret int as bool ,column="+std::to_string(I)+", sql="+result.sql_string() + ", type=" + tdb::sqlite::coltype_to_string(coltype), ", int="+std::to_string(i));
+		  throw Exception_t<tdb::Tag_sqlite>("sqlite : wrong value cannot interpret int as bool ,column="+std::to_string(I)+", sql="+result.sql_string() + ", int="+std::to_string(i));
 
 	  }
 };
@@ -424,14 +592,14 @@ template<size_t I> struct tdb::Get_one_t<tdb::Tag_sqlite,char,I>{
 	  static constexpr bool is_implemented=true;
 
 	  template<typename Return_tt>
-	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, std::string& write_here){
+	  static void run(const Result_t<Tag_sqlite,Return_tt> &result, char& write_here){
 		  //get string
 		  std::string s;
 		  tdb::Get_one_t<tdb::Tag_sqlite,std::string,I>::run(result,s);
 
 		  //string to char
 		  if(s.size()!=1){
-				 throw Exception_t<tdb::Tag_sqlite>("sqlite : wrong value cannot interpret string as char ,column="+std::to_string(I)+", sql="+result.sql_string(), ", string="+s+", string_size="+std::to_string(s.size()) );
+				 throw Exception_t<tdb::Tag_sqlite>("sqlite : wrong value cannot interpret string as char ,column="+std::to_string(I)+", sql="+result.sql_string() + ", string="+s+", string_size="+std::to_string(s.size()) );
 		  }
 		  write_here=s[0];
 	  }
@@ -458,9 +626,9 @@ struct tdb::Get_one_t<tdb::Tag_sqlite,std::optional<T>, I >{
 		  const auto coltype=sqlite3_column_type(result.native_query, static_cast<int>(I) );
 		  if(coltype==SQLITE_NULL){write_here.reset(); return;};
 
-		  T t;
-		  Get_one_t<Tag_sqlite,T,I>::run(result,t);
-		  write_here=t;
+		  //write in place (fetch_into reuses the previous value)
+		  if(!write_here.has_value()){write_here.emplace();}
+		  Get_one_t<Tag_sqlite,T,I>::run(result,write_here.value());
 
 	}
 };
@@ -469,6 +637,65 @@ struct tdb::Get_one_t<tdb::Tag_sqlite,std::optional<T>, I >{
 
 
 
+//=======================
+//=== validate_schema ===
+//=======================
+namespace tdb::sqlite::impl{
+	//affinity of the columns that can be fetched as T without type check, None : always checked
+	template<typename T> struct Unchecked_affinity_t{static constexpr Affinity value = Affinity::None;};
+	template<> struct Unchecked_affinity_t<int>          {static constexpr Affinity value = Affinity::Integer;};
+	template<> struct Unchecked_affinity_t<sqlite3_int64>{static constexpr Affinity value = Affinity::Integer;};
+	template<> struct Unchecked_affinity_t<size_t>       {static constexpr Affinity value = Affinity::Integer;};
+	template<> struct Unchecked_affinity_t<bool>         {static constexpr Affinity value = Affinity::Integer;};
+	template<> struct Unchecked_affinity_t<double>       {static constexpr Affinity value = Affinity::Real;};
+	template<> struct Unchecked_affinity_t<std::string>  {static constexpr Affinity value = Affinity::Text;};
+	template<> struct Unchecked_affinity_t<std::string_view>{static constexpr Affinity value = Affinity::Text;};
+	template<> struct Unchecked_affinity_t<char>         {static constexpr Affinity value = Affinity::Text;};
+	template<> struct Unchecked_affinity_t<std::span<const std::byte>>{static constexpr Affinity value = Affinity::Blob;};
+
+	template<typename T> struct Unchecked_t{ //T or std::optional<T>
+		static constexpr Affinity affinity = Unchecked_affinity_t<T>::value;
+		static constexpr bool     nullable = false;
+	};
+	template<typename T> struct Unchecked_t<std::optional<T>>{
+		static constexpr Affinity affinity = Unchecked_affinity_t<T>::value;
+		static constexpr bool     nullable = true; //std::optional checks NULL itself
+	};
+
+	template<typename T>
+	bool can_skip_check(sqlite3_stmt *native_query, int i){
+		if constexpr(Unchecked_t<T>::affinity==Affinity::None){return false;}
+		else{
+			const Column_schema c = column_schema(native_query,i);
+			return c.affinity==Unchecked_t<T>::affinity and (Unchecked_t<T>::nullable or c.not_null);
+		}
+	}
+}
+
+template<typename Return_tt, typename Bind_tt>
+size_t tdb::sqlite::validate_schema(Query_t<Tag_sqlite,Return_tt,Bind_tt> &q){
+	constexpr size_t nb_return = std::tuple_size<Return_tt>::value;
+	const int nb_column = sqlite3_column_count(q.native_query);
+	if(nb_column != static_cast<int>(nb_return)){
+		throw Exception_t<Tag_sqlite>("sqlite : validate_schema, the query returns "+std::to_string(nb_column)+" columns, Return_tt has "+std::to_string(nb_return)+", sql="+q.sql_string());
+	}
+
+	//only the 64 first columns can skip the check (see Query_t::native_unchecked)
+	q.native_unchecked = 0;
+	size_t nb_unchecked = 0;
+	[&]<size_t... I>(std::index_sequence<I...>){
+		((impl::can_skip_check<typename std::tuple_element<I,Return_tt>::type>(q.native_query, static_cast<int>(I))
+			? (q.native_unchecked |= std::uint64_t(1) << I, ++nb_unchecked)
+			: nb_unchecked
+		), ...);
+	}(std::make_index_sequence<(nb_return < 64 ? nb_return : 64)>());
+	return nb_unchecked;
+}
+
+
+
+
+
 //=========================================
 //=== Execute_t, Insert_t, Get_result_t ===
 //=========================================
@@ -513,6 +740,37 @@ struct tdb::Insert_t<tdb::Tag_sqlite,Return_tt,Bind_tt>{
 
 
 
+//Multi_insert_t (optional)
+template<typename Bind_tt>
+tdb::Multi_insert_t<tdb::Tag_sqlite,Bind_tt>::Multi_insert_t(
+		Connection_t<Tag_sqlite> &c,
+		const std::string &head,
+		const std::string &tail,
+		size_t nb_rows_
+):
+	q(c, tdb::sql<Tag_sqlite>(impl::multi_insert_sql(head, tail, nb_rows_, std::tuple_size<Bind_tt>::value, false)) ),
+	native_nb_rows(nb_rows_)
+{}
+
+template<typename Bind_tt>
+template<typename It>
+void tdb::Multi_insert_t<tdb::Tag_sqlite,Bind_tt>::run(It &first){
+	tdb::sqlite::Query_guard query_guard(q); //reset bindings, even if a bind fails
+
+	//Bind_one_t ignores I and binds the next parameter
+	for(size_t i = 0; i < native_nb_rows; ++i, ++first){
+		tdb::helpers::bind_rt<0>(q,*first);
+	}
+
+	int querry_result;
+	do{querry_result = sqlite3_step(q.native_query);}
+	while(querry_result  == SQLITE_ROW);
+
+	if(querry_result!=SQLITE_DONE){throw Exception_t<Tag_sqlite>("sqlite : error during multi rows insert, error_code=" + sqlite::error_to_string(querry_result)+", sql="+q.sql_string()+", msg="+sqlite3_errmsg(q.native_connection));}
+}
+
+
+
 
 
 
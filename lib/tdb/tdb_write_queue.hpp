@@ -0,0 +1,319 @@
+#ifndef LIB_TDB_TDB_WRITE_QUEUE_HPP_
+#define LIB_TDB_TDB_WRITE_QUEUE_HPP_
+
+//--- Write queue : one writer thread, group commit (any Tag_t) ---
+//Threads that write through a shared connection queue on its mutex, and commit one by one.
+//A Write_queue owns the write connection and a writer thread. The other threads push bound
+//requests into a lock free queue, and get a std::future. The writer pops the queued requests,
+//runs up to max_batch of them in a single transaction, commits, and then completes the futures.
+//
+//tdb::Write_queue<Tag_sqlite> wq(tdb::pool_connector<Tag_sqlite>("db.sqlite", tdb::sqlite::Options::oltp()));
+//std::future<tdb::Rowid<Tag_sqlite>> id = wq.insert("insert into t(i,s) values(?,?)", 42, "hello");
+//std::future<void>                   ok = wq.execute("update t set i=i+1 where s=?", std::string("hello"));
+//std::future<int> n = wq.submit([](Connection_t<Tag_sqlite> &c){...; return 1;}); //any work on the writer connection
+//id.get();   //the Rowid, once commited, or rethrows the error of this request
+//wq.flush(); //wait until everything pushed before is commited
+//
+//Errors : a request that throws gets its exception, the others of its batch are not lost.
+//Each request runs inside a SAVEPOINT : a failed request is undone alone (ROLLBACK TO), and the
+//batch still commits once. If the savepoint cannot be rolled back (ex : sqlite rolled back the
+//whole transaction), the batch is rolled back and replayed without the failed request (then a
+//request may run more than once, its result is the one of the commited run). A failed BEGIN or
+//COMMIT fails the whole batch.
+//
+//The bound values are copied into the request (const char* as std::string, borrowed types
+//are refused). The destructor commits what is queued, and joins the writer.
+//push after close() : Exception_t<Tag_t>. A full queue blocks the producers.
+
+#include "tdb.hpp"
+#include "tdb_pool.hpp" //pool_connector
+#include "helpers/Ring_buffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tdb{
+
+	struct Write_queue_options{
+		size_t      capacity  = 4096;                //queued requests, producers block when full
+		size_t      max_batch = 1000;                //requests per transaction, at least 1
+		std::string begin     = "BEGIN transaction"; //ex : "BEGIN IMMEDIATE" for sqlite
+	};
+
+	struct Write_queue_stats{
+		size_t requests     = 0; //completed requests (commited or failed)
+		size_t errors       = 0; //failed requests
+		size_t transactions = 0; //commited transactions
+		size_t replays      = 0; //batches rolled back and replayed, a failed request could not be undone alone
+	};
+
+
+	namespace impl{
+
+		template<typename Tag_t>
+		struct Write_job{
+			virtual ~Write_job(){}
+			virtual void run(Connection_t<Tag_t> &c)=0; //may be called again on replay
+			virtual void complete()=0;                  //after the commit
+			virtual void fail(std::exception_ptr e)=0;
+
+			bool failed = false;
+		};
+
+		template<typename Tag_t, typename Fn_t>
+		struct Write_job_t final : Write_job<Tag_t>{
+			typedef std::invoke_result_t<Fn_t&,Connection_t<Tag_t>&> return_t;
+
+			explicit Write_job_t(Fn_t &&fn_):fn(std::move(fn_)){}
+
+			void run(Connection_t<Tag_t> &c)override{
+				if constexpr(std::is_void<return_t>::value){fn(c);}
+				else{result.emplace(fn(c));}
+			}
+			void complete()override{
+				if constexpr(std::is_void<return_t>::value){promise.set_value();}
+				else{promise.set_value(std::move(*result));}
+			}
+			void fail(std::exception_ptr e)override{promise.set_exception(e);}
+
+			Fn_t fn;
+			std::promise<return_t> promise;
+			std::optional<std::conditional_t<std::is_void<return_t>::value,int,return_t> > result;
+		};
+
+		//bound value, owned by the request
+		template<typename A> struct Write_arg_t            {typedef std::decay_t<A> type;};
+		template<>           struct Write_arg_t<const char*>{typedef std::string type;};
+		template<>           struct Write_arg_t<char*>      {typedef std::string type;};
+		template<typename A> using  Write_arg = typename Write_arg_t<std::decay_t<A> >::type;
+	}
+
+
+
+	template<typename Tag_t>
+	struct Write_queue{
+		typedef std::function<std::unique_ptr<Connection_t<Tag_t> >()> Make_connection_t;
+
+		//NOT copiable, NOT movable (the writer thread points to it)
+		Write_queue(Write_queue&&)                =delete;
+		Write_queue& operator=(Write_queue&&)     =delete;
+		Write_queue(const Write_queue&)           =delete;
+		Write_queue& operator=(const Write_queue&)=delete;
+
+		//connect now (throw if it fails), then start the writer
+		explicit Write_queue(Make_connection_t make_connection, const Write_queue_options &options_=Write_queue_options()):
+			options(options_),
+			connection(make_connection()),
+			rb(std::max<size_t>(options.capacity,1))
+		{
+			options.max_batch = std::max<size_t>(1,options.max_batch);
+			writer = std::thread([this](){work();});
+		}
+
+		~Write_queue(){close();}
+
+		//--- requests ---
+		template<typename... A>
+		std::future<Rowid<Tag_t> > insert(std::string sql, A&&... a){
+			static_assert(!impl::has_borrowed<std::tuple<impl::Write_arg<A>...> >,"Write_queue cannot bind borrowed types (std::string_view, std::span...), they may be invalidated before the request runs");
+			return submit([sql=std::move(sql), binds=std::tuple<impl::Write_arg<A>...>(std::forward<A>(a)...)](Connection_t<Tag_t> &c){
+				return std::apply([&](const auto&... b){return tdb::insert_a(c,sql,b...);}, binds);
+			});
+		}
+
+		template<typename... A>
+		std::future<void> execute(std::string sql, A&&... a){
+			static_assert(!impl::has_borrowed<std::tuple<impl::Write_arg<A>...> >,"Write_queue cannot bind borrowed types (std::string_view, std::span...), they may be invalidated before the request runs");
+			return submit([sql=std::move(sql), binds=std::tuple<impl::Write_arg<A>...>(std::forward<A>(a)...)](Connection_t<Tag_t> &c){
+				std::apply([&](const auto&... b){tdb::execute_a(c,sql,b...);}, binds);
+			});
+		}
+
+		//fn(Connection_t<Tag_t>&) runs in the writer thread, inside the batch transaction and a savepoint
+		//It must not commit nor release the savepoint, and can be called more than once (replay).
+		template<typename Fn_t>
+		auto submit(Fn_t &&fn){
+			auto job = std::make_unique<impl::Write_job_t<Tag_t,std::decay_t<Fn_t> > >(std::decay_t<Fn_t>(std::forward<Fn_t>(fn)));
+			auto r = job->promise.get_future();
+			push(std::move(job));
+			return r;
+		}
+
+		//wait until the requests pushed before are completed
+		void flush(){submit([](Connection_t<Tag_t>&){}).get();}
+
+		//commit what is queued, and stop the writer. Idempotent.
+		void close(){
+			if(closed.exchange(true)){return;}
+			wake_writer();
+			writer.join();
+		}
+
+		Write_queue_stats stats()const{
+			Write_queue_stats r;
+			r.requests     = nb_requests    .load(std::memory_order_relaxed);
+			r.errors       = nb_errors      .load(std::memory_order_relaxed);
+			r.transactions = nb_transactions.load(std::memory_order_relaxed);
+			r.replays      = nb_replays     .load(std::memory_order_relaxed);
+			return r;
+		}
+
+		const Write_queue_options& get_options()const{return options;}
+
+
+		private:
+		typedef std::unique_ptr<impl::Write_job<Tag_t> > Job_ptr;
+
+		//blocks while the queue is full
+		void push(Job_ptr &&job){
+			++pushing;
+			for(;;){
+				const uint32_t seen = rb.pop_count().load(std::memory_order_acquire);
+				if(closed.load()){
+					--pushing;
+					wake_writer();
+					throw Exception_t<Tag_t>("Write_queue : push after close()");
+				}
+				if(rb.try_push(std::move(job))){break;}
+				rb.pop_count().wait(seen, std::memory_order_acquire);
+			}
+			--pushing;
+		}
+
+		void wake_writer(){
+			rb.push_count().fetch_add(1, std::memory_order_release);
+			rb.push_count().notify_all();
+		}
+
+		//writer thread : pop a batch, commit it. Exit when closed, no push in progress, and empty.
+		void work(){
+			std::vector<Job_ptr> batch;
+			batch.reserve(std::min<size_t>(options.max_batch,rb.capacity()));
+			for(;;){
+				const uint32_t seen = rb.push_count().load(std::memory_order_acquire);
+				Job_ptr job;
+				while(batch.size() < options.max_batch and rb.try_pop(job)){batch.push_back(std::move(job));}
+
+				if(!batch.empty()){
+					commit(batch);
+					batch.clear();
+					continue;
+				}
+				if(closed.load() and pushing.load()==0){ //seq_cst : a producer that saw closed==false is counted in pushing
+					if(rb.try_pop(job)){batch.push_back(std::move(job)); continue;} //pushed before close
+					return;
+				}
+				rb.push_count().wait(seen, std::memory_order_acquire);
+			}
+		}
+
+		//run the batch in one transaction, a savepoint per request
+		//replay it without the failed request only when its savepoint cannot be rolled back
+		void commit(std::vector<Job_ptr> &batch){
+			Connection_t<Tag_t> &c = *connection;
+			for(;;){
+				try{
+					tdb::execute_a(c,options.begin);
+				}catch(...){
+					fail_all(batch,std::current_exception());
+					return;
+				}
+
+				bool replay = false;
+				for(Job_ptr &j : batch){
+					if(j->failed){continue;}
+					if(!run_job(*j)){replay = true; break;}
+				}
+
+				if(replay){
+					rollback_noexcept();
+					++nb_replays;
+					continue;
+				}
+
+				try{
+					tdb::execute_a(c,"COMMIT");
+				}catch(...){
+					rollback_noexcept();
+					fail_all(batch,std::current_exception());
+					return;
+				}
+				++nb_transactions;
+				for(Job_ptr &j : batch){
+					if(j->failed){continue;}
+					j->complete();
+					++nb_requests;
+				}
+				return;
+			}
+		}
+
+		//run j in a savepoint. If it throws, j fails and is undone alone.
+		//false : the savepoint cannot be rolled back, the batch must be replayed
+		bool run_job(impl::Write_job<Tag_t> &j){
+			Connection_t<Tag_t> &c = *connection;
+			try{
+				tdb::execute_a(c,"SAVEPOINT tdb_write_queue");
+				j.run(c);
+				tdb::execute_a(c,"RELEASE SAVEPOINT tdb_write_queue");
+				return true;
+			}catch(...){
+				j.failed = true;
+				j.fail(std::current_exception());
+				++nb_errors;
+				++nb_requests;
+			}
+			try{
+				tdb::execute_a(c,"ROLLBACK TO SAVEPOINT tdb_write_queue");
+				tdb::execute_a(c,"RELEASE SAVEPOINT tdb_write_queue");
+				return true;
+			}catch(...){
+				return false;
+			}
+		}
+
+		void fail_all(std::vector<Job_ptr> &batch, std::exception_ptr e){
+			for(Job_ptr &j : batch){
+				if(j->failed){continue;}
+				j->failed = true;
+				j->fail(e);
+				++nb_errors;
+				++nb_requests;
+			}
+		}
+
+		void rollback_noexcept(){
+			try{tdb::execute_a(*connection,"ROLLBACK");}catch(...){}
+		}
+
+		Write_queue_options options;
+		std::unique_ptr<Connection_t<Tag_t> > connection; //used by the writer thread only
+		Ring_buffer<Job_ptr> rb;
+		std::thread writer;
+
+		std::atomic<bool>   closed  = false;
+		std::atomic<size_t> pushing = 0; //producers inside push()
+
+		std::atomic<size_t> nb_requests     = 0;
+		std::atomic<size_t> nb_errors       = 0;
+		std::atomic<size_t> nb_transactions = 0;
+		std::atomic<size_t> nb_replays      = 0;
+	};
+
+}//end namespace tdb
+
+
+
+#endif /* LIB_TDB_TDB_WRITE_QUEUE_HPP_ */